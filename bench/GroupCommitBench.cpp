@@ -0,0 +1,111 @@
+// Write throughput of IssueService with and without group commit.
+//
+// Each client thread repeatedly changes the status of its own issue for a
+// fixed time; the table shows committed writes per second by number of
+// concurrent clients. Run with `make bench_group_commit` and
+// `./bench_group_commit [seconds per run] [profile]`; the profile (durable
+// by default) decides how much an individual commit costs.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GroupCommitQueue.hpp"
+#include "SQLiteIssueRepository.hpp"
+#include "StorageProfile.hpp"
+#include "service/IssueService.hpp"
+
+namespace {
+struct Result {
+  double writesPerSecond{0};
+  double unitsPerBatch{0};
+};
+
+Result measure(const std::filesystem::path& dbPath,
+               const StorageProfile& profile, int clients, bool batched,
+               std::chrono::milliseconds duration) {
+  std::filesystem::remove_all(dbPath.parent_path());
+  std::filesystem::create_directories(dbPath.parent_path());
+  auto repository =
+      std::make_unique<SQLiteIssueRepository>(dbPath.string(), 2, profile);
+  std::unique_ptr<IssueService> service;
+  if (batched) {
+    GroupCommitQueue::Limits limits;
+    limits.maxBatch = 64;
+    service =
+        std::make_unique<IssueService>(std::move(repository), limits);
+  } else {
+    service = std::make_unique<IssueService>(std::move(repository));
+  }
+
+  service->createUser("bench", "Developer");
+  std::vector<int> issueIds;
+  for (int i = 0; i < clients; ++i) {
+    issueIds.push_back(
+        service->createIssue("Issue " + std::to_string(i), "", "bench")
+            .getId());
+  }
+
+  std::atomic<bool> stop{false};
+  std::atomic<long> writes{0};
+  std::vector<std::thread> threads;
+  const auto started = std::chrono::steady_clock::now();
+  for (int i = 0; i < clients; ++i) {
+    threads.emplace_back([&, i] {
+      const char* statuses[] = {"In Progress", "To Be Done"};
+      for (long n = 0; !stop.load(); ++n) {
+        if (service->updateIssueField(issueIds[i], "status",
+                                      statuses[n % 2])) {
+          ++writes;
+        }
+      }
+    });
+  }
+  std::this_thread::sleep_for(duration);
+  stop = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - started;
+
+  Result result;
+  result.writesPerSecond = static_cast<double>(writes) / elapsed.count();
+  if (auto stats = service->writeBatchStats()) {
+    result.unitsPerBatch = stats->batches == 0
+                               ? 0
+                               : static_cast<double>(stats->units) /
+                                     static_cast<double>(stats->batches);
+  }
+  return result;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::chrono::milliseconds duration(
+      argc > 1 ? static_cast<int>(std::atof(argv[1]) * 1000) : 2000);
+  const StorageProfile profile =
+      StorageProfile::preset(argc > 2 ? argv[2] : "durable");
+  const std::filesystem::path dbPath =
+      std::filesystem::temp_directory_path() / "group-commit-bench" /
+      "issues.db";
+
+  std::printf("profile %s, %.1f s per run\n", profile.name.c_str(),
+              duration.count() / 1000.0);
+  std::printf("%8s %14s %14s %14s\n", "clients", "unbatched w/s",
+              "batched w/s", "units/commit");
+  for (int clients : {1, 2, 4, 8, 16, 32}) {
+    const Result plain = measure(dbPath, profile, clients, false, duration);
+    const Result grouped = measure(dbPath, profile, clients, true, duration);
+    std::printf("%8d %14.0f %14.0f %14.1f\n", clients, plain.writesPerSecond,
+                grouped.writesPerSecond, grouped.unitsPerBatch);
+  }
+  std::filesystem::remove_all(dbPath.parent_path());
+  return 0;
+}
@@ -0,0 +1,27 @@
+#ifndef COMMENT_PAGE_HPP_
+#define COMMENT_PAGE_HPP_
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include "Comment.hpp"
+
+/**
+ * @brief Keyset page of an issue's comments in ascending id order.
+ *
+ * Comment ids are unique per issue, so the last id returned is the whole
+ * cursor and a page costs the same at any depth of the thread.
+ */
+struct CommentPageRequest {
+  std::size_t limit{50};
+  int after{-1};  ///< only comments with a larger id
+};
+
+/// @brief Result page; next is set when more comments follow.
+struct CommentPage {
+  std::vector<Comment> comments;
+  std::optional<int> next;  ///< the after of the following page
+};
+
+#endif  // COMMENT_PAGE_HPP_
@@ -0,0 +1,105 @@
+#ifndef GROUP_COMMIT_QUEUE_HPP_
+#define GROUP_COMMIT_QUEUE_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "IssueRepository.hpp"
+
+/**
+ * @brief Coalesces concurrent units of work into shared transactions.
+ *
+ * Each caller of run() queues its unit and blocks. Whichever caller finds
+ * no batch in flight becomes the leader: it optionally lingers up to
+ * maxDelay for the queue to reach maxBatch, then runs up to maxBatch
+ * queued units inside one IssueRepository::runInTransaction, each as a
+ * nested unit of its own. Units queued while a batch commits form the
+ * next batch, so under load one commit (and one fsync) is paid per batch
+ * rather than per unit, and with a single caller nothing waits.
+ *
+ * Every caller still gets its own outcome: a unit that throws has only
+ * its own writes undone and its exception rethrown to its caller, while
+ * the rest of the batch commits. If the commit itself fails, every unit
+ * of the batch fails with that error. Units run on the leader's thread,
+ * so they must not depend on thread-local state of their caller.
+ */
+class GroupCommitQueue {
+ public:
+  /// @brief Bounds on a single batch.
+  struct Limits {
+    std::size_t maxBatch{64};  ///< units per transaction, at least 1
+    /// how long a leader waits for a full batch; 0 takes what is queued
+    std::chrono::microseconds maxDelay{0};
+  };
+
+  /// @brief Counters since construction.
+  struct Stats {
+    std::size_t units{0};    ///< units run
+    std::size_t batches{0};  ///< transactions they were committed in
+  };
+
+  /**
+   * @brief Runs a whole batch. Called with the batch body, which it must
+   * invoke exactly once; lets the owner hold its own locks for the batch.
+   */
+  using BatchGuard = std::function<void(const std::function<void()>&)>;
+
+  /// @throws std::invalid_argument if limits.maxBatch is 0
+  GroupCommitQueue(IssueRepository& repo, const Limits& limits,
+                   BatchGuard guard = nullptr);
+
+  GroupCommitQueue(const GroupCommitQueue&) = delete;
+  GroupCommitQueue& operator=(const GroupCommitQueue&) = delete;
+
+  /**
+   * @brief Queues work and blocks until its batch has committed.
+   * @throws whatever work threw, or the error that failed the commit
+   */
+  void run(const std::function<void()>& work);
+
+  /// @brief run() for work that returns a value.
+  template <typename Fn>
+  auto submit(Fn&& work) {
+    using Result = decltype(work());
+    if constexpr (std::is_void_v<Result>) {
+      run(std::forward<Fn>(work));
+    } else {
+      std::optional<Result> result;
+      run([&] { result.emplace(work()); });
+      return std::move(*result);
+    }
+  }
+
+  Limits limits() const { return limits_; }
+  Stats stats() const;
+
+ private:
+  struct Ticket {
+    const std::function<void()>* work{nullptr};
+    std::exception_ptr error;
+    bool done{false};
+  };
+
+  void commit(const std::vector<Ticket*>& batch);
+
+  IssueRepository& repo_;
+  const Limits limits_;
+  const BatchGuard guard_;
+  mutable std::mutex mutex_;
+  std::condition_variable arrived_;   // wakes a lingering leader
+  std::condition_variable finished_;  // wakes callers after each batch
+  std::deque<Ticket*> pending_;
+  bool leading_{false};
+  Stats stats_;
+};
+
+#endif  // GROUP_COMMIT_QUEUE_HPP_
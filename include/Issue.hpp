@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -22,12 +23,17 @@
  *  - assigned_to_ empty => unassigned.
  *  - We keep both comment id list (persistence) and Comment objects
  *    (in-memory lookups/edits).
+ *  - A repository may defer the comments to a loader that runs on first
+ *    access, so metadata-only edits never read them.
  */
 class Issue{
  public:
   /// @brief Epoch milliseconds; 0 means unknown/unset.
   using TimePoint = std::int64_t;
 
+  /// @brief Supplies the comments of a deferred issue, in id order.
+  using CommentLoader = std::function<std::vector<Comment>()>;
+
  private:
   // Core fields
   int id_{0};             ///< 0 => new (not yet persisted)
@@ -35,13 +41,17 @@ class Issue{
   std::string title_;     ///< non-empty short summary
 
   // Relationships / metadata
-  int description_comment_id_{-1};   ///< -1 => none linked
+  mutable int description_comment_id_{-1};  ///< -1 => none linked
   std::string assigned_to_;          ///< assignee user id; empty => none
   std::string status_{"To Be Done"}; ///< issue status
 
   // Persistence ids + in-memory objects
-  std::vector<int> comment_ids_;  ///< unique attached comment ids
-  std::vector<Comment> comments_; ///< stored Comment objects
+  mutable std::vector<int> comment_ids_;  ///< unique attached comment ids
+  mutable std::vector<Comment> comments_; ///< stored Comment objects
+  mutable CommentLoader comment_loader_;  ///< set => comments not loaded
+
+  /// @brief Run the pending comment loader, if any.
+  void loadComments() const;
 
   TimePoint created_at_{0}; ///< creation time; 0 => unknown
   std::map<std::string, std::string> tags_;  ///< name -> color
@@ -110,6 +120,26 @@ class Issue{
    */
   const std::string &getTitle() const noexcept { return title_; }
 
+  // ---------------------------
+  // deferred comments
+  // ---------------------------
+
+  /**
+   * @brief Replace the comments with a loader run on first access.
+   *
+   * Any comment accessor or mutator runs the loader first. Once loaded, a
+   * description id whose comment the loader did not return is cleared.
+   * @param description_comment_id stored description id (-1 for none)
+   * @param loader returns the issue's comments
+   */
+  void deferComments(int description_comment_id, CommentLoader loader);
+
+  /**
+   * @brief Whether the comments are in memory.
+   * @return false while a deferred loader has not run yet.
+   */
+  bool commentsLoaded() const noexcept { return !comment_loader_; }
+
   /**
    * @brief Whether description comment is linked.
    * @return true if description_comment_id_ >= 0.
@@ -154,7 +184,8 @@ class Issue{
    * @brief Get list of comment ids (read-only).
    * @return const ref to id vector.
    */
-  const std::vector<int> &getCommentIds() const noexcept {
+  const std::vector<int> &getCommentIds() const {
+    loadComments();
     return comment_ids_;
   }
 
@@ -162,7 +193,8 @@ class Issue{
    * @brief Get list of stored Comment objects (read-only).
    * @return const ref to comments_ vector.
    */
-  const std::vector<Comment> &getComments() const noexcept {
+  const std::vector<Comment> &getComments() const {
+    loadComments();
     return comments_;
   }
 
@@ -259,14 +291,14 @@ class Issue{
    * @param id  comment id
    * @return pointer to Comment or nullptr if not found
    */
-  const Comment *findCommentById(int id) const noexcept;
+  const Comment *findCommentById(int id) const;
 
   /**
    * @brief Find a comment by id (mutable).
    * @param id  comment id
    * @return pointer to Comment or nullptr if not found
    */
-  Comment *findCommentById(int id) noexcept;
+  Comment *findCommentById(int id);
 
   /**
    * @brief Remove a Comment object by id.
@@ -0,0 +1,84 @@
+#ifndef ISSUE_QUERY_HPP_
+#define ISSUE_QUERY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Issue.hpp"
+
+/**
+ * @brief Typed issue filter that repositories can push down to storage.
+ *
+ * Every set criterion must hold (logical AND); unset criteria match
+ * everything, so a default-constructed query matches every issue.
+ * Results are ordered by ascending issue id.
+ */
+struct IssueQuery {
+  /// Status, compared ignoring case, spaces, '-' and '_'.
+  std::optional<std::string> status;
+  /// Exact assignee user id.
+  std::optional<std::string> assignee;
+  /// Author user id, compared case-insensitively.
+  std::optional<std::string> author;
+  /// Issue carries at least one of these tags (ignored when empty).
+  std::vector<std::string> tagsAny;
+  /// Issue carries every one of these tags (ignored when empty).
+  std::vector<std::string> tagsAll;
+  /// created_at >= createdFrom (epoch ms).
+  std::optional<Issue::TimePoint> createdFrom;
+  /// created_at < createdTo (epoch ms).
+  std::optional<Issue::TimePoint> createdTo;
+  /// Issue is linked to this milestone.
+  std::optional<int> milestoneId;
+  /// Only issues without an assignee.
+  bool unassignedOnly{false};
+
+  /**
+   * @brief Evaluate every criterion except milestoneId against an issue.
+   *
+   * Used by repositories that cannot compile the query; milestone
+   * membership is not part of Issue and has to be checked separately.
+   */
+  bool matches(const Issue& issue) const;
+
+  /// @brief Normalized form used for status comparison.
+  static std::string statusKey(const std::string& status);
+};
+
+/// @brief Order of paged issue lists; ties are always broken by id.
+enum class IssueSort { kId, kCreatedAt };
+
+/**
+ * @brief Keyset position: the (sort key, id) of the last issue returned.
+ *
+ * Clients treat the encoded form as opaque and hand it back unchanged.
+ */
+struct IssueCursor {
+  IssueSort sort{IssueSort::kId};
+  std::int64_t sortKey{0};
+  int id{0};
+
+  /// @brief URL-safe opaque token.
+  std::string encode() const;
+
+  /// @brief Parse a token from encode(); std::nullopt if malformed.
+  static std::optional<IssueCursor> decode(const std::string& token);
+};
+
+/// @brief One page of a query: at most limit issues after the cursor.
+struct IssuePageRequest {
+  std::size_t limit{50};
+  IssueSort sort{IssueSort::kId};
+  std::optional<IssueCursor> after;  ///< must use the same sort
+};
+
+/// @brief Result page; next is set when more issues follow.
+struct IssuePage {
+  std::vector<Issue> issues;
+  std::optional<IssueCursor> next;
+};
+
+#endif  // ISSUE_QUERY_HPP_
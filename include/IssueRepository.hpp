@@ -2,11 +2,19 @@
 #define ISSUE_REPOSITORY_H_INCLUDED
 
 #include <functional>
+#include <optional>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "Comment.hpp"
+#include "CommentPage.hpp"
 #include "Issue.hpp"
+#include "IssueQuery.hpp"
+#include "IssueSearch.hpp"
+#include "IssueStats.hpp"
+#include "IssueSummary.hpp"
 #include "User.hpp"
 #include "Milestone.hpp"
 #include "Tag.hpp"
@@ -37,6 +45,20 @@ class IssueRepository {
   virtual std::vector<Issue> findIssues(
       std::function<bool(const Issue&)> criteria) const = 0;
 
+  /// Find issues matching a typed query
+  virtual std::vector<Issue> findIssues(const IssueQuery& query) const = 0;
+
+  /// One page of a typed query, resumed after page.after. Throws
+  /// std::invalid_argument if the cursor was issued for another sort.
+  virtual IssuePage findIssuePage(const IssueQuery& query,
+                                  const IssuePageRequest& page) const = 0;
+
+  /// Listing projections of the issues matching a query
+  virtual std::vector<IssueSummary> findIssueSummaries(
+      const IssueQuery& query) const = 0;
+  virtual IssueSummaryPage findIssueSummaryPage(
+      const IssueQuery& query, const IssuePageRequest& page) const = 0;
+
   /// Find issues assigned to a specific user
   virtual std::vector<Issue> findIssues(
       const std::string& userId) const;
@@ -44,6 +66,20 @@ class IssueRepository {
   /// List all unassigned issues
   virtual std::vector<Issue> listAllUnassigned() const;
 
+  /// Counts of the issues matching a query by status, assignee and tag
+  virtual IssueStats countIssues(const IssueQuery& query) const = 0;
+
+  /// Full-text search over titles and comments. Throws
+  /// std::invalid_argument when the request has no terms.
+  virtual SearchPage searchIssues(const SearchRequest& request) const = 0;
+
+  /// Creates new issues with their comments and tags as one unit and
+  /// returns their ids in input order. Each issue's comments are stored in
+  /// order with ids from 0, and the description follows its comment.
+  /// Timestamps of 0 become the current time. Throws
+  /// std::invalid_argument for an issue that already has an id.
+  virtual std::vector<int> importIssues(const std::vector<Issue>& issues) = 0;
+
   // ===================== TAGS =====================
 
   /// Add a tag to an issue
@@ -70,6 +106,15 @@ class IssueRepository {
   virtual std::vector<Comment> getAllComments(
       int issueId) const = 0;
 
+  /// One page of an issue's comments. Throws like getAllComments.
+  virtual CommentPage getCommentPage(int issueId,
+                                     const CommentPageRequest& page) const = 0;
+
+  /// An issue with its description and newest comments only. Throws
+  /// like getIssue.
+  virtual IssueDigest getIssueDigest(int issueId,
+                                     std::size_t latest) const = 0;
+
   /// Create or update a comment
   virtual Comment saveComment(int issueId,
                               const Comment& comment) = 0;
@@ -124,6 +169,40 @@ class IssueRepository {
   virtual std::vector<Issue> getIssuesForMilestone(
       int milestoneId) const = 0;
 
+  /// Status counts of a milestone's issues. Throws std::out_of_range if
+  /// the milestone does not exist.
+  virtual MilestoneStats getMilestoneStats(int milestoneId) const = 0;
+
+  /// Milestones whose [start, end] overlaps [from, to], ordered like
+  /// listAllMilestones. Dates compare as text, so ISO-8601 dates order
+  /// correctly; an empty bound is open.
+  virtual std::vector<Milestone> findMilestonesInRange(
+      const std::string& from, const std::string& to) const = 0;
+
+  /// Milestones that have issues and none of them open.
+  virtual std::vector<Milestone> findCompletedMilestones() const = 0;
+
+  // ===================== UNITS OF WORK =====================
+
+  /// Runs work as one unit: its writes through this repository commit
+  /// together, or none of them does if work throws (the exception
+  /// propagates). Units nest; an inner unit that throws undoes only its
+  /// own writes.
+  virtual void runInTransaction(const std::function<void()>& work) = 0;
+
+  /// runInTransaction for work that returns a value.
+  template <typename Fn>
+  auto inTransaction(Fn&& work) {
+    using Result = decltype(work());
+    if constexpr (std::is_void_v<Result>) {
+      runInTransaction(std::forward<Fn>(work));
+    } else {
+      std::optional<Result> result;
+      runInTransaction([&] { result.emplace(work()); });
+      return std::move(*result);
+    }
+  }
+
   /// Virtual destructor
   virtual ~IssueRepository() = default;
 };
@@ -0,0 +1,39 @@
+#ifndef ISSUE_SEARCH_HPP_
+#define ISSUE_SEARCH_HPP_
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Full-text search over issue titles and comment bodies.
+ *
+ * text holds whitespace-separated terms that must all occur in the same
+ * title or comment. A term ending in '*' matches as a prefix.
+ */
+struct SearchRequest {
+  std::string text;
+  std::size_t limit{20};
+  std::size_t offset{0};
+
+  /// @brief The terms of text, '*' kept; empty if text has none.
+  std::vector<std::string> terms() const;
+};
+
+/// @brief One match: an issue title or one of the issue's comments.
+struct SearchHit {
+  int issueId{0};
+  int commentId{-1};    ///< -1 => the title matched
+  std::string title;    ///< title of the matching issue
+  std::string snippet;  ///< matched text, terms wrapped in [ and ]
+  double score{0};      ///< lower ranks first (BM25 in SQLite)
+};
+
+/// @brief Ranked hits; nextOffset is set when more follow.
+struct SearchPage {
+  std::vector<SearchHit> hits;
+  std::optional<std::size_t> nextOffset;
+};
+
+#endif  // ISSUE_SEARCH_HPP_
@@ -0,0 +1,52 @@
+#ifndef ISSUE_STATS_HPP_
+#define ISSUE_STATS_HPP_
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+/**
+ * @brief Issue counts grouped for dashboards.
+ *
+ * Every map is keyed by the stored value; an issue with several tags
+ * counts once per tag, and untagged issues appear in no tag bucket.
+ */
+struct IssueStats {
+  std::size_t total{0};
+  std::size_t unassigned{0};
+  std::map<std::string, std::size_t> byStatus;
+  std::map<std::string, std::size_t> byAssignee;  ///< assigned issues only
+  std::map<std::string, std::size_t> byTag;
+
+  bool operator==(const IssueStats& other) const {
+    return total == other.total && unassigned == other.unassigned &&
+           byStatus == other.byStatus && byAssignee == other.byAssignee &&
+           byTag == other.byTag;
+  }
+};
+
+/**
+ * @brief Progress of the issues linked to one milestone.
+ *
+ * An issue is closed when its status is "Done" in any of the spellings
+ * IssueQuery accepts.
+ */
+struct MilestoneStats {
+  int milestoneId{-1};
+  std::size_t total{0};
+  std::size_t closed{0};
+  std::map<std::string, std::size_t> byStatus;
+
+  /// Closed issues in percent; 0 for a milestone without issues.
+  double percentComplete() const {
+    return total == 0 ? 0.0 : 100.0 * static_cast<double>(closed) /
+                                  static_cast<double>(total);
+  }
+
+  bool operator==(const MilestoneStats& other) const {
+    return milestoneId == other.milestoneId && total == other.total &&
+           closed == other.closed && byStatus == other.byStatus;
+  }
+};
+
+#endif  // ISSUE_STATS_HPP_
@@ -0,0 +1,53 @@
+#ifndef ISSUE_SUMMARY_HPP_
+#define ISSUE_SUMMARY_HPP_
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Comment.hpp"
+#include "Issue.hpp"
+#include "IssueQuery.hpp"
+
+/**
+ * @brief Listing projection of an Issue without its comments.
+ *
+ * Carries the metadata list views show; comments are reduced to a count
+ * and tags to their names, so large lists stay cheap to load and emit.
+ */
+struct IssueSummary {
+  int id{0};
+  std::string title;
+  std::string status;
+  std::string assignedTo;  ///< empty when unassigned
+  std::string authorId;
+  Issue::TimePoint createdAt{0};
+  std::vector<std::string> tags;  ///< sorted tag names
+  std::size_t commentCount{0};
+
+  /// @brief Project a fully loaded issue.
+  static IssueSummary of(const Issue& issue);
+};
+
+/// @brief Summary counterpart of IssuePage.
+struct IssueSummaryPage {
+  std::vector<IssueSummary> summaries;
+  std::optional<IssueCursor> next;
+};
+
+/**
+ * @brief Single-issue view with the description and newest comments only.
+ *
+ * Costs the same for a thread of any length, unlike a full Issue.
+ */
+struct IssueDigest {
+  IssueSummary summary;
+  std::optional<Comment> description;
+  std::vector<Comment> latestComments;  ///< ascending id, no description
+
+  /// @brief Project a fully loaded issue, keeping latest comments.
+  static IssueDigest of(const Issue& issue, std::size_t latest);
+};
+
+#endif  // ISSUE_SUMMARY_HPP_
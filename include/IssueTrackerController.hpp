@@ -9,7 +9,12 @@
 #include <vector>
 
 #include "Comment.hpp"
+#include "CommentPage.hpp"
 #include "Issue.hpp"
+#include "IssueQuery.hpp"
+#include "IssueSearch.hpp"
+#include "IssueStats.hpp"
+#include "IssueSummary.hpp"
 #include "IssueRepository.hpp"
 #include "Milestone.hpp"
 #include "User.hpp"
@@ -20,6 +25,8 @@
  * The IssueTrackerController acts as the intermediary between the view
  * (or REST layer) and the data layer. It handles business logic and
  * coordinates operations between issues, comments, and users in the system.
+ * Methods that read and then write, or write more than once, run as one
+ * repository unit of work, so they commit once and never half-apply.
  */
 class IssueTrackerController {
  private:
@@ -49,6 +56,16 @@ class IssueTrackerController {
   virtual Issue createIssue(const std::string& title, const std::string& desc,
                             const std::string& assignedTo);
 
+  /**
+   * @brief Creates issues with their comments and tags in one unit
+   *
+   * @param issues New issues, see IssueRepository::importIssues
+   * @return std::vector<int> Their ids, in order
+   * @throws std::invalid_argument if an author, commenter or assignee is
+   * not a user, or an issue already has an id
+   */
+  virtual std::vector<int> importIssues(const std::vector<Issue>& issues);
+
   /**
    * @brief Retrieves an issue by its ID
    *
@@ -101,6 +118,25 @@ class IssueTrackerController {
    */
   virtual std::vector<Comment> getallComments(int issueId);
 
+  /**
+   * @brief Gets one page of the comments on an issue
+   *
+   * @param issueId The ID of the issue
+   * @param page Page size and the comment id to continue after
+   * @return CommentPage Comments in id order and the next page's cursor
+   */
+  virtual CommentPage getCommentPage(int issueId,
+                                     const CommentPageRequest& page);
+
+  /**
+   * @brief Gets an issue with its description and newest comments only
+   *
+   * @param issueId The ID of the issue
+   * @param latest How many comments besides the description to include
+   * @return IssueDigest The issue digest
+   */
+  virtual IssueDigest getIssueDigest(int issueId, std::size_t latest);
+
   /**
    * @brief Retrieves a specific comment from an issue
    *
@@ -191,6 +227,60 @@ class IssueTrackerController {
    */
   virtual std::vector<Issue> findIssuesByUserId(const std::string& user_name);
 
+  /**
+   * @brief Finds issues matching every criterion of a typed query
+   *
+   * @param query Filter evaluated by the repository
+   * @return std::vector<Issue> Matching issues ordered by id
+   */
+  virtual std::vector<Issue> findIssues(const IssueQuery& query);
+
+  /**
+   * @brief Returns one page of the issues matching a query
+   *
+   * @param query Filter evaluated by the repository
+   * @param page Page size, sort order and the cursor to continue from
+   * @return IssuePage The page and, if more issues follow, its cursor
+   */
+  virtual IssuePage findIssuePage(const IssueQuery& query,
+                                  const IssuePageRequest& page);
+
+  /**
+   * @brief Finds listing summaries (no comments) of the matching issues
+   *
+   * @param query Filter evaluated by the repository
+   * @return std::vector<IssueSummary> Matching summaries ordered by id
+   */
+  virtual std::vector<IssueSummary> findIssueSummaries(
+      const IssueQuery& query);
+
+  /**
+   * @brief Returns one page of summaries of the matching issues
+   *
+   * @param query Filter evaluated by the repository
+   * @param page Page size, sort order and the cursor to continue from
+   * @return IssueSummaryPage The page and, if more follow, its cursor
+   */
+  virtual IssueSummaryPage findIssueSummaryPage(
+      const IssueQuery& query, const IssuePageRequest& page);
+
+  /**
+   * @brief Counts the matching issues by status, assignee and tag
+   *
+   * @param query Filter evaluated by the repository
+   * @return IssueStats Totals and per-group counts
+   */
+  virtual IssueStats countIssues(const IssueQuery& query);
+
+  /**
+   * @brief Ranked full-text search over issue titles and comments
+   *
+   * @param request Terms plus the limit and offset of the page
+   * @return SearchPage The hits and, if more follow, the next offset
+   * @throws std::invalid_argument if the request has no terms
+   */
+  virtual SearchPage searchIssues(const SearchRequest& request);
+
         /**
      * @brief Find issues that have a specific tag
      * @param status The status to search for
@@ -311,24 +401,27 @@ class IssueTrackerController {
   /**
    * Get milestone statistics (issue count, completion percentage, etc.)
    * @param milestoneId - The milestone ID
-   * @return Statistics as formatted string or structured data
+   * @return Issue counts by status and the closed share
+   * @throws std::out_of_range if milestone doesn't exist
    */
-  std::string getMilestoneStatistics(int milestoneId);
+  MilestoneStats getMilestoneStatistics(int milestoneId);
 
   /**
    * Find milestones by date range
    * @param startDate - Start date filter (optional, empty for no filter)
    * @param endDate - End date filter (optional, empty for no filter)
-   * @return Vector of Milestone objects within the date range
+   * @return Vector of Milestone objects whose schedule overlaps the range
+   * @throws std::invalid_argument if startDate is after endDate
    */
   std::vector<Milestone> findMilestonesByDateRange(const std::string& startDate,
                                                    const std::string& endDate);
 
   /**
    * Get active milestones (current date is between start and end date)
+   * @param onDate - Date to check instead of today (YYYY-MM-DD, UTC)
    * @return Vector of currently active Milestone objects
    */
-  std::vector<Milestone> getActiveMilestones();
+  std::vector<Milestone> getActiveMilestones(const std::string& onDate = "");
 
   /**
    * Get completed milestones (all issues closed)
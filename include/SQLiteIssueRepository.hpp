@@ -3,21 +3,78 @@
 
 #include <sqlite3.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "IssueRepository.hpp"
 #include "Milestone.hpp"
+#include "SqliteStatementCache.hpp"
+#include "StorageProfile.hpp"
 
 
 // Concrete IssueRepository implementation backed by SQLite.
+//
+// File databases run in WAL mode with one writer connection and a bounded,
+// lazily grown pool of read-only connections. Const methods lease a reader
+// (inside a read transaction, so multi-statement loads see one snapshot)
+// and run in parallel with each other and with the writer; mutating
+// methods serialize on the writer. In-memory databases cannot be shared
+// between connections, so they route reads through the writer as well.
 class SQLiteIssueRepository : public IssueRepository {
  private:
-  sqlite3* db_;
+  // A connection and its prepared-statement cache.
+  struct Connection;
+  // Binds a connection to the calling thread for the duration of a public
+  // call; nested scopes on the same thread reuse the outer connection.
+  class ConnectionScope;
+
+  std::size_t maxReaders_;
+  StorageProfile profile_;
+  const bool countStatements_;  // trace connections for the counter
+  std::atomic<std::size_t> executedStatements_;
+  std::unique_ptr<Connection> writer_;
+  mutable std::mutex writerMutex_;
+  mutable std::mutex readersMutex_;
+  mutable std::condition_variable readerReleased_;
+  mutable std::vector<std::unique_ptr<Connection>> readers_;
+  mutable std::vector<Connection*> idleReaders_;
+  std::string readerPath_;  // empty => no reader pool
+
+  std::unique_ptr<Connection> openConnection(const std::string& path,
+                                             int flags) const;
+  // Waits up to the profile's busy timeout for a pooled reader, then
+  // throws std::runtime_error.
+  Connection* acquireReader() const;
+  void releaseReader(Connection* reader) const;
+  // A read-only connection outside the pool, in a read transaction.
+  std::unique_ptr<Connection> openSnapshot() const;
+
+  // Connection bound to the calling thread by the innermost scope.
+  Connection& connection() const;
+
+  // Every statement goes through the current connection's cache.
+  SqliteStatementCache::Lease prepare(const std::string& sql) const;
 
   void execOrThrow(const std::string& sql) const;
+
+  // Applies the migration steps the database has not completed yet. Step
+  // N runs in one transaction with the bump of PRAGMA user_version to N,
+  // so an up-to-date database costs a single read at startup.
   void initializeSchema();
+  void createBaseSchema();
+  void addLegacyColumns();
+  void createSecondaryIndexes();
+  void createSearchIndex();
+  void createStatsIndexes();
+  void createMilestoneScheduleIndexes();
+  void addCommentSequence();
+  bool hasColumn(const std::string& table, const std::string& column) const;
 
   bool exists(const std::string& sql,
               const std::function<void(sqlite3_stmt*)>& binder = nullptr) const;
@@ -27,28 +84,216 @@ class SQLiteIssueRepository : public IssueRepository {
                   const std::function<void(sqlite3_stmt*)>& onRow) const;
 
   Comment insertCommentRow(int issueId, const Comment& comment, int commentId);
+  // Inserts under the issue's next comment id in a single statement.
+  Comment appendCommentRow(int issueId, const Comment& comment);
   std::vector<Comment> loadComments(int issueId) const;
+
+  // Loads every issue matching filterSql (a WHERE clause over `issues`,
+  // or empty for all rows) together with its comments and tags using a
+  // fixed number of statements. binder is applied to each statement.
+  // selectionSql (ORDER BY/LIMIT) replaces the default id order and also
+  // limits which issues' comments and tags are read. deferComments skips
+  // the comment read and gives each issue a loader that runs on first
+  // access instead.
+  std::vector<Issue> hydrateIssues(
+      const std::string& filterSql,
+      const std::function<void(sqlite3_stmt*)>& binder,
+      const std::string& selectionSql = "",
+      bool deferComments = false) const;
+  // Summary counterpart of hydrateIssues, in a single statement.
+  std::vector<IssueSummary> loadSummaries(
+      const std::string& filterSql,
+      const std::function<void(sqlite3_stmt*)>& binder,
+      const std::string& selectionSql = "") const;
   bool issueExists(int issueId) const;
   bool commentExists(int issueId, int commentId) const;
-  int nextCommentIdForIssue(int issueId) const;
   std::vector<int> loadMilestoneIssueIds(int milestoneId) const;
+  // Milestones matching filterSql (a WHERE clause over `milestones`, or
+  // empty for all rows) in start date order, with their issue ids, in a
+  // single statement. The id column must be written milestones.id.
+  std::vector<Milestone> loadMilestones(
+      const std::string& filterSql,
+      const std::function<void(sqlite3_stmt*)>& binder) const;
   bool milestoneExists(int milestoneId) const;
 
  public:
-  explicit SQLiteIssueRepository(const std::string& dbPath);
+  // maxReaders bounds the read-only pool; 0 sends every read through the
+  // writer connection. profile is applied to every connection opened.
+  // countStatements traces every connection for executedStatementCount,
+  // at the cost of a callback per statement; tests use it, servers not.
+  explicit SQLiteIssueRepository(
+      const std::string& dbPath,
+      std::size_t maxReaders = defaultReaderPoolSize(),
+      const StorageProfile& profile = StorageProfile(),
+      bool countStatements = false);
   ~SQLiteIssueRepository() override;
 
+  // One reader per hardware thread, clamped to [2, 16].
+  static std::size_t defaultReaderPoolSize();
+
+  // Number of SQL statements executed on all connections so far; always
+  // 0 unless constructed with countStatements.
+  std::size_t executedStatementCount() const;
+
+  // Hit/miss counters of the prepared-statement caches, summed over all
+  // connections.
+  SqliteStatementCache::Stats statementCacheStats() const;
+
+  // Storage settings as the writer connection reports them, under the
+  // configured profile's name. Values SQLite clamps (e.g. mmap_size above
+  // its compile-time limit) show as applied, not as requested. The write
+  // batch settings are not the repository's and show as configured.
+  StorageProfile storageSettings() const;
+
+  // Journal mode reported by the writer connection (e.g. "wal").
+  std::string journalMode() const;
+
+  // Called after each backup step, including one that found the target
+  // locked, with the pages copied so far and the source's page count;
+  // returning false abandons the backup.
+  using BackupObserver = std::function<bool(int copied, int total)>;
+
+  // Online backup into a new database file at targetPath, which is
+  // replaced if present, pagesPerStep pages per sqlite3_backup_step. The
+  // pages are read from one snapshot on a connection outside the reader
+  // pool, so reads and writes carry on while it runs, and the copy is the
+  // database as of its start. Returns false if onStep abandoned it,
+  // leaving a partial file behind.
+  // Throws std::runtime_error if SQLite fails or the target stays locked
+  // for longer than the profile's busy timeout.
+  bool backupTo(const std::string& targetPath, int pagesPerStep,
+                const BackupObserver& onStep = nullptr) const;
+
+  // Runs the reads most requests begin with (first issue pages, counts,
+  // users, tags, milestones) on one reader, so their statements are
+  // prepared and the pages they touch are cached before traffic arrives.
+  // Idle readers are reused most recent first, so the next request gets
+  // the warmed one.
+  void warmUp() const;
+
+  // Read-only connections opened so far (never above maxReaders).
+  std::size_t readerConnectionCount() const;
+
+  // Migration step recorded in the database (PRAGMA user_version).
+  int schemaVersion() const;
+
+  // Step every database is migrated to on open.
+  static int latestSchemaVersion();
+
+  // Pull-based scan of issues for exports and other reads too large to
+  // collect. A stream keeps its statements live inside one read
+  // transaction and materializes one issue (with its comments and tags) per
+  // next(), so memory stays bounded by a single issue whatever the table
+  // size. A stream belongs to the thread that opened it: repository calls
+  // made on that thread while it is open read its snapshot, streams open
+  // together must be destroyed in reverse order, and on an in-memory
+  // database it holds the writer until destroyed. The repository must
+  // outlive it.
+  class IssueStream {
+   public:
+    IssueStream(IssueStream&& other) noexcept;
+    IssueStream& operator=(IssueStream&&) = delete;
+    ~IssueStream();
+
+    // Moves the next issue in id order into *out; false once exhausted.
+    bool next(Issue* out);
+
+   private:
+    friend class SQLiteIssueRepository;
+    struct State;
+    explicit IssueStream(std::unique_ptr<State> state);
+
+    std::unique_ptr<State> state_;
+  };
+
+  // Comment counterpart of IssueStream over a single issue, in id order.
+  class CommentStream {
+   public:
+    CommentStream(CommentStream&& other) noexcept;
+    CommentStream& operator=(CommentStream&&) = delete;
+    ~CommentStream();
+
+    bool next(Comment* out);
+
+   private:
+    friend class SQLiteIssueRepository;
+    struct State;
+    explicit CommentStream(std::unique_ptr<State> state);
+
+    std::unique_ptr<State> state_;
+  };
+
+  // Whole-database view for exports: users and milestones as of one read
+  // snapshot, and any number of passes over the issues of that same
+  // snapshot. Users and milestones are few next to issues and are read up
+  // front; issues are only ever streamed. On a file database the snapshot
+  // has a connection of its own, so a slow export never holds a pooled
+  // reader. Thread affinity and lifetime are those of an IssueStream, and
+  // streams taken from a snapshot must be destroyed before it.
+  class ExportSnapshot {
+   public:
+    ExportSnapshot(ExportSnapshot&& other) noexcept;
+    ExportSnapshot& operator=(ExportSnapshot&&) = delete;
+    ~ExportSnapshot();
+
+    const std::vector<User>& users() const;
+    const std::vector<Milestone>& milestones() const;
+    // Every issue in id order; each call starts another pass.
+    IssueStream issues() const;
+
+   private:
+    friend class SQLiteIssueRepository;
+    struct State;
+    explicit ExportSnapshot(std::unique_ptr<State> state);
+
+    std::unique_ptr<State> state_;
+  };
+
+  // Issues matching query, merged from three ordered statements (issues,
+  // comments, tags) advanced in step.
+  IssueStream streamIssues(const IssueQuery& query = IssueQuery()) const;
+  // Throws std::invalid_argument if the issue does not exist.
+  CommentStream streamComments(int issueId) const;
+  ExportSnapshot openExportSnapshot() const;
+
+  // Holds the writer for the whole unit inside one BEGIN IMMEDIATE
+  // transaction, so the unit costs a single commit; reads made by work see
+  // its own uncommitted writes. Nested units become savepoints.
+  void runInTransaction(const std::function<void()>& work) override;
+
   // ---- Issue operations ----
+  // Comments are loaded on first access, in a later read transaction, so
+  // metadata-only edits never read them. The issue must not outlive the
+  // repository until its comments are loaded.
   Issue getIssue(int issueId) const override;
   Issue saveIssue(const Issue& issue) override;
   bool deleteIssue(int issueId) override;
 
+  // Bulk path: one transaction, with the issue, comment and tag INSERTs
+  // each leased once and rebound per row, and no read-back.
+  std::vector<int> importIssues(const std::vector<Issue>& issues) override;
+
   std::vector<Issue> listIssues() const override;
 
   // Generic predicate-based search (used by some tests/tools).
   std::vector<Issue> findIssues(
       std::function<bool(const Issue&)> criteria) const override;
 
+  // Typed search compiled to a single parameterized WHERE clause.
+  std::vector<Issue> findIssues(const IssueQuery& query) const override;
+
+  // Keyset page: seeks past the cursor on (sort key, id), so the cost of a
+  // page does not grow with its depth.
+  IssuePage findIssuePage(const IssueQuery& query,
+                          const IssuePageRequest& page) const override;
+
+  // Summaries read only issue columns plus per-issue comment counts and
+  // tag names; comment rows are never loaded.
+  std::vector<IssueSummary> findIssueSummaries(
+      const IssueQuery& query) const override;
+  IssueSummaryPage findIssueSummaryPage(
+      const IssueQuery& query, const IssuePageRequest& page) const override;
+
   // Milestone helpers:
   //  - all issues with no assignee
   std::vector<Issue> listAllUnassigned() const override;
@@ -56,6 +301,13 @@ class SQLiteIssueRepository : public IssueRepository {
   std::vector<Issue> findIssues(
       const std::string& userId) const override;
 
+  // Three GROUP BY statements over one snapshot; no issue is loaded.
+  IssueStats countIssues(const IssueQuery& query) const override;
+
+  // BM25-ranked FTS5 query over issue titles and comment texts. Triggers
+  // keep both indexes in step with every write, including cascades.
+  SearchPage searchIssues(const SearchRequest& request) const override;
+
   // ---- Tag operations ----
   std::vector<Tag> listAllTags() const override;
   bool deleteTag(const std::string& tag) override;
@@ -65,6 +317,11 @@ class SQLiteIssueRepository : public IssueRepository {
   // ---- Comment operations ----
   Comment getComment(int issueId, int commentId) const override;
   std::vector<Comment> getAllComments(int issueId) const override;
+  // Seeks the (issue_id, id) key, so a page costs the same at any depth.
+  CommentPage getCommentPage(int issueId,
+                             const CommentPageRequest& page) const override;
+  // Reads the description and the newest comments, no other comment rows.
+  IssueDigest getIssueDigest(int issueId, std::size_t latest) const override;
   Comment saveComment(int issueId, const Comment& comment) override;
   bool deleteComment(int issueId, int commentId) override;
 
@@ -126,6 +383,29 @@ class SQLiteIssueRepository : public IssueRepository {
    * @return Vector of issues belonging to this milestone
    */
   std::vector<Issue> getIssuesForMilestone(int milestoneId) const override;
+
+  /**
+   * Status counts of a milestone's issues in one aggregate statement
+   * @param milestoneId - The milestone ID
+   * @return Counts by status and the number of closed issues
+   */
+  MilestoneStats getMilestoneStats(int milestoneId) const override;
+
+  /**
+   * Milestones whose schedule overlaps a date range, via the start and
+   * end date indexes
+   * @param from - Lower bound on the end date, empty for none
+   * @param to - Upper bound on the start date, empty for none
+   * @return Matching milestones in start date order
+   */
+  std::vector<Milestone> findMilestonesInRange(
+      const std::string& from, const std::string& to) const override;
+
+  /**
+   * Milestones that have issues and none of them open
+   * @return Completed milestones in start date order
+   */
+  std::vector<Milestone> findCompletedMilestones() const override;
 };
 
 #endif  // TEXT_BASED_ITS_SQLITEISSUEREPOSITORY_HPP_
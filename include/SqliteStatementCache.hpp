@@ -0,0 +1,104 @@
+#ifndef SQLITE_STATEMENT_CACHE_HPP_
+#define SQLITE_STATEMENT_CACHE_HPP_
+
+#include <sqlite3.h>
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Per-connection cache of prepared statements keyed by SQL text.
+ *
+ * acquire() hands out a Lease on a prepared statement. When the lease is
+ * released the statement is reset and its bindings cleared so the next
+ * caller starts from a clean state. If the cached statement for a given
+ * SQL text is already leased (e.g. a nested query with the same text), a
+ * one-off statement is prepared and finalized on release instead. When
+ * the cache is full, a new text replaces the least recently used statement
+ * that is not leased; only if every cached statement is leased does it
+ * get a one-off statement.
+ *
+ * A cache belongs to exactly one connection and is not thread-safe; the
+ * owner must serialize access the same way it serializes the connection.
+ * stats() only reads atomic counters and may be called from any thread.
+ */
+class SqliteStatementCache {
+ public:
+  /// @brief Snapshot of the cache counters.
+  struct Stats {
+    std::size_t hits{0};    ///< acquisitions served by a cached statement
+    std::size_t misses{0};  ///< acquisitions that had to prepare SQL
+    std::size_t size{0};    ///< statements currently cached
+  };
+
+  /**
+   * @brief RAII handle on a prepared statement.
+   */
+  class Lease {
+   public:
+    Lease(Lease&& other) noexcept;
+    Lease& operator=(Lease&&) = delete;
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+    ~Lease();
+
+    /// @brief Underlying statement, valid for the lifetime of the lease.
+    sqlite3_stmt* get() const noexcept { return stmt_; }
+
+   private:
+    friend class SqliteStatementCache;
+    Lease(sqlite3_stmt* stmt, bool* inUse) : stmt_(stmt), inUse_(inUse) {}
+
+    sqlite3_stmt* stmt_;
+    bool* inUse_;  ///< cache slot flag; nullptr => one-off statement
+  };
+
+  /**
+   * @brief Create a cache for a connection.
+   * @param db        open connection the statements are prepared on
+   * @param capacity  maximum number of distinct SQL texts kept prepared
+   */
+  explicit SqliteStatementCache(sqlite3* db, std::size_t capacity = 128);
+  ~SqliteStatementCache();
+
+  SqliteStatementCache(const SqliteStatementCache&) = delete;
+  SqliteStatementCache& operator=(const SqliteStatementCache&) = delete;
+
+  /**
+   * @brief Lease a prepared statement for sql.
+   * @throws std::runtime_error if the SQL fails to prepare
+   */
+  Lease acquire(const std::string& sql);
+
+  /// @brief Current hit/miss counters and size.
+  Stats stats() const;
+
+  /// @brief Finalize every cached statement that is not leased.
+  void clear();
+
+ private:
+  struct Entry {
+    sqlite3_stmt* stmt{nullptr};
+    bool inUse{false};
+    std::list<const std::string*>::iterator recent;  ///< node in recent_
+  };
+
+  /// @brief Finalize the least recently used idle entry, if there is one.
+  bool evictOne();
+
+  sqlite3_stmt* prepare(const std::string& sql) const;
+
+  sqlite3* db_;
+  std::size_t capacity_;
+  std::unordered_map<std::string, Entry> entries_;
+  /// Keys of entries_, most recently acquired first.
+  std::list<const std::string*> recent_;
+  std::atomic<std::size_t> hits_;
+  std::atomic<std::size_t> misses_;
+  std::atomic<std::size_t> size_;  ///< entries_.size(), readable lock-free
+};
+
+#endif  // SQLITE_STATEMENT_CACHE_HPP_
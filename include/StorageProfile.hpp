@@ -0,0 +1,69 @@
+#ifndef STORAGE_PROFILE_HPP_
+#define STORAGE_PROFILE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Per-connection SQLite tuning applied by SQLiteIssueRepository.
+ *
+ * Three presets trade durability for speed:
+ *  - durable: SQLite's own defaults, synchronous FULL, no memory mapping.
+ *  - balanced: synchronous NORMAL (still crash-safe in WAL mode, a power
+ *    loss may drop the last commits), 64 MiB mmap, 16 MiB cache.
+ *  - throughput: synchronous OFF, 256 MiB mmap, 64 MiB cache, and
+ *    concurrent writes grouped into shared commits.
+ * The default-constructed profile is durable, the behavior before
+ * profiles existed.
+ *
+ * writeBatch and writeBatchDelayUs are not connection settings: the
+ * service layer uses them to put a GroupCommitQueue in front of the
+ * repository.
+ */
+struct StorageProfile {
+  std::string name{"durable"};
+  std::int64_t mmapSize{0};    ///< bytes; 0 disables memory mapping
+  std::int64_t cacheSize{-2000};  ///< pages, or KiB when negative
+  std::string synchronous{"FULL"};  ///< OFF, NORMAL, FULL or EXTRA
+  std::string tempStore{"DEFAULT"};  ///< DEFAULT, FILE or MEMORY
+  int busyTimeoutMs{5000};
+  std::size_t writeBatch{0};  ///< writes per commit; 0 commits each alone
+  std::int64_t writeBatchDelayUs{0};  ///< wait for a fuller batch
+
+  /// @throws std::invalid_argument for an unknown preset name
+  static StorageProfile preset(const std::string& name);
+
+  /**
+   * @brief Overrides one setting by its config key: mmap_size, cache_size,
+   * synchronous, temp_store, busy_timeout, write_batch or
+   * write_batch_delay_us.
+   * @throws std::invalid_argument for an unknown key or a bad value
+   */
+  void set(const std::string& key, const std::string& value);
+
+  /**
+   * @brief Profile for the databases next to dbPath.
+   *
+   * Starts from the preset named by ISSUE_DB_PROFILE, else by the
+   * `profile` key of storage.conf in dbPath's directory, else durable.
+   * The other storage.conf keys (`key = value` lines, '#' comments) are
+   * applied next, then ISSUE_DB_MMAP_SIZE, ISSUE_DB_CACHE_SIZE,
+   * ISSUE_DB_SYNCHRONOUS, ISSUE_DB_TEMP_STORE, ISSUE_DB_BUSY_TIMEOUT,
+   * ISSUE_DB_WRITE_BATCH and ISSUE_DB_WRITE_BATCH_DELAY_US.
+   * @throws std::invalid_argument if any of them is invalid
+   */
+  static StorageProfile load(const std::string& dbPath);
+
+  bool operator==(const StorageProfile& other) const {
+    return name == other.name && mmapSize == other.mmapSize &&
+           cacheSize == other.cacheSize &&
+           synchronous == other.synchronous &&
+           tempStore == other.tempStore &&
+           busyTimeoutMs == other.busyTimeoutMs &&
+           writeBatch == other.writeBatch &&
+           writeBatchDelayUs == other.writeBatchDelayUs;
+  }
+};
+
+#endif  // STORAGE_PROFILE_HPP_
@@ -14,7 +14,8 @@ cd "$SQLITE_SRC_DIR"
 # Some runners strip execute bits; make sure configure and its helpers are runnable
 chmod +x configure
 chmod -R +x autosetup
-bash configure --prefix="$SQLITE_PREFIX"
+# FTS5 backs the /search endpoint and is off by default
+bash configure --prefix="$SQLITE_PREFIX" --fts5
 
 # Build and install
 make -j"$(nproc || echo 2)"
@@ -0,0 +1,85 @@
+#include "GroupCommitQueue.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+GroupCommitQueue::GroupCommitQueue(IssueRepository& repo,
+                                   const Limits& limits, BatchGuard guard)
+    : repo_(repo), limits_(limits), guard_(std::move(guard)) {
+  if (limits_.maxBatch == 0) {
+    throw std::invalid_argument("write batch size must be at least 1");
+  }
+}
+
+void GroupCommitQueue::run(const std::function<void()>& work) {
+  Ticket ticket{&work, nullptr, false};
+  std::unique_lock<std::mutex> lock(mutex_);
+  pending_.push_back(&ticket);
+  arrived_.notify_one();
+
+  while (!ticket.done) {
+    if (leading_) {
+      finished_.wait(lock);
+      continue;
+    }
+    leading_ = true;
+    if (limits_.maxDelay.count() > 0) {
+      arrived_.wait_for(lock, limits_.maxDelay, [this] {
+        return pending_.size() >= limits_.maxBatch;
+      });
+    }
+    const std::size_t size = std::min(pending_.size(), limits_.maxBatch);
+    std::vector<Ticket*> batch(pending_.begin(), pending_.begin() + size);
+    pending_.erase(pending_.begin(), pending_.begin() + size);
+
+    lock.unlock();
+    commit(batch);
+    lock.lock();
+
+    for (Ticket* queued : batch) {
+      queued->done = true;
+    }
+    stats_.units += batch.size();
+    ++stats_.batches;
+    leading_ = false;
+    finished_.notify_all();
+  }
+
+  if (ticket.error) {
+    std::rethrow_exception(ticket.error);
+  }
+}
+
+void GroupCommitQueue::commit(const std::vector<Ticket*>& batch) {
+  const std::function<void()> body = [&] {
+    repo_.runInTransaction([&] {
+      for (Ticket* queued : batch) {
+        try {
+          repo_.runInTransaction(*queued->work);
+        } catch (...) {
+          queued->error = std::current_exception();
+        }
+      }
+    });
+  };
+
+  try {
+    if (guard_) {
+      guard_(body);
+    } else {
+      body();
+    }
+  } catch (...) {
+    const std::exception_ptr error = std::current_exception();
+    for (Ticket* queued : batch) {
+      if (!queued->error) {
+        queued->error = error;
+      }
+    }
+  }
+}
+
+GroupCommitQueue::Stats GroupCommitQueue::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
@@ -1,62 +1,283 @@
 #include "SQLiteIssueRepository.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <ctime>
 #include <functional>
+#include <map>
+#include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <variant>
 #include <vector>
 
 namespace {
 
-class SqliteStmt {
- public:
-  SqliteStmt(sqlite3* db, const std::string& sql) : stmt_(nullptr) {
-    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt_, nullptr)
-        != SQLITE_OK) {
-      throw std::runtime_error(sqlite3_errmsg(db));
+std::string columnText(sqlite3_stmt* stmt, int index) {
+  const unsigned char* text = sqlite3_column_text(stmt, index);
+  return text ? reinterpret_cast<const char*>(text) : std::string();
+}
+
+Comment::TimePoint currentTimeMillis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// Counts every statement execution on the connection. Trigger
+// sub-programs report their SQL as "-- <trigger>" and are not counted.
+int countExecutedStatement(unsigned type, void* context, void*, void* sql) {
+  if (type == SQLITE_TRACE_STMT) {
+    const char* text = static_cast<const char*>(sql);
+    if (text == nullptr || std::strncmp(text, "--", 2) != 0) {
+      ++*static_cast<std::atomic<std::size_t>*>(context);
     }
   }
+  return 0;
+}
 
-  ~SqliteStmt() {
-    if (stmt_ != nullptr) {
-      sqlite3_finalize(stmt_);
-      stmt_ = nullptr;
+// WHERE clause and its positional parameters compiled from an IssueQuery.
+struct CompiledQuery {
+  std::string where;
+  std::vector<std::variant<std::int64_t, std::string>> params;
+
+  void bind(sqlite3_stmt* stmt) const {
+    for (std::size_t i = 0; i < params.size(); ++i) {
+      const int index = static_cast<int>(i) + 1;
+      if (const auto* text = std::get_if<std::string>(&params[i])) {
+        sqlite3_bind_text(stmt, index, text->c_str(), -1, SQLITE_TRANSIENT);
+      } else {
+        sqlite3_bind_int64(stmt, index, std::get<std::int64_t>(params[i]));
+      }
     }
   }
+};
 
-  sqlite3_stmt* get() const { return stmt_; }
+// Status as compared by IssueQuery::statusKey. idx_issues_status_key
+// indexes this exact expression, so the two must stay identical.
+constexpr const char* kStatusKeySql =
+    "REPLACE(REPLACE(REPLACE(LOWER(status), ' ', ''), '-', ''), '_', '')";
 
-  SqliteStmt(const SqliteStmt&) = delete;
-  SqliteStmt& operator=(const SqliteStmt&) = delete;
+// FTS rowid of a comment: issue id in the high 32 bits, comment id in the
+// low ones. prefix qualifies the columns, e.g. "new.".
+std::string commentKeySql(const std::string& prefix) {
+  return "(" + prefix + "issue_id * 4294967296 + " + prefix + "id)";
+}
 
- private:
-  sqlite3_stmt* stmt_;
-};
+// FTS5 expression requiring every term. Terms are quoted so user input
+// cannot inject FTS5 syntax; a trailing '*' stays a prefix match.
+std::string ftsMatchExpression(const std::vector<std::string>& terms) {
+  std::string expression;
+  for (std::string term : terms) {
+    const bool prefix = term.size() > 1 && term.back() == '*';
+    if (prefix) {
+      term.pop_back();
+    }
+    std::string quoted = "\"";
+    for (char c : term) {
+      quoted += c;
+      if (c == '"') {
+        quoted += '"';
+      }
+    }
+    quoted += prefix ? "\"*" : "\"";
+    expression += (expression.empty() ? "" : " ") + quoted;
+  }
+  return expression;
+}
 
-std::string columnText(sqlite3_stmt* stmt, int index) {
-  const unsigned char* text = sqlite3_column_text(stmt, index);
-  return text ? reinterpret_cast<const char*>(text) : std::string();
+// JSON array of values, bound to one json_each(?) so a tag filter has the
+// same SQL text (and cached statement) however many tags it lists.
+std::string jsonArray(const std::vector<std::string>& values) {
+  static const char kHex[] = "0123456789abcdef";
+  std::string json = "[";
+  for (const std::string& value : values) {
+    json += json.size() == 1 ? "\"" : ",\"";
+    for (unsigned char c : value) {
+      if (c == '"' || c == '\\') {
+        json += '\\';
+        json += static_cast<char>(c);
+      } else if (c < 0x20) {
+        json += "\\u00";
+        json += kHex[c >> 4];
+        json += kHex[c & 0xf];
+      } else {
+        json += static_cast<char>(c);
+      }
+    }
+    json += '"';
+  }
+  return json + "]";
 }
 
-Comment::TimePoint currentTimeMillis() {
-  return std::chrono::duration_cast<std::chrono::milliseconds>(
-             std::chrono::system_clock::now().time_since_epoch())
-      .count();
+// `after` adds a keyset seek past the cursor so a page starts directly at
+// its first row instead of skipping the earlier ones.
+CompiledQuery compileQuery(const IssueQuery& query,
+                           const std::optional<IssueCursor>& after =
+                               std::nullopt) {
+  CompiledQuery compiled;
+  std::vector<std::string> clauses;
+
+  if (query.status) {
+    clauses.push_back(std::string(kStatusKeySql) + " = ?");
+    compiled.params.emplace_back(IssueQuery::statusKey(*query.status));
+  }
+  if (query.assignee) {
+    clauses.push_back("assigned_to = ?");
+    compiled.params.emplace_back(*query.assignee);
+  }
+  if (query.author) {
+    clauses.push_back("author_id = ? COLLATE NOCASE");
+    compiled.params.emplace_back(*query.author);
+  }
+  if (query.unassignedOnly) {
+    clauses.push_back("(assigned_to IS NULL OR assigned_to = '')");
+  }
+  if (query.createdFrom) {
+    clauses.push_back("created_at >= ?");
+    compiled.params.emplace_back(*query.createdFrom);
+  }
+  if (query.createdTo) {
+    clauses.push_back("created_at < ?");
+    compiled.params.emplace_back(*query.createdTo);
+  }
+  if (query.milestoneId) {
+    clauses.push_back(
+        "id IN (SELECT issue_id FROM milestone_issues "
+        "WHERE milestone_id = ?)");
+    compiled.params.emplace_back(std::int64_t{*query.milestoneId});
+  }
+  if (!query.tagsAny.empty()) {
+    clauses.push_back(
+        "id IN (SELECT issue_id FROM issue_tags "
+        "WHERE tag IN (SELECT value FROM json_each(?)))");
+    compiled.params.emplace_back(jsonArray(query.tagsAny));
+  }
+  if (!query.tagsAll.empty()) {
+    std::vector<std::string> tags = query.tagsAll;
+    std::sort(tags.begin(), tags.end());
+    tags.erase(std::unique(tags.begin(), tags.end()), tags.end());
+    clauses.push_back(
+        "id IN (SELECT issue_id FROM issue_tags "
+        "WHERE tag IN (SELECT value FROM json_each(?)) "
+        "GROUP BY issue_id HAVING COUNT(DISTINCT tag) = ?)");
+    compiled.params.emplace_back(jsonArray(tags));
+    compiled.params.emplace_back(static_cast<std::int64_t>(tags.size()));
+  }
+
+  if (after) {
+    if (after->sort == IssueSort::kId) {
+      clauses.push_back("id > ?");
+    } else {
+      clauses.push_back("(created_at, id) > (?, ?)");
+      compiled.params.emplace_back(after->sortKey);
+    }
+    compiled.params.emplace_back(std::int64_t{after->id});
+  }
+
+  for (std::size_t i = 0; i < clauses.size(); ++i) {
+    compiled.where += (i == 0 ? "WHERE " : " AND ") + clauses[i];
+  }
+  return compiled;
+}
+
+// Compiles one keyset page of query. *selection receives the ORDER BY and
+// a LIMIT of one row past the page, which tells whether another follows.
+CompiledQuery compilePage(const IssueQuery& query,
+                          const IssuePageRequest& page,
+                          std::string* selection) {
+  if (page.after && page.after->sort != page.sort) {
+    throw std::invalid_argument("cursor does not match the requested sort");
+  }
+  CompiledQuery compiled = compileQuery(query, page.after);
+  compiled.params.emplace_back(static_cast<std::int64_t>(page.limit) + 1);
+  *selection = page.sort == IssueSort::kId
+                   ? "ORDER BY id ASC LIMIT ?"
+                   : "ORDER BY created_at ASC, id ASC LIMIT ?";
+  return compiled;
+}
+
+IssueCursor cursorAt(IssueSort sort, int id, Issue::TimePoint createdAt) {
+  return IssueCursor{sort, sort == IssueSort::kId ? id : createdAt, id};
+}
+
+// String values of a json_group_array result in document order, nested
+// arrays flattened. Only the escapes SQLite's JSON writer emits are decoded;
+// a NULL aggregate has none.
+std::vector<std::string> jsonStrings(const std::string& json) {
+  std::vector<std::string> values;
+  for (std::size_t i = 0; i < json.size(); ++i) {
+    if (json[i] != '"') {
+      continue;
+    }
+    std::string value;
+    for (++i; i < json.size() && json[i] != '"'; ++i) {
+      if (json[i] != '\\' || i + 1 == json.size()) {
+        value += json[i];
+        continue;
+      }
+      const char escaped = json[++i];
+      switch (escaped) {
+        case 'b': value += '\b'; break;
+        case 'f': value += '\f'; break;
+        case 'n': value += '\n'; break;
+        case 'r': value += '\r'; break;
+        case 't': value += '\t'; break;
+        case 'u': {
+          const unsigned long code =
+              std::stoul(json.substr(i + 1, 4), nullptr, 16);
+          i += 4;
+          if (code < 0x80) {
+            value += static_cast<char>(code);
+          } else if (code < 0x800) {
+            value += static_cast<char>(0xc0 | (code >> 6));
+            value += static_cast<char>(0x80 | (code & 0x3f));
+          } else {
+            value += static_cast<char>(0xe0 | (code >> 12));
+            value += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            value += static_cast<char>(0x80 | (code & 0x3f));
+          }
+          break;
+        }
+        default: value += escaped; break;
+      }
+    }
+    values.push_back(std::move(value));
+  }
+  return values;
 }
 
+// BEGIN IMMEDIATE ... COMMIT, rolled back unless committed. Inside an
+// open transaction it becomes a savepoint instead, so a failed inner unit
+// undoes only its own writes and the outer one decides the commit.
 class SqliteTxn {
  public:
-  explicit SqliteTxn(sqlite3* db) : db_(db), active_(true) {
-    if (sqlite3_exec(db_, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) !=
-        SQLITE_OK) {
-      throw std::runtime_error(sqlite3_errmsg(db_));
-    }
+  SqliteTxn(sqlite3* db, SqliteStatementCache& statements)
+      : statements_(statements),
+        nested_(!sqlite3_get_autocommit(db)),
+        active_(true) {
+    run(nested_ ? "SAVEPOINT unit;" : "BEGIN IMMEDIATE;");
   }
 
   ~SqliteTxn() {
     if (active_) {
-      sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+      try {
+        if (nested_) {
+          run("ROLLBACK TO unit;");
+          run("RELEASE unit;");
+        } else {
+          run("ROLLBACK;");
+        }
+      } catch (const std::runtime_error&) {
+        // Nothing more can be done from a destructor.
+      }
     }
   }
 
@@ -64,38 +285,377 @@ class SqliteTxn {
     if (!active_) {
       return;
     }
-    if (sqlite3_exec(db_, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK) {
-      throw std::runtime_error(sqlite3_errmsg(db_));
-    }
+    run(nested_ ? "RELEASE unit;" : "COMMIT;");
     active_ = false;
   }
 
  private:
-  sqlite3* db_;
+  void run(const char* sql) {
+    auto stmt = statements_.acquire(sql);
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+      throw std::runtime_error(
+          sqlite3_errmsg(sqlite3_db_handle(stmt.get())));
+    }
+  }
+
+  SqliteStatementCache& statements_;
+  bool nested_;
   bool active_;
 };
 }  // namespace
 
+struct SQLiteIssueRepository::Connection {
+  explicit Connection(sqlite3* handle) : db(handle), statements(handle) {}
+
+  ~Connection() {
+    // Cached statements must be finalized before the connection closes.
+    statements.clear();
+    sqlite3_close_v2(db);
+  }
+
+  Connection(const Connection&) = delete;
+  Connection& operator=(const Connection&) = delete;
+
+  sqlite3* db;
+  SqliteStatementCache statements;
+};
+
+class SQLiteIssueRepository::ConnectionScope {
+ public:
+  // kSnapshot reads like kRead, but on a connection of its own outside
+  // the pool, for long-lived snapshots (exports, backups) that would
+  // otherwise keep a pooled reader from other requests.
+  enum Mode { kRead, kWrite, kSnapshot };
+
+  ConnectionScope(const SQLiteIssueRepository& repo, Mode mode)
+      : repo_(repo),
+        connection_(nullptr),
+        ownsWriter_(false),
+        ownsReader_(false),
+        previous_(innermost_) {
+    const ConnectionScope* enclosing = previous_;
+    while (enclosing != nullptr && &enclosing->repo_ != &repo) {
+      enclosing = enclosing->previous_;
+    }
+
+    if (enclosing != nullptr &&
+        (mode != kWrite || enclosing->connection_ == repo.writer_.get())) {
+      connection_ = enclosing->connection_;
+    } else if (mode == kSnapshot && !repo.readerPath_.empty()) {
+      snapshot_ = repo.openSnapshot();
+      connection_ = snapshot_.get();
+    } else if (mode == kRead && !repo.readerPath_.empty()) {
+      connection_ = repo.acquireReader();
+      ownsReader_ = true;
+    } else {
+      repo.writerMutex_.lock();
+      connection_ = repo.writer_.get();
+      ownsWriter_ = true;
+    }
+    innermost_ = this;
+  }
+
+  ~ConnectionScope() {
+    innermost_ = previous_;
+    // A snapshot connection closes with the scope, ending its transaction.
+    if (ownsReader_) {
+      repo_.releaseReader(connection_);
+    } else if (ownsWriter_) {
+      repo_.writerMutex_.unlock();
+    }
+  }
+
+  ConnectionScope(const ConnectionScope&) = delete;
+  ConnectionScope& operator=(const ConnectionScope&) = delete;
+
+  static Connection* current(const SQLiteIssueRepository& repo) {
+    for (const ConnectionScope* scope = innermost_; scope != nullptr;
+         scope = scope->previous_) {
+      if (&scope->repo_ == &repo) {
+        return scope->connection_;
+      }
+    }
+    return nullptr;
+  }
+
+ private:
+  const SQLiteIssueRepository& repo_;
+  Connection* connection_;
+  bool ownsWriter_;
+  bool ownsReader_;
+  std::unique_ptr<Connection> snapshot_;
+  const ConnectionScope* previous_;
+
+  static thread_local const ConnectionScope* innermost_;
+};
+
+thread_local const SQLiteIssueRepository::ConnectionScope*
+    SQLiteIssueRepository::ConnectionScope::innermost_ = nullptr;
+
 SQLiteIssueRepository::SQLiteIssueRepository(
-  const std::string& dbPath)
-    : db_(nullptr) {
-  if (sqlite3_open(dbPath.c_str(), &db_) != SQLITE_OK) {
-    throw std::runtime_error("Failed to open SQLite database: " + dbPath);
+  const std::string& dbPath, std::size_t maxReaders,
+  const StorageProfile& profile, bool countStatements)
+    : maxReaders_(maxReaders),
+      profile_(profile),
+      countStatements_(countStatements),
+      executedStatements_(0) {
+  writer_ = openConnection(
+      dbPath, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE |
+                  SQLITE_OPEN_URI | SQLITE_OPEN_NOMUTEX);
+
+  // Temporary and in-memory databases report an empty file name and
+  // cannot be opened a second time, so they get no reader pool.
+  const char* fileName = sqlite3_db_filename(writer_->db, "main");
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
+  if (fileName != nullptr && *fileName != '\0' && maxReaders_ > 0) {
+    execOrThrow("PRAGMA journal_mode = WAL;");
+    if (journalMode() == "wal") {
+      readerPath_ = fileName;
+    }
   }
   execOrThrow("PRAGMA foreign_keys = ON;");
   initializeSchema();
 }
 
 SQLiteIssueRepository::~SQLiteIssueRepository() {
-  if (db_ != nullptr) {
-    sqlite3_close(db_);
-    db_ = nullptr;
+  // Readers first so the writer's close can checkpoint and drop the WAL.
+  idleReaders_.clear();
+  readers_.clear();
+  writer_.reset();
+}
+
+std::size_t SQLiteIssueRepository::defaultReaderPoolSize() {
+  const std::size_t cores = std::thread::hardware_concurrency();
+  return std::min<std::size_t>(std::max<std::size_t>(cores, 2), 16);
+}
+
+std::unique_ptr<SQLiteIssueRepository::Connection>
+SQLiteIssueRepository::openConnection(const std::string& path,
+                                      int flags) const {
+  sqlite3* db = nullptr;
+  if (sqlite3_open_v2(path.c_str(), &db, flags, nullptr) != SQLITE_OK) {
+    sqlite3_close_v2(db);
+    throw std::runtime_error("Failed to open SQLite database: " + path);
+  }
+  auto connection = std::make_unique<Connection>(db);
+  sqlite3_busy_timeout(db, profile_.busyTimeoutMs);
+  // Applied before tracing starts, so opening a connection does not show
+  // in executedStatementCount. The keywords were validated by
+  // StorageProfile::set.
+  const std::string pragmas =
+      "PRAGMA mmap_size = " + std::to_string(profile_.mmapSize) +
+      "; PRAGMA cache_size = " + std::to_string(profile_.cacheSize) +
+      "; PRAGMA synchronous = " + profile_.synchronous +
+      "; PRAGMA temp_store = " + profile_.tempStore + ";";
+  if (sqlite3_exec(db, pragmas.c_str(), nullptr, nullptr, nullptr) !=
+      SQLITE_OK) {
+    throw std::runtime_error(std::string("Failed to apply storage profile: ") +
+                             sqlite3_errmsg(db));
+  }
+  if (countStatements_) {
+    sqlite3_trace_v2(
+        db, SQLITE_TRACE_STMT, &countExecutedStatement,
+        const_cast<std::atomic<std::size_t>*>(&executedStatements_));
+  }
+  return connection;
+}
+
+SQLiteIssueRepository::Connection*
+SQLiteIssueRepository::acquireReader() const {
+  Connection* reader = nullptr;
+  {
+    std::unique_lock<std::mutex> lock(readersMutex_);
+    if (!readerReleased_.wait_for(
+            lock, std::chrono::milliseconds(profile_.busyTimeoutMs), [this] {
+              return !idleReaders_.empty() || readers_.size() < maxReaders_;
+            })) {
+      throw std::runtime_error("Timed out waiting for a reader connection");
+    }
+    if (!idleReaders_.empty()) {
+      reader = idleReaders_.back();
+      idleReaders_.pop_back();
+    } else {
+      readers_.push_back(openConnection(
+          readerPath_, SQLITE_OPEN_READONLY | SQLITE_OPEN_URI |
+                           SQLITE_OPEN_NOMUTEX));
+      reader = readers_.back().get();
+    }
+  }
+
+  // Pin one snapshot so multi-statement loads stay consistent.
+  auto begin = reader->statements.acquire("BEGIN;");
+  if (sqlite3_step(begin.get()) != SQLITE_DONE) {
+    std::string message = sqlite3_errmsg(reader->db);
+    releaseReader(reader);
+    throw std::runtime_error(message);
+  }
+  return reader;
+}
+
+std::unique_ptr<SQLiteIssueRepository::Connection>
+SQLiteIssueRepository::openSnapshot() const {
+  std::unique_ptr<Connection> snapshot = openConnection(
+      readerPath_,
+      SQLITE_OPEN_READONLY | SQLITE_OPEN_URI | SQLITE_OPEN_NOMUTEX);
+  auto begin = snapshot->statements.acquire("BEGIN;");
+  if (sqlite3_step(begin.get()) != SQLITE_DONE) {
+    throw std::runtime_error(sqlite3_errmsg(snapshot->db));
+  }
+  return snapshot;
+}
+
+void SQLiteIssueRepository::releaseReader(Connection* reader) const {
+  if (!sqlite3_get_autocommit(reader->db)) {
+    auto commit = reader->statements.acquire("COMMIT;");
+    sqlite3_step(commit.get());
+  }
+  {
+    std::lock_guard<std::mutex> lock(readersMutex_);
+    idleReaders_.push_back(reader);
+  }
+  readerReleased_.notify_one();
+}
+
+SQLiteIssueRepository::Connection& SQLiteIssueRepository::connection() const {
+  Connection* current = ConnectionScope::current(*this);
+  if (current == nullptr) {
+    throw std::logic_error("SQLiteIssueRepository: no connection scope");
+  }
+  return *current;
+}
+
+std::size_t SQLiteIssueRepository::executedStatementCount() const {
+  return executedStatements_.load();
+}
+
+SqliteStatementCache::Stats
+SQLiteIssueRepository::statementCacheStats() const {
+  SqliteStatementCache::Stats total = writer_->statements.stats();
+  std::lock_guard<std::mutex> lock(readersMutex_);
+  for (const auto& reader : readers_) {
+    SqliteStatementCache::Stats stats = reader->statements.stats();
+    total.hits += stats.hits;
+    total.misses += stats.misses;
+    total.size += stats.size;
+  }
+  return total;
+}
+
+std::string SQLiteIssueRepository::journalMode() const {
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
+  std::string mode;
+  forEachRow("PRAGMA journal_mode;", nullptr,
+             [&](sqlite3_stmt* stmt) { mode = columnText(stmt, 0); });
+  return mode;
+}
+
+bool SQLiteIssueRepository::backupTo(const std::string& targetPath,
+                                     int pagesPerStep,
+                                     const BackupObserver& onStep) const {
+  ConnectionScope scope(*this, ConnectionScope::kSnapshot);
+  // Reading starts the snapshot's transaction, which sqlite3_backup_step
+  // then reuses for every step instead of opening one per step and
+  // restarting whenever the writer commits in between.
+  exists("SELECT 1 FROM sqlite_master;");
+
+  std::unique_ptr<Connection> target = openConnection(
+      targetPath, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE |
+                      SQLITE_OPEN_NOMUTEX);
+  sqlite3_backup* backup =
+      sqlite3_backup_init(target->db, "main", connection().db, "main");
+  if (backup == nullptr) {
+    throw std::runtime_error(std::string("Failed to start backup: ") +
+                             sqlite3_errmsg(target->db));
+  }
+
+  // A locked step is retried until the target has stayed locked for the
+  // profile's busy timeout; onStep still runs so the caller can give up
+  // sooner.
+  using Clock = std::chrono::steady_clock;
+  const auto budget = std::chrono::milliseconds(profile_.busyTimeoutMs);
+  auto lastProgress = Clock::now();
+  int rc = SQLITE_OK;
+  bool abandoned = false;
+  while (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED) {
+    rc = sqlite3_backup_step(backup, pagesPerStep);
+    const bool locked = rc == SQLITE_BUSY || rc == SQLITE_LOCKED;
+    if (!locked && rc != SQLITE_OK && rc != SQLITE_DONE) {
+      break;
+    }
+    if (onStep && !onStep(sqlite3_backup_pagecount(backup) -
+                              sqlite3_backup_remaining(backup),
+                          sqlite3_backup_pagecount(backup))) {
+      abandoned = true;
+      break;
+    }
+    if (!locked) {
+      lastProgress = Clock::now();
+    } else if (Clock::now() - lastProgress >= budget) {
+      break;
+    } else {
+      sqlite3_sleep(1);
+    }
+  }
+  sqlite3_backup_finish(backup);
+  if (!abandoned && rc != SQLITE_DONE) {
+    throw std::runtime_error(std::string("Backup failed: ") +
+                             sqlite3_errstr(rc));
   }
+  return !abandoned;
+}
+
+void SQLiteIssueRepository::warmUp() const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  const IssueQuery everything;
+  const IssuePageRequest firstPage;
+  findIssuePage(everything, firstPage);
+  findIssueSummaryPage(everything, firstPage);
+  countIssues(everything);
+  listAllUsers();
+  listAllTags();
+  listAllMilestones();
+}
+
+StorageProfile SQLiteIssueRepository::storageSettings() const {
+  static const char* const kSynchronous[] = {"OFF", "NORMAL", "FULL",
+                                             "EXTRA"};
+  static const char* const kTempStore[] = {"DEFAULT", "FILE", "MEMORY"};
+  auto pragma = [this](const std::string& name) {
+    std::int64_t value = 0;
+    forEachRow("PRAGMA " + name + ";", nullptr, [&](sqlite3_stmt* stmt) {
+      value = sqlite3_column_int64(stmt, 0);
+    });
+    return value;
+  };
+
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
+  StorageProfile settings;
+  settings.name = profile_.name;
+  settings.mmapSize = pragma("mmap_size");
+  settings.cacheSize = pragma("cache_size");
+  settings.synchronous = kSynchronous[std::clamp<std::int64_t>(
+      pragma("synchronous"), 0, 3)];
+  settings.tempStore = kTempStore[std::clamp<std::int64_t>(
+      pragma("temp_store"), 0, 2)];
+  settings.busyTimeoutMs = static_cast<int>(pragma("busy_timeout"));
+  settings.writeBatch = profile_.writeBatch;
+  settings.writeBatchDelayUs = profile_.writeBatchDelayUs;
+  return settings;
+}
+
+std::size_t SQLiteIssueRepository::readerConnectionCount() const {
+  std::lock_guard<std::mutex> lock(readersMutex_);
+  return readers_.size();
+}
+
+SqliteStatementCache::Lease SQLiteIssueRepository::prepare(
+    const std::string& sql) const {
+  return connection().statements.acquire(sql);
 }
 
 void SQLiteIssueRepository::execOrThrow(const std::string& sql) const {
   char* errMsg = nullptr;
-  if (sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &errMsg)
+  if (sqlite3_exec(connection().db, sql.c_str(), nullptr, nullptr, &errMsg)
       != SQLITE_OK) {
     std::string message = errMsg ? errMsg : "Unknown SQLite error";
     sqlite3_free(errMsg);
@@ -103,9 +663,60 @@ void SQLiteIssueRepository::execOrThrow(const std::string& sql) const {
   }
 }
 
+namespace {
+using MigrationStep = void (SQLiteIssueRepository::*)();
+constexpr int kSchemaVersion = 7;
+}  // namespace
+
 void SQLiteIssueRepository::initializeSchema() {
-  // Base schema. For a brand-new DB this will create the issues table
-  // including the status column. For an existing DB, this has no effect.
+  // Append new steps; never reorder or edit a shipped one.
+  static const MigrationStep kSteps[] = {
+      &SQLiteIssueRepository::createBaseSchema,
+      &SQLiteIssueRepository::addLegacyColumns,
+      &SQLiteIssueRepository::createSecondaryIndexes,
+      &SQLiteIssueRepository::createSearchIndex,
+      &SQLiteIssueRepository::createStatsIndexes,
+      &SQLiteIssueRepository::createMilestoneScheduleIndexes,
+      &SQLiteIssueRepository::addCommentSequence};
+  static_assert(sizeof(kSteps) / sizeof(kSteps[0]) == kSchemaVersion,
+                "kSchemaVersion must count the migration steps");
+
+  for (int version = schemaVersion(); version < latestSchemaVersion();
+       ++version) {
+    SqliteTxn txn(connection().db, connection().statements);
+    (this->*kSteps[version])();
+    execOrThrow("PRAGMA user_version = " + std::to_string(version + 1) +
+                ";");
+    txn.commit();
+  }
+}
+
+int SQLiteIssueRepository::latestSchemaVersion() {
+  return kSchemaVersion;
+}
+
+int SQLiteIssueRepository::schemaVersion() const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  int version = 0;
+  forEachRow("PRAGMA user_version;", nullptr, [&](sqlite3_stmt* stmt) {
+    version = sqlite3_column_int(stmt, 0);
+  });
+  return version;
+}
+
+bool SQLiteIssueRepository::hasColumn(const std::string& table,
+                                      const std::string& column) const {
+  return exists(
+      "SELECT 1 FROM pragma_table_info(?) WHERE name = ?;",
+      [&](sqlite3_stmt* stmt) {
+        sqlite3_bind_text(stmt, 1, table.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, column.c_str(), -1, SQLITE_TRANSIENT);
+      });
+}
+
+// Step 1. Databases that predate versioning still report version 0 and
+// rerun it, so every statement must tolerate existing objects.
+void SQLiteIssueRepository::createBaseSchema() {
   const char* statements[] = {
       "CREATE TABLE IF NOT EXISTS issues ("
       "id INTEGER PRIMARY KEY AUTOINCREMENT,"
@@ -113,7 +724,8 @@ void SQLiteIssueRepository::initializeSchema() {
       "title TEXT NOT NULL,"
       "description_comment_id INTEGER NOT NULL DEFAULT -1,"
       "assigned_to TEXT,"
-      "created_at INTEGER DEFAULT 0);",
+      "created_at INTEGER DEFAULT 0,"
+      "status TEXT NOT NULL DEFAULT 'To Be Done');",
 
       "CREATE TABLE IF NOT EXISTS comments ("
       "id INTEGER NOT NULL,"
@@ -153,54 +765,140 @@ void SQLiteIssueRepository::initializeSchema() {
       "FOREIGN KEY(milestone_id) REFERENCES milestones(id) ON DELETE CASCADE,"
       "FOREIGN KEY(issue_id) REFERENCES issues(id) ON DELETE CASCADE);",
 
-      "CREATE INDEX IF NOT EXISTS idx_comments_issue ON comments(issue_id);"};
+      "CREATE INDEX IF NOT EXISTS idx_comments_issue ON comments(issue_id);",
+      "CREATE INDEX IF NOT EXISTS idx_issues_created "
+      "ON issues(created_at, id);"};
 
   for (const char* sql : statements) {
     execOrThrow(sql);
   }
+}
 
-  // Migration for older DBs that were created BEFORE the status column
-  // existed. Older schema had no 'status' column, so we add it here.
-  try {
+// Step 2. Columns that older unversioned databases were created without.
+void SQLiteIssueRepository::addLegacyColumns() {
+  if (!hasColumn("issues", "status")) {
     execOrThrow(
         "ALTER TABLE issues "
         "ADD COLUMN status TEXT NOT NULL "
         "DEFAULT 'To Be Done';");
-  } catch (const std::runtime_error& e) {
-    const std::string msg = e.what();
-    // If the column already exists, SQLite will say something like
-    // "duplicate column name: status". That is safe to ignore.
-    if (msg.find("duplicate column name") == std::string::npos) {
-      throw;
-    }
+  }
+  if (!hasColumn("issue_tags", "color")) {
+    execOrThrow("ALTER TABLE issue_tags ADD COLUMN color TEXT;");
   }
 
-  // Migration for issue_tags color column so tags can store a color value.
-  try {
-    execOrThrow(
-        "ALTER TABLE issue_tags "
-        "ADD COLUMN color TEXT;");
-  } catch (const std::runtime_error& e) {
-    const std::string msg = e.what();
-    if (msg.find("duplicate column name") == std::string::npos) {
-      throw;
-    }
+  // Tag definitions used to live only on issue_tags.
+  execOrThrow(
+      "INSERT OR IGNORE INTO tags (tag, color) "
+      "SELECT DISTINCT tag, COALESCE(color, '') FROM issue_tags;");
+}
+
+// Step 3. Indexes behind the IssueQuery filters, so they seek instead of
+// scanning issues. author_id is indexed both ways because IssueQuery
+// compares it without case and the per-user lookup with case.
+void SQLiteIssueRepository::createSecondaryIndexes() {
+  const std::string statements[] = {
+      std::string("CREATE INDEX IF NOT EXISTS idx_issues_status_key "
+                  "ON issues(") +
+          kStatusKeySql + ");",
+      "CREATE INDEX IF NOT EXISTS idx_issues_assigned "
+      "ON issues(assigned_to);",
+      "CREATE INDEX IF NOT EXISTS idx_issues_author ON issues(author_id);",
+      "CREATE INDEX IF NOT EXISTS idx_issues_author_nocase "
+      "ON issues(author_id COLLATE NOCASE);",
+      "CREATE INDEX IF NOT EXISTS idx_milestone_issues_issue "
+      "ON milestone_issues(issue_id);",
+      "CREATE INDEX IF NOT EXISTS idx_issue_tags_tag ON issue_tags(tag);"};
+
+  for (const std::string& sql : statements) {
+    execOrThrow(sql);
   }
+}
 
-  // Backfill tags table from existing issue tags (idempotent).
-  try {
-    execOrThrow(
-        "INSERT OR IGNORE INTO tags (tag, color) "
-        "SELECT DISTINCT tag, COALESCE(color, '') FROM issue_tags;");
-  } catch (const std::runtime_error&) {
-    // ignore if issue_tags does not exist yet
+// Step 4. FTS5 indexes over titles and comment texts. A title row's rowid
+// is the issue id; a comment row's is kCommentKeySql, because comments
+// have no rowid that survives VACUUM.
+void SQLiteIssueRepository::createSearchIndex() {
+  const std::string statements[] = {
+      "CREATE VIRTUAL TABLE IF NOT EXISTS issue_title_fts "
+      "USING fts5(title, tokenize = 'unicode61 remove_diacritics 2');",
+      "CREATE VIRTUAL TABLE IF NOT EXISTS comment_fts "
+      "USING fts5(text, tokenize = 'unicode61 remove_diacritics 2');",
+
+      "INSERT INTO issue_title_fts (rowid, title) "
+      "SELECT id, title FROM issues;",
+      std::string("INSERT INTO comment_fts (rowid, text) SELECT ") +
+          commentKeySql("") + ", text FROM comments;",
+
+      "CREATE TRIGGER IF NOT EXISTS issues_fts_insert AFTER INSERT ON issues "
+      "BEGIN INSERT INTO issue_title_fts (rowid, title) "
+      "VALUES (new.id, new.title); END;",
+      "CREATE TRIGGER IF NOT EXISTS issues_fts_update "
+      "AFTER UPDATE OF title ON issues WHEN old.title IS NOT new.title "
+      "BEGIN UPDATE issue_title_fts SET title = new.title "
+      "WHERE rowid = new.id; END;",
+      "CREATE TRIGGER IF NOT EXISTS issues_fts_delete AFTER DELETE ON issues "
+      "BEGIN DELETE FROM issue_title_fts WHERE rowid = old.id; END;",
+
+      "CREATE TRIGGER IF NOT EXISTS comments_fts_insert "
+      "AFTER INSERT ON comments BEGIN "
+      "INSERT INTO comment_fts (rowid, text) VALUES (" +
+          commentKeySql("new.") + ", new.text); END;",
+      "CREATE TRIGGER IF NOT EXISTS comments_fts_update "
+      "AFTER UPDATE OF text ON comments WHEN old.text IS NOT new.text BEGIN "
+      "UPDATE comment_fts SET text = new.text WHERE rowid = " +
+          commentKeySql("new.") + "; END;",
+      "CREATE TRIGGER IF NOT EXISTS comments_fts_delete "
+      "AFTER DELETE ON comments BEGIN "
+      "DELETE FROM comment_fts WHERE rowid = " + commentKeySql("old.") +
+          "; END;"};
+
+  for (const std::string& sql : statements) {
+    execOrThrow(sql);
   }
 }
 
+// Step 5. Lets the unfiltered status breakdown of countIssues read a
+// covering index in order; assigned_to and issue_tags(tag) already have
+// one from step 3.
+void SQLiteIssueRepository::createStatsIndexes() {
+  execOrThrow(
+      "CREATE INDEX IF NOT EXISTS idx_issues_status ON issues(status);");
+}
+
+// Step 6. Date range lookups bound start_date from above and end_date
+// from below; the start index also yields the listing order.
+void SQLiteIssueRepository::createMilestoneScheduleIndexes() {
+  execOrThrow(
+      "CREATE INDEX IF NOT EXISTS idx_milestones_start "
+      "ON milestones(start_date);");
+  execOrThrow(
+      "CREATE INDEX IF NOT EXISTS idx_milestones_end "
+      "ON milestones(end_date);");
+}
+
+// Step 7. Per-issue comment id counter. The trigger keeps it past every
+// inserted id, including explicit ones such as the description's 0, so
+// appendCommentRow can take the next id in the INSERT itself.
+void SQLiteIssueRepository::addCommentSequence() {
+  if (!hasColumn("issues", "next_comment_id")) {
+    execOrThrow(
+        "ALTER TABLE issues "
+        "ADD COLUMN next_comment_id INTEGER NOT NULL DEFAULT 0;");
+  }
+  execOrThrow(
+      "UPDATE issues SET next_comment_id = COALESCE("
+      "(SELECT MAX(id) + 1 FROM comments WHERE issue_id = issues.id), 0);");
+  execOrThrow(
+      "CREATE TRIGGER IF NOT EXISTS comments_next_id "
+      "AFTER INSERT ON comments BEGIN "
+      "UPDATE issues SET next_comment_id = new.id + 1 "
+      "WHERE id = new.issue_id AND next_comment_id <= new.id; END;");
+}
+
 bool SQLiteIssueRepository::exists(
     const std::string& sql,
     const std::function<void(sqlite3_stmt*)>& binder) const {
-  SqliteStmt stmt(db_, sql);
+  auto stmt = prepare(sql);
   if (binder) {
     binder(stmt.get());
   }
@@ -218,7 +916,7 @@ void SQLiteIssueRepository::forEachRow(
     const std::string& sql,
     const std::function<void(sqlite3_stmt*)>& binder,
     const std::function<void(sqlite3_stmt*)>& onRow) const {
-  SqliteStmt stmt(db_, sql);
+  auto stmt = prepare(sql);
   if (binder) {
     binder(stmt.get());
   }
@@ -242,8 +940,7 @@ Comment SQLiteIssueRepository::insertCommentRow(int issueId,
   if (stored.getTimeStamp() == 0) {
     stored.setTimeStamp(currentTimeMillis());
   }
-  SqliteStmt stmt(
-      db_,
+  auto stmt = prepare(
       "INSERT INTO comments (id, issue_id, author_id, text, timestamp) "
       "VALUES (?, ?, ?, ?, ?);");
   sqlite3_bind_int(stmt.get(), 1, commentId);
@@ -264,6 +961,39 @@ Comment SQLiteIssueRepository::insertCommentRow(int issueId,
   return stored;
 }
 
+Comment SQLiteIssueRepository::appendCommentRow(int issueId,
+                                                const Comment& comment) {
+  Comment stored = comment;
+  if (stored.getTimeStamp() == 0) {
+    stored.setTimeStamp(currentTimeMillis());
+  }
+  // Reading the counter inside the INSERT makes allocation and insert
+  // one atomic statement; a missing issue inserts nothing.
+  auto stmt = prepare(
+      "INSERT INTO comments (id, issue_id, author_id, text, timestamp) "
+      "SELECT next_comment_id, id, ?, ?, ? FROM issues WHERE id = ? "
+      "RETURNING id;");
+  sqlite3_bind_text(stmt.get(), 1, stored.getAuthor().c_str(), -1,
+                    SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt.get(), 2, stored.getText().c_str(), -1,
+                    SQLITE_TRANSIENT);
+  sqlite3_bind_int64(stmt.get(), 3, stored.getTimeStamp());
+  sqlite3_bind_int(stmt.get(), 4, issueId);
+
+  const int rc = sqlite3_step(stmt.get());
+  if (rc == SQLITE_DONE) {
+    throw std::invalid_argument("Issue with given ID does not exist");
+  }
+  if (rc != SQLITE_ROW) {
+    throw std::runtime_error("Failed to insert comment");
+  }
+  stored.setIdForPersistence(sqlite3_column_int(stmt.get(), 0));
+  if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+    throw std::runtime_error("Failed to insert comment");
+  }
+  return stored;
+}
+
 bool SQLiteIssueRepository::issueExists(int issueId) const {
   return exists(
       "SELECT 1 FROM issues WHERE id = ? LIMIT 1;",
@@ -283,32 +1013,71 @@ bool SQLiteIssueRepository::commentExists(int issueId,
 }
 
 namespace {
-void upsertTagDefinition(sqlite3* db, const Tag& tag) {
-  SqliteStmt stmt(
-      db,
+// Returns the definition's color after the upsert, which is what an issue
+// tag without a color of its own displays.
+std::string upsertTagDefinition(SqliteStatementCache& statements,
+                                const Tag& tag) {
+  auto stmt = statements.acquire(
       "INSERT INTO tags (tag, color) VALUES (?, ?) "
       "ON CONFLICT(tag) DO UPDATE SET "
-      "color = COALESCE(NULLIF(excluded.color, ''), color);");
+      "color = COALESCE(NULLIF(excluded.color, ''), color) "
+      "RETURNING color;");
   sqlite3_bind_text(stmt.get(), 1, tag.getName().c_str(), -1,
                     SQLITE_TRANSIENT);
   sqlite3_bind_text(stmt.get(), 2, tag.getColor().c_str(), -1,
                     SQLITE_TRANSIENT);
-  sqlite3_step(stmt.get());
+  if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+    throw std::runtime_error("Failed to save tag definition");
+  }
+  return columnText(stmt.get(), 0);
 }
-}  // namespace
 
-int SQLiteIssueRepository::nextCommentIdForIssue(int issueId) const {
-  SqliteStmt stmt(
-      db_,
-      "SELECT COALESCE(MAX(id), -1) FROM comments WHERE issue_id = ?;");
-  sqlite3_bind_int(stmt.get(), 1, issueId);
-  if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
-    throw std::runtime_error("Failed to compute next comment id");
+// Column order shared by every issue read: id, author_id, title,
+// description_comment_id, assigned_to, status, created_at.
+constexpr const char* kIssueColumnsSql =
+    "id, author_id, title, description_comment_id, assigned_to, status, "
+    "created_at";
+
+Issue issueFromRow(sqlite3_stmt* stmt) {
+  Issue issue(
+      sqlite3_column_int(stmt, 0),
+      columnText(stmt, 1),
+      columnText(stmt, 2),
+      sqlite3_column_int64(stmt, 6));
+
+  const std::string assigned = columnText(stmt, 4);
+  const std::string status = columnText(stmt, 5);
+  if (!assigned.empty()) {
+    issue.assignTo(assigned);
+  }
+  if (!status.empty()) {
+    issue.setStatus(status);
   }
-  int maxId = sqlite3_column_int(stmt.get(), 0);
-  return maxId + 1;
+  return issue;
+}
+
+// Reads id, author_id, text, timestamp starting at column first.
+Comment commentFromRow(sqlite3_stmt* stmt, int first) {
+  return Comment(
+      sqlite3_column_int(stmt, first),
+      columnText(stmt, first + 1),
+      columnText(stmt, first + 2),
+      sqlite3_column_int64(stmt, first + 3));
 }
 
+// Steps stmt once; false when it is exhausted.
+bool stepRow(sqlite3_stmt* stmt) {
+  const int rc = sqlite3_step(stmt);
+  if (rc == SQLITE_ROW) {
+    return true;
+  }
+  if (rc == SQLITE_DONE) {
+    return false;
+  }
+  throw std::runtime_error("Failed to read rows");
+}
+}  // namespace
+
 std::vector<Comment> SQLiteIssueRepository::loadComments(
     int issueId) const {
   std::vector<Comment> comments;
@@ -319,220 +1088,563 @@ std::vector<Comment> SQLiteIssueRepository::loadComments(
         sqlite3_bind_int(stmt, 1, issueId);
       },
       [&comments](sqlite3_stmt* stmt) {
-        comments.emplace_back(
-            sqlite3_column_int(stmt, 0),
-            columnText(stmt, 1),
-            columnText(stmt, 2),
-            sqlite3_column_int64(stmt, 3));
+        comments.push_back(commentFromRow(stmt, 0));
       });
   return comments;
 }
 
-Issue SQLiteIssueRepository::getIssue(int issueId) const {
-  SqliteStmt stmt(
-      db_,
-      "SELECT id, author_id, title, description_comment_id, assigned_to, "
-      "status, created_at "
-      "FROM issues WHERE id = ? LIMIT 1;");
-  sqlite3_bind_int(stmt.get(), 1, issueId);
-
-  if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
-    throw std::invalid_argument("Issue with given ID does not exist");
-  }
-
-  Issue issue(
-      sqlite3_column_int(stmt.get(), 0),
-      columnText(stmt.get(), 1),
-      columnText(stmt.get(), 2),
-      sqlite3_column_int64(stmt.get(), 6));
+std::vector<Issue> SQLiteIssueRepository::hydrateIssues(
+    const std::string& filterSql,
+    const std::function<void(sqlite3_stmt*)>& binder,
+    const std::string& selectionSql,
+    bool deferComments) const {
+  // Three set-based reads (issues, comments, tags; two when comments are
+  // deferred) regardless of how many rows match; the aggregates are
+  // stitched together in memory by id.
+  std::vector<Issue> issues;
+  std::vector<int> descriptionIds;
+  std::unordered_map<int, std::size_t> indexById;
 
-  const int descriptionId = sqlite3_column_int(stmt.get(), 3);
-  const std::string assigned = columnText(stmt.get(), 4);
-  const std::string status = columnText(stmt.get(), 5);
+  forEachRow(
+      std::string("SELECT ") + kIssueColumnsSql + " FROM issues " +
+          filterSql + " " +
+          (selectionSql.empty() ? std::string("ORDER BY id ASC")
+                                : selectionSql) +
+          ";",
+      binder,
+      [&](sqlite3_stmt* stmt) {
+        Issue issue = issueFromRow(stmt);
+        indexById.emplace(issue.getId(), issues.size());
+        descriptionIds.push_back(sqlite3_column_int(stmt, 3));
+        issues.push_back(std::move(issue));
+      });
 
-  if (!assigned.empty()) {
-    issue.assignTo(assigned);
-  }
-  if (!status.empty()) {
-    issue.setStatus(status);
+  if (issues.empty()) {
+    return issues;
   }
 
-  for (const auto& comment : loadComments(issueId)) {
-    issue.addComment(comment);
-  }
+  const std::string matchingIds =
+      filterSql.empty() && selectionSql.empty()
+          ? std::string()
+          : " IN (SELECT id FROM issues " + filterSql + " " + selectionSql +
+                ")";
 
-  if (descriptionId >= 0
-      && issue.findCommentById(descriptionId) != nullptr) {
-    issue.setDescriptionCommentId(descriptionId);
+  if (deferComments) {
+    for (std::size_t i = 0; i < issues.size(); ++i) {
+      const int issueId = issues[i].getId();
+      issues[i].deferComments(descriptionIds[i], [this, issueId] {
+        ConnectionScope scope(*this, ConnectionScope::kRead);
+        return loadComments(issueId);
+      });
+    }
+  } else {
+    forEachRow(
+        "SELECT issue_id, id, author_id, text, timestamp FROM comments" +
+            (matchingIds.empty() ? std::string()
+                                 : " WHERE issue_id" + matchingIds) +
+            " ORDER BY issue_id ASC, id ASC;",
+        binder,
+        [&](sqlite3_stmt* stmt) {
+          auto it = indexById.find(sqlite3_column_int(stmt, 0));
+          if (it == indexById.end()) {
+            return;
+          }
+          issues[it->second].addComment(commentFromRow(stmt, 1));
+        });
+
+    for (std::size_t i = 0; i < issues.size(); ++i) {
+      const int descriptionId = descriptionIds[i];
+      if (descriptionId >= 0
+          && issues[i].findCommentById(descriptionId) != nullptr) {
+        issues[i].setDescriptionCommentId(descriptionId);
+      }
+    }
   }
 
   forEachRow(
-      "SELECT it.tag, COALESCE(NULLIF(it.color, ''), t.color) "
+      "SELECT it.issue_id, it.tag, COALESCE(NULLIF(it.color, ''), t.color) "
       "FROM issue_tags it "
-      "LEFT JOIN tags t ON t.tag = it.tag "
-      "WHERE it.issue_id = ?;",
-      [issueId](sqlite3_stmt* stmt) { sqlite3_bind_int(stmt, 1, issueId); },
-      [&issue](sqlite3_stmt* stmt) {
-        std::string tag = columnText(stmt, 0);
-        std::string color = columnText(stmt, 1);
-        if (!tag.empty()) {
-          issue.addTag(Tag(tag, color));
+      "LEFT JOIN tags t ON t.tag = it.tag" +
+          (matchingIds.empty() ? std::string()
+                               : " WHERE it.issue_id" + matchingIds) +
+          ";",
+      binder,
+      [&](sqlite3_stmt* stmt) {
+        auto it = indexById.find(sqlite3_column_int(stmt, 0));
+        std::string tag = columnText(stmt, 1);
+        if (it == indexById.end() || tag.empty()) {
+          return;
         }
+        issues[it->second].addTag(Tag(tag, columnText(stmt, 2)));
       });
-  return issue;
+
+  return issues;
 }
 
-Issue SQLiteIssueRepository::saveIssue(const Issue& issue) {
-  Issue stored = issue;
+struct SQLiteIssueRepository::IssueStream::State {
+  State(const SQLiteIssueRepository& repo, CompiledQuery query)
+      : scope(repo, ConnectionScope::kRead),
+        compiled(std::move(query)),
+        matchingIds(compiled.where.empty()
+                        ? std::string()
+                        : " IN (SELECT id FROM issues " + compiled.where +
+                              ")"),
+        issues(repo.prepare(std::string("SELECT ") + kIssueColumnsSql +
+                            " FROM issues " + compiled.where +
+                            " ORDER BY id ASC;")),
+        comments(repo.prepare(
+            "SELECT issue_id, id, author_id, text, timestamp FROM comments" +
+            (matchingIds.empty() ? std::string()
+                                 : " WHERE issue_id" + matchingIds) +
+            " ORDER BY issue_id ASC, id ASC;")),
+        tags(repo.prepare(
+            "SELECT it.issue_id, it.tag, "
+            "COALESCE(NULLIF(it.color, ''), t.color) "
+            "FROM issue_tags it "
+            "LEFT JOIN tags t ON t.tag = it.tag" +
+            (matchingIds.empty() ? std::string()
+                                 : " WHERE it.issue_id" + matchingIds) +
+            " ORDER BY it.issue_id ASC;")) {
+    compiled.bind(issues.get());
+    compiled.bind(comments.get());
+    compiled.bind(tags.get());
+    onComment = stepRow(comments.get());
+    onTag = stepRow(tags.get());
+  }
+
+  // Declared first so the statements are reset before the scope ends.
+  ConnectionScope scope;
+  CompiledQuery compiled;
+  std::string matchingIds;
+  SqliteStatementCache::Lease issues;
+  SqliteStatementCache::Lease comments;
+  SqliteStatementCache::Lease tags;
+  // Whether comments/tags sit on a row not yet attached to an issue.
+  bool onComment = false;
+  bool onTag = false;
+};
 
-  // ---- INSERT NEW ISSUE ----
-  if (!stored.hasPersistentId()) {
-    if (stored.getTimestamp() == 0) {
-      stored.setTimestamp(currentTimeMillis());
-    }
+SQLiteIssueRepository::IssueStream::IssueStream(std::unique_ptr<State> state)
+    : state_(std::move(state)) {}
 
-    SqliteStmt insertStmt(
-        db_,
-        "INSERT INTO issues (author_id, title, description_comment_id, "
-        "assigned_to, status, created_at) "
-        "VALUES (?, ?, ?, ?, ?, ?);");
+SQLiteIssueRepository::IssueStream::IssueStream(
+    IssueStream&& other) noexcept = default;
 
-    sqlite3_bind_text(insertStmt.get(), 1, stored.getAuthorId().c_str(), -1,
-                      SQLITE_TRANSIENT);
-    sqlite3_bind_text(insertStmt.get(), 2, stored.getTitle().c_str(), -1,
-                      SQLITE_TRANSIENT);
-    sqlite3_bind_int(insertStmt.get(), 3,
-                     stored.getDescriptionCommentId());
+SQLiteIssueRepository::IssueStream::~IssueStream() = default;
 
-    if (stored.hasAssignee()) {
-      sqlite3_bind_text(insertStmt.get(), 4,
-                        stored.getAssignedTo().c_str(), -1,
-                        SQLITE_TRANSIENT);
-    } else {
-      sqlite3_bind_null(insertStmt.get(), 4);
+bool SQLiteIssueRepository::IssueStream::next(Issue* out) {
+  if (!state_ || !stepRow(state_->issues.get())) {
+    return false;
+  }
+  sqlite3_stmt* row = state_->issues.get();
+  Issue issue = issueFromRow(row);
+  const int issueId = issue.getId();
+  const int descriptionId = sqlite3_column_int(row, 3);
+
+  // Child rows come in issue_id order, so each issue takes the run of
+  // rows at the front of each statement.
+  sqlite3_stmt* comments = state_->comments.get();
+  while (state_->onComment && sqlite3_column_int(comments, 0) <= issueId) {
+    if (sqlite3_column_int(comments, 0) == issueId) {
+      issue.addComment(commentFromRow(comments, 1));
     }
+    state_->onComment = stepRow(comments);
+  }
+  if (descriptionId >= 0 && issue.findCommentById(descriptionId) != nullptr) {
+    issue.setDescriptionCommentId(descriptionId);
+  }
 
-    sqlite3_bind_text(insertStmt.get(), 5,
-                      stored.getStatus().c_str(), -1,
-                      SQLITE_TRANSIENT);
-    sqlite3_bind_int64(insertStmt.get(), 6,
-                       stored.getTimestamp());
-
-    if (sqlite3_step(insertStmt.get()) != SQLITE_DONE) {
-      throw std::runtime_error("Failed to insert issue");
+  sqlite3_stmt* tags = state_->tags.get();
+  while (state_->onTag && sqlite3_column_int(tags, 0) <= issueId) {
+    const std::string tag = columnText(tags, 1);
+    if (sqlite3_column_int(tags, 0) == issueId && !tag.empty()) {
+      issue.addTag(Tag(tag, columnText(tags, 2)));
     }
+    state_->onTag = stepRow(tags);
+  }
 
-    int newId = static_cast<int>(sqlite3_last_insert_rowid(db_));
-    stored.setIdForPersistence(newId);
+  *out = std::move(issue);
+  return true;
+}
+
+void SQLiteIssueRepository::runInTransaction(
+    const std::function<void()>& work) {
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
+  SqliteTxn txn(connection().db, connection().statements);
+  work();
+  txn.commit();
+}
+
+SQLiteIssueRepository::IssueStream SQLiteIssueRepository::streamIssues(
+    const IssueQuery& query) const {
+  return IssueStream(std::make_unique<IssueStream::State>(
+      *this, compileQuery(query)));
+}
 
-    return getIssue(newId);
+struct SQLiteIssueRepository::CommentStream::State {
+  State(const SQLiteIssueRepository& repo, int issueId)
+      : scope(repo, ConnectionScope::kRead),
+        comments(repo.prepare(
+            "SELECT id, author_id, text, timestamp FROM comments "
+            "WHERE issue_id = ? ORDER BY id ASC;")) {
+    sqlite3_bind_int(comments.get(), 1, issueId);
   }
 
-  // ---- UPDATE EXISTING ISSUE ----
-  if (!issueExists(stored.getId())) {
-    throw std::invalid_argument(
-        "Issue with given ID does not exist: "
-        + std::to_string(stored.getId()));
+  ConnectionScope scope;
+  SqliteStatementCache::Lease comments;
+};
+
+SQLiteIssueRepository::CommentStream::CommentStream(
+    std::unique_ptr<State> state)
+    : state_(std::move(state)) {}
+
+SQLiteIssueRepository::CommentStream::CommentStream(
+    CommentStream&& other) noexcept = default;
+
+SQLiteIssueRepository::CommentStream::~CommentStream() = default;
+
+bool SQLiteIssueRepository::CommentStream::next(Comment* out) {
+  if (!state_ || !stepRow(state_->comments.get())) {
+    return false;
   }
+  *out = commentFromRow(state_->comments.get(), 0);
+  return true;
+}
+
+SQLiteIssueRepository::CommentStream SQLiteIssueRepository::streamComments(
+    int issueId) const {
+  auto state = std::make_unique<CommentStream::State>(*this, issueId);
+  if (!issueExists(issueId)) {
+    throw std::invalid_argument("Issue with given ID does not exist");
+  }
+  return CommentStream(std::move(state));
+}
 
+struct SQLiteIssueRepository::ExportSnapshot::State {
+  // The first read below starts the scope's read transaction, so users,
+  // milestones and every later issue pass see the same snapshot.
+  explicit State(const SQLiteIssueRepository& repository)
+      : scope(repository, ConnectionScope::kSnapshot),
+        repo(repository),
+        users(repository.listAllUsers()),
+        milestones(repository.listAllMilestones()) {}
+
+  ConnectionScope scope;
+  const SQLiteIssueRepository& repo;
+  std::vector<User> users;
+  std::vector<Milestone> milestones;
+};
+
+SQLiteIssueRepository::ExportSnapshot::ExportSnapshot(
+    std::unique_ptr<State> state)
+    : state_(std::move(state)) {}
+
+SQLiteIssueRepository::ExportSnapshot::ExportSnapshot(
+    ExportSnapshot&& other) noexcept = default;
+
+SQLiteIssueRepository::ExportSnapshot::~ExportSnapshot() = default;
+
+const std::vector<User>& SQLiteIssueRepository::ExportSnapshot::users()
+    const {
+  return state_->users;
+}
+
+const std::vector<Milestone>&
+SQLiteIssueRepository::ExportSnapshot::milestones() const {
+  return state_->milestones;
+}
+
+SQLiteIssueRepository::IssueStream
+SQLiteIssueRepository::ExportSnapshot::issues() const {
+  return state_->repo.streamIssues();
+}
+
+SQLiteIssueRepository::ExportSnapshot
+SQLiteIssueRepository::openExportSnapshot() const {
+  return ExportSnapshot(std::make_unique<ExportSnapshot::State>(*this));
+}
+
+Issue SQLiteIssueRepository::getIssue(int issueId) const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  std::vector<Issue> found = hydrateIssues(
+      "WHERE id = ?",
+      [issueId](sqlite3_stmt* stmt) { sqlite3_bind_int(stmt, 1, issueId); },
+      "", true);
+  if (found.empty()) {
+    throw std::invalid_argument("Issue with given ID does not exist");
+  }
+  return std::move(found.front());
+}
+
+Issue SQLiteIssueRepository::saveIssue(const Issue& issue) {
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
+  Issue stored = issue;
   if (stored.getTimestamp() == 0) {
     stored.setTimestamp(currentTimeMillis());
   }
 
-  {
-    SqliteStmt updateStmt(
-        db_,
-        "UPDATE issues SET author_id = ?, title = ?, "
-        "description_comment_id = ?, assigned_to = ?, "
-        "status = ?, created_at = ? WHERE id = ?;");
-
-    sqlite3_bind_text(updateStmt.get(), 1, stored.getAuthorId().c_str(), -1,
+  // Both statements return the row as written, so the result is built
+  // from it instead of being read back.
+  auto bindColumns = [&stored](sqlite3_stmt* stmt) {
+    sqlite3_bind_text(stmt, 1, stored.getAuthorId().c_str(), -1,
                       SQLITE_TRANSIENT);
-    sqlite3_bind_text(updateStmt.get(), 2, stored.getTitle().c_str(), -1,
+    sqlite3_bind_text(stmt, 2, stored.getTitle().c_str(), -1,
                       SQLITE_TRANSIENT);
-    sqlite3_bind_int(updateStmt.get(), 3,
-                     stored.getDescriptionCommentId());
-
+    sqlite3_bind_int(stmt, 3, stored.getDescriptionCommentId());
     if (stored.hasAssignee()) {
-      sqlite3_bind_text(updateStmt.get(), 4,
-                        stored.getAssignedTo().c_str(), -1,
+      sqlite3_bind_text(stmt, 4, stored.getAssignedTo().c_str(), -1,
                         SQLITE_TRANSIENT);
     } else {
-      sqlite3_bind_null(updateStmt.get(), 4);
+      sqlite3_bind_null(stmt, 4);
     }
-
-    sqlite3_bind_text(updateStmt.get(), 5,
-                      stored.getStatus().c_str(), -1,
+    sqlite3_bind_text(stmt, 5, stored.getStatus().c_str(), -1,
                       SQLITE_TRANSIENT);
-    sqlite3_bind_int64(updateStmt.get(), 6,
-                       stored.getTimestamp());
+    sqlite3_bind_int64(stmt, 6, stored.getTimestamp());
+  };
+
+  // ---- INSERT NEW ISSUE ----
+  if (!stored.hasPersistentId()) {
+    auto insertStmt = prepare(
+        std::string("INSERT INTO issues (author_id, title, "
+                    "description_comment_id, assigned_to, status, "
+                    "created_at) VALUES (?, ?, ?, ?, ?, ?) RETURNING ") +
+        kIssueColumnsSql + ";");
+    bindColumns(insertStmt.get());
+    if (sqlite3_step(insertStmt.get()) != SQLITE_ROW) {
+      throw std::runtime_error("Failed to insert issue");
+    }
+    // A new issue has no comments or tags yet, so no description either.
+    return issueFromRow(insertStmt.get());
+  }
+
+  // ---- UPDATE EXISTING ISSUE ----
+  // The UPDATE also returns the stored tags (name, own color, displayed
+  // color), so only added, removed or recolored tags are written and an
+  // edit that leaves them alone touches no tag row.
+  SqliteTxn txn(connection().db, connection().statements);
+  Issue saved;
+  int descriptionId = -1;
+  std::map<std::string, std::pair<std::string, std::string>> storedTags;
+  {
+    auto updateStmt = prepare(
+        std::string("UPDATE issues SET author_id = ?, title = ?, "
+                    "description_comment_id = ?, assigned_to = ?, "
+                    "status = ?, created_at = ? WHERE id = ? RETURNING ") +
+        kIssueColumnsSql +
+        ", (SELECT json_group_array(json_array(it.tag, "
+        "COALESCE(it.color, ''), "
+        "COALESCE(NULLIF(it.color, ''), t.color, ''))) "
+        "FROM issue_tags it LEFT JOIN tags t ON t.tag = it.tag "
+        "WHERE it.issue_id = issues.id);");
+    bindColumns(updateStmt.get());
     sqlite3_bind_int(updateStmt.get(), 7, stored.getId());
 
-    if (sqlite3_step(updateStmt.get()) != SQLITE_DONE) {
+    const int rc = sqlite3_step(updateStmt.get());
+    if (rc == SQLITE_DONE) {
+      throw std::invalid_argument(
+          "Issue with given ID does not exist: "
+          + std::to_string(stored.getId()));
+    }
+    if (rc != SQLITE_ROW) {
       throw std::runtime_error("Failed to update issue");
     }
+    saved = issueFromRow(updateStmt.get());
+    descriptionId = sqlite3_column_int(updateStmt.get(), 3);
+
+    const std::vector<std::string> fields =
+        jsonStrings(columnText(updateStmt.get(), 7));
+    for (std::size_t i = 0; i + 2 < fields.size(); i += 3) {
+      storedTags[fields[i]] = {fields[i + 1], fields[i + 2]};
+    }
   }
 
-  // ---- DELETE OLD TAGS ----
-  {
-    SqliteStmt deleteStmt(
-        db_, "DELETE FROM issue_tags WHERE issue_id = ?;");
-    sqlite3_bind_int(deleteStmt.get(), 1, stored.getId());
-    sqlite3_step(deleteStmt.get());
-  }
-
-  // ---- INSERT NEW TAGS ----
-  for (const auto& tag : stored.getTags()) {
-    upsertTagDefinition(db_, tag);
-    SqliteStmt tagStmt(
-        db_,
-        "INSERT INTO issue_tags (issue_id, tag, color) VALUES (?, ?, ?);");
-    sqlite3_bind_int(tagStmt.get(), 1, stored.getId());
-    sqlite3_bind_text(tagStmt.get(), 2, tag.getName().c_str(), -1,
+  const std::vector<Tag> tags = stored.getTags();
+  for (const auto& [name, colors] : storedTags) {
+    const bool kept =
+        std::any_of(tags.begin(), tags.end(),
+                    [&](const Tag& tag) { return tag.getName() == name; });
+    if (!kept) {
+      auto deleteStmt = prepare(
+          "DELETE FROM issue_tags WHERE issue_id = ? AND tag = ?;");
+      sqlite3_bind_int(deleteStmt.get(), 1, stored.getId());
+      sqlite3_bind_text(deleteStmt.get(), 2, name.c_str(), -1,
+                        SQLITE_TRANSIENT);
+      if (sqlite3_step(deleteStmt.get()) != SQLITE_DONE) {
+        throw std::runtime_error("Failed to remove issue tag");
+      }
+    }
+  }
+
+  for (const Tag& tag : tags) {
+    auto found = storedTags.find(tag.getName());
+    if (found != storedTags.end() && found->second.first == tag.getColor()) {
+      saved.addTag(Tag(tag.getName(), found->second.second));
+      continue;
+    }
+
+    const std::string definitionColor =
+        upsertTagDefinition(connection().statements, tag);
+    auto tagStmt = prepare(
+        found == storedTags.end()
+            ? "INSERT INTO issue_tags (color, issue_id, tag) "
+              "VALUES (?, ?, ?);"
+            : "UPDATE issue_tags SET color = ? "
+              "WHERE issue_id = ? AND tag = ?;");
+    sqlite3_bind_text(tagStmt.get(), 1, tag.getColor().c_str(), -1,
                       SQLITE_TRANSIENT);
-    sqlite3_bind_text(tagStmt.get(), 3, tag.getColor().c_str(), -1,
+    sqlite3_bind_int(tagStmt.get(), 2, stored.getId());
+    sqlite3_bind_text(tagStmt.get(), 3, tag.getName().c_str(), -1,
                       SQLITE_TRANSIENT);
-    sqlite3_step(tagStmt.get());
+    if (sqlite3_step(tagStmt.get()) != SQLITE_DONE) {
+      throw std::runtime_error("Failed to save issue tag");
+    }
+    saved.addTag(Tag(tag.getName(), tag.getColor().empty()
+                                        ? definitionColor
+                                        : tag.getColor()));
   }
+  txn.commit();
 
-  return getIssue(stored.getId());
+  // Comments are not written here; they load on first access as in
+  // getIssue.
+  const int issueId = saved.getId();
+  saved.deferComments(descriptionId, [this, issueId] {
+    ConnectionScope scope(*this, ConnectionScope::kRead);
+    return loadComments(issueId);
+  });
+  return saved;
+}
+
+namespace {
+// Runs a statement leased for a whole batch and readies it for the next
+// row. SQLITE_ROW is accepted so an INSERT ... RETURNING can be read first.
+void stepAndReset(sqlite3_stmt* stmt, const char* failure) {
+  const int rc = sqlite3_step(stmt);
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
+    throw std::runtime_error(failure);
+  }
+}
+}  // namespace
+
+std::vector<int> SQLiteIssueRepository::importIssues(
+    const std::vector<Issue>& issues) {
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
+  SqliteTxn txn(connection().db, connection().statements);
+
+  // Leased once for the whole batch, so each INSERT is compiled at most
+  // once per connection and only rebound per row.
+  auto issueStmt = prepare(
+      "INSERT INTO issues (author_id, title, description_comment_id, "
+      "assigned_to, status, created_at, next_comment_id) "
+      "VALUES (?, ?, ?, ?, ?, ?, ?) RETURNING id;");
+  auto commentStmt = prepare(
+      "INSERT INTO comments (id, issue_id, author_id, text, timestamp) "
+      "VALUES (?, ?, ?, ?, ?);");
+  auto tagStmt = prepare(
+      "INSERT INTO issue_tags (color, issue_id, tag) VALUES (?, ?, ?);");
+
+  const Issue::TimePoint now = currentTimeMillis();
+  std::vector<int> ids;
+  ids.reserve(issues.size());
+  for (const Issue& issue : issues) {
+    if (issue.hasPersistentId()) {
+      throw std::invalid_argument("Imported issues must be new");
+    }
+    const std::vector<Comment>& comments = issue.getComments();
+    int descriptionId = -1;
+    for (std::size_t i = 0; i < comments.size(); ++i) {
+      if (issue.hasDescriptionComment() &&
+          comments[i].getId() == issue.getDescriptionCommentId()) {
+        descriptionId = static_cast<int>(i);
+      }
+    }
+
+    sqlite3_stmt* stmt = issueStmt.get();
+    sqlite3_bind_text(stmt, 1, issue.getAuthorId().c_str(), -1,
+                      SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, issue.getTitle().c_str(), -1,
+                      SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 3, descriptionId);
+    if (issue.hasAssignee()) {
+      sqlite3_bind_text(stmt, 4, issue.getAssignedTo().c_str(), -1,
+                        SQLITE_TRANSIENT);
+    } else {
+      sqlite3_bind_null(stmt, 4);
+    }
+    sqlite3_bind_text(stmt, 5, issue.getStatus().c_str(), -1,
+                      SQLITE_TRANSIENT);
+    sqlite3_bind_int64(stmt, 6,
+                       issue.getTimestamp() == 0 ? now : issue.getTimestamp());
+    sqlite3_bind_int64(stmt, 7, static_cast<std::int64_t>(comments.size()));
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+      throw std::runtime_error("Failed to insert issue");
+    }
+    const int issueId = sqlite3_column_int(stmt, 0);
+    stepAndReset(stmt, "Failed to insert issue");
+    ids.push_back(issueId);
+
+    for (std::size_t i = 0; i < comments.size(); ++i) {
+      const Comment& comment = comments[i];
+      stmt = commentStmt.get();
+      sqlite3_bind_int(stmt, 1, static_cast<int>(i));
+      sqlite3_bind_int(stmt, 2, issueId);
+      sqlite3_bind_text(stmt, 3, comment.getAuthor().c_str(), -1,
+                        SQLITE_TRANSIENT);
+      sqlite3_bind_text(stmt, 4, comment.getText().c_str(), -1,
+                        SQLITE_TRANSIENT);
+      sqlite3_bind_int64(stmt, 5, comment.getTimeStamp() == 0
+                                      ? now
+                                      : comment.getTimeStamp());
+      stepAndReset(stmt, "Failed to insert comment");
+    }
+
+    for (const Tag& tag : issue.getTags()) {
+      upsertTagDefinition(connection().statements, tag);
+      stmt = tagStmt.get();
+      sqlite3_bind_text(stmt, 1, tag.getColor().c_str(), -1,
+                        SQLITE_TRANSIENT);
+      sqlite3_bind_int(stmt, 2, issueId);
+      sqlite3_bind_text(stmt, 3, tag.getName().c_str(), -1,
+                        SQLITE_TRANSIENT);
+      stepAndReset(stmt, "Failed to save issue tag");
+    }
+  }
+  txn.commit();
+  return ids;
 }
 
 bool SQLiteIssueRepository::deleteIssue(int issueId) {
-  SqliteStmt stmt(db_, "DELETE FROM issues WHERE id = ?;");
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
+  auto stmt = prepare("DELETE FROM issues WHERE id = ?;");
   sqlite3_bind_int(stmt.get(), 1, issueId);
   if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
     throw std::runtime_error("Failed to delete issue");
   }
-  return sqlite3_changes(db_) > 0;
+  return sqlite3_changes(connection().db) > 0;
 }
 
 std::vector<Issue> SQLiteIssueRepository::listIssues() const {
-  std::vector<Issue> issues;
-  forEachRow(
-      "SELECT id FROM issues ORDER BY id ASC;",
-      nullptr,
-      [this, &issues](sqlite3_stmt* stmt) {
-        int id = sqlite3_column_int(stmt, 0);
-        issues.push_back(getIssue(id));
-      });
-  return issues;
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  return hydrateIssues("", nullptr);
 }
 
 // Generic filter used by specific find/list methods.
 std::vector<Issue> SQLiteIssueRepository::findIssues(
     std::function<bool(const Issue&)> criteria) const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
   std::vector<Issue> all = listIssues();
   std::vector<Issue> filtered;
   for (Issue& issue : all) {
     if (criteria(issue)) {
-      filtered.push_back(issue);
+      filtered.push_back(std::move(issue));
     }
   }
   return filtered;
 }
 
 std::vector<Tag> SQLiteIssueRepository::listAllTags() const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
   std::vector<Tag> tags;
   forEachRow(
       "SELECT tag, color FROM tags ORDER BY tag ASC;",
@@ -544,54 +1656,247 @@ std::vector<Tag> SQLiteIssueRepository::listAllTags() const {
 }
 
 bool SQLiteIssueRepository::deleteTag(const std::string& tag) {
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
   if (tag.empty()) {
     return false;
   }
 
   {
-    SqliteStmt stmt(
-        db_, "DELETE FROM issue_tags WHERE LOWER(tag) = LOWER(?);");
+    auto stmt = prepare(
+        "DELETE FROM issue_tags WHERE LOWER(tag) = LOWER(?);");
     sqlite3_bind_text(stmt.get(), 1, tag.c_str(), -1, SQLITE_TRANSIENT);
     sqlite3_step(stmt.get());
   }
 
-  SqliteStmt stmt(db_, "DELETE FROM tags WHERE LOWER(tag) = LOWER(?);");
+  auto stmt = prepare("DELETE FROM tags WHERE LOWER(tag) = LOWER(?);");
   sqlite3_bind_text(stmt.get(), 1, tag.c_str(), -1, SQLITE_TRANSIENT);
   if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
     throw std::runtime_error("Failed to delete tag definition");
   }
-  return sqlite3_changes(db_) > 0;
+  return sqlite3_changes(connection().db) > 0;
 }
 
 // --- Interface overrides that your controller uses ---
 
 std::vector<Issue> SQLiteIssueRepository::findIssues(
     const std::string& userId) const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
   // Same semantics as in-memory repo: match author or assignee.
-  return findIssues(
-      [&userId](const Issue& issue) {
-        if (issue.getAuthorId() == userId) {
-          return true;
+  return hydrateIssues(
+      "WHERE author_id = ?1 OR assigned_to = ?1",
+      [&userId](sqlite3_stmt* stmt) {
+        sqlite3_bind_text(stmt, 1, userId.c_str(), -1, SQLITE_TRANSIENT);
+      });
+}
+
+std::vector<Issue> SQLiteIssueRepository::findIssues(
+    const IssueQuery& query) const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  const CompiledQuery compiled = compileQuery(query);
+  return hydrateIssues(compiled.where, [&compiled](sqlite3_stmt* stmt) {
+    compiled.bind(stmt);
+  });
+}
+
+IssuePage SQLiteIssueRepository::findIssuePage(
+    const IssueQuery& query, const IssuePageRequest& page) const {
+  std::string selection;
+  const CompiledQuery compiled = compilePage(query, page, &selection);
+  IssuePage result;
+  if (page.limit == 0) {
+    return result;
+  }
+
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  result.issues = hydrateIssues(
+      compiled.where,
+      [&compiled](sqlite3_stmt* stmt) { compiled.bind(stmt); },
+      selection);
+  if (result.issues.size() > page.limit) {
+    result.issues.resize(page.limit);
+    const Issue& last = result.issues.back();
+    result.next = cursorAt(page.sort, last.getId(), last.getCreatedAt());
+  }
+  return result;
+}
+
+std::vector<IssueSummary> SQLiteIssueRepository::loadSummaries(
+    const std::string& filterSql,
+    const std::function<void(sqlite3_stmt*)>& binder,
+    const std::string& selectionSql) const {
+  // A single statement: comment counts and tag names come from correlated
+  // subqueries, so no comment text is ever read.
+  std::vector<IssueSummary> summaries;
+  forEachRow(
+      "SELECT id, title, status, assigned_to, author_id, created_at, "
+      "(SELECT COUNT(*) FROM comments WHERE comments.issue_id = issues.id), "
+      "(SELECT json_group_array(tag) FROM issue_tags "
+      "WHERE issue_tags.issue_id = issues.id) "
+      "FROM issues " + filterSql + " " +
+          (selectionSql.empty() ? std::string("ORDER BY id ASC")
+                                : selectionSql) +
+          ";",
+      binder,
+      [&](sqlite3_stmt* stmt) {
+        IssueSummary summary;
+        summary.id = sqlite3_column_int(stmt, 0);
+        summary.title = columnText(stmt, 1);
+        summary.status = columnText(stmt, 2);
+        summary.assignedTo = columnText(stmt, 3);
+        summary.authorId = columnText(stmt, 4);
+        summary.createdAt = sqlite3_column_int64(stmt, 5);
+        summary.commentCount =
+            static_cast<std::size_t>(sqlite3_column_int64(stmt, 6));
+
+        summary.tags = jsonStrings(columnText(stmt, 7));
+        std::sort(summary.tags.begin(), summary.tags.end());
+        summaries.push_back(std::move(summary));
+      });
+  return summaries;
+}
+
+std::vector<IssueSummary> SQLiteIssueRepository::findIssueSummaries(
+    const IssueQuery& query) const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  const CompiledQuery compiled = compileQuery(query);
+  return loadSummaries(compiled.where, [&compiled](sqlite3_stmt* stmt) {
+    compiled.bind(stmt);
+  });
+}
+
+IssueSummaryPage SQLiteIssueRepository::findIssueSummaryPage(
+    const IssueQuery& query, const IssuePageRequest& page) const {
+  std::string selection;
+  const CompiledQuery compiled = compilePage(query, page, &selection);
+  IssueSummaryPage result;
+  if (page.limit == 0) {
+    return result;
+  }
+
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  result.summaries = loadSummaries(
+      compiled.where,
+      [&compiled](sqlite3_stmt* stmt) { compiled.bind(stmt); },
+      selection);
+  if (result.summaries.size() > page.limit) {
+    result.summaries.resize(page.limit);
+    const IssueSummary& last = result.summaries.back();
+    result.next = cursorAt(page.sort, last.id, last.createdAt);
+  }
+  return result;
+}
+
+IssueStats SQLiteIssueRepository::countIssues(
+    const IssueQuery& query) const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  const CompiledQuery compiled = compileQuery(query);
+  auto binder = [&compiled](sqlite3_stmt* stmt) { compiled.bind(stmt); };
+  auto count = [](sqlite3_stmt* stmt) {
+    return static_cast<std::size_t>(sqlite3_column_int64(stmt, 1));
+  };
+
+  IssueStats stats;
+  forEachRow(
+      "SELECT status, COUNT(*) FROM issues " + compiled.where +
+          " GROUP BY status;",
+      binder,
+      [&](sqlite3_stmt* stmt) {
+        stats.byStatus[columnText(stmt, 0)] += count(stmt);
+        stats.total += count(stmt);
+      });
+  forEachRow(
+      "SELECT assigned_to, COUNT(*) FROM issues " + compiled.where +
+          " GROUP BY assigned_to;",
+      binder,
+      [&](sqlite3_stmt* stmt) {
+        const std::string assignee = columnText(stmt, 0);
+        if (assignee.empty()) {
+          stats.unassigned += count(stmt);
+        } else {
+          stats.byAssignee[assignee] += count(stmt);
         }
-        return issue.hasAssignee()
-               && issue.getAssignedTo() == userId;
       });
+  forEachRow(
+      "SELECT tag, COUNT(*) FROM issue_tags" +
+          (compiled.where.empty()
+               ? std::string()
+               : " WHERE issue_id IN (SELECT id FROM issues " +
+                     compiled.where + ")") +
+          " GROUP BY tag;",
+      binder,
+      [&](sqlite3_stmt* stmt) {
+        stats.byTag[columnText(stmt, 0)] += count(stmt);
+      });
+  return stats;
 }
 
-std::vector<Issue> SQLiteIssueRepository::listAllUnassigned() const {
-  return findIssues(
-      [](const Issue& issue) {
-        return !issue.hasAssignee();
+SearchPage SQLiteIssueRepository::searchIssues(
+    const SearchRequest& request) const {
+  const std::vector<std::string> terms = request.terms();
+  if (terms.empty()) {
+    throw std::invalid_argument("search text has no terms");
+  }
+  SearchPage page;
+  if (request.limit == 0) {
+    return page;
+  }
+
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  const std::string match = ftsMatchExpression(terms);
+  // One row past the limit tells whether another page follows. BM25 is
+  // negative, better matches lower; title and comment scores mix as-is.
+  forEachRow(
+      "SELECT hit.issue_id, hit.comment_id, issues.title, hit.snippet, "
+      "hit.score "
+      "FROM ("
+      "SELECT rowid AS issue_id, -1 AS comment_id, "
+      "snippet(issue_title_fts, 0, '[', ']', '...', 16) AS snippet, "
+      "bm25(issue_title_fts) AS score "
+      "FROM issue_title_fts WHERE issue_title_fts MATCH ?1 "
+      "UNION ALL "
+      "SELECT rowid >> 32, rowid & 4294967295, "
+      "snippet(comment_fts, 0, '[', ']', '...', 16), bm25(comment_fts) "
+      "FROM comment_fts WHERE comment_fts MATCH ?1"
+      ") AS hit JOIN issues ON issues.id = hit.issue_id "
+      "ORDER BY hit.score ASC, hit.issue_id ASC, hit.comment_id ASC "
+      "LIMIT ?2 OFFSET ?3;",
+      [&](sqlite3_stmt* stmt) {
+        sqlite3_bind_text(stmt, 1, match.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 2,
+                           static_cast<sqlite3_int64>(request.limit) + 1);
+        sqlite3_bind_int64(stmt, 3,
+                           static_cast<sqlite3_int64>(request.offset));
+      },
+      [&](sqlite3_stmt* stmt) {
+        if (page.hits.size() == request.limit) {
+          page.nextOffset = request.offset + request.limit;
+          return;
+        }
+        SearchHit hit;
+        hit.issueId = sqlite3_column_int(stmt, 0);
+        hit.commentId = sqlite3_column_int(stmt, 1);
+        hit.title = columnText(stmt, 2);
+        hit.snippet = columnText(stmt, 3);
+        hit.score = sqlite3_column_double(stmt, 4);
+        page.hits.push_back(std::move(hit));
       });
+  return page;
+}
+
+std::vector<Issue> SQLiteIssueRepository::listAllUnassigned() const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  return hydrateIssues("WHERE assigned_to IS NULL OR assigned_to = ''",
+                       nullptr);
 }
 
 bool SQLiteIssueRepository::addTagToIssue(
     int issueId, const Tag& tag) {
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
   if (tag.getName().empty() || !issueExists(issueId)) {
     return false;
   }
 
-  upsertTagDefinition(db_, tag);
+  upsertTagDefinition(connection().statements, tag);
 
   bool alreadyAttached = exists(
       "SELECT 1 FROM issue_tags "
@@ -606,8 +1911,7 @@ bool SQLiteIssueRepository::addTagToIssue(
       });
 
   if (alreadyAttached) {
-    SqliteStmt updateStmt(
-        db_,
+    auto updateStmt = prepare(
         "UPDATE issue_tags "
         "SET color = COALESCE(NULLIF(?, ''), color) "
         "WHERE issue_id = ? AND LOWER(tag) = LOWER(?);");
@@ -620,8 +1924,8 @@ bool SQLiteIssueRepository::addTagToIssue(
     return true;
   }
 
-  SqliteStmt stmt(
-      db_, "INSERT INTO issue_tags (issue_id, tag, color) VALUES (?, ?, ?);");
+  auto stmt = prepare(
+      "INSERT INTO issue_tags (issue_id, tag, color) VALUES (?, ?, ?);");
   sqlite3_bind_int(stmt.get(), 1, issueId);
   sqlite3_bind_text(stmt.get(), 2, tag.getName().c_str(), -1,
                     SQLITE_TRANSIENT);
@@ -633,12 +1937,12 @@ bool SQLiteIssueRepository::addTagToIssue(
 
 bool SQLiteIssueRepository::removeTagFromIssue(
     int issueId, const std::string& tag) {
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
   if (tag.empty() || !issueExists(issueId)) {
     return false;
   }
 
-  SqliteStmt stmt(
-      db_,
+  auto stmt = prepare(
       "DELETE FROM issue_tags "
       "WHERE issue_id = ? "
       "AND LOWER(tag) = LOWER(?);");
@@ -646,7 +1950,7 @@ bool SQLiteIssueRepository::removeTagFromIssue(
   sqlite3_bind_text(stmt.get(), 2, tag.c_str(), -1,
                     SQLITE_TRANSIENT);
   sqlite3_step(stmt.get());
-  return sqlite3_changes(db_) > 0;
+  return sqlite3_changes(connection().db) > 0;
 }
 
 
@@ -654,8 +1958,8 @@ bool SQLiteIssueRepository::removeTagFromIssue(
 
 Comment SQLiteIssueRepository::getComment(int issueId,
                                           int commentId) const {
-  SqliteStmt stmt(
-      db_,
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  auto stmt = prepare(
       "SELECT id, author_id, text, timestamp FROM comments "
       "WHERE issue_id = ? AND id = ? LIMIT 1;");
   sqlite3_bind_int(stmt.get(), 1, issueId);
@@ -675,21 +1979,93 @@ Comment SQLiteIssueRepository::getComment(int issueId,
 
 std::vector<Comment> SQLiteIssueRepository::getAllComments(
     int issueId) const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
   if (!issueExists(issueId)) {
     throw std::invalid_argument("Issue with given ID does not exist");
   }
   return loadComments(issueId);
 }
 
-Comment SQLiteIssueRepository::saveComment(int issueId,
-                                           const Comment& comment) {
+CommentPage SQLiteIssueRepository::getCommentPage(
+    int issueId, const CommentPageRequest& page) const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
   if (!issueExists(issueId)) {
     throw std::invalid_argument("Issue with given ID does not exist");
   }
+  CommentPage result;
+  if (page.limit == 0) {
+    return result;
+  }
+  // One row past the limit tells whether another page follows.
+  forEachRow(
+      "SELECT id, author_id, text, timestamp FROM comments "
+      "WHERE issue_id = ? AND id > ? ORDER BY id ASC LIMIT ?;",
+      [&](sqlite3_stmt* stmt) {
+        sqlite3_bind_int(stmt, 1, issueId);
+        sqlite3_bind_int(stmt, 2, page.after);
+        sqlite3_bind_int64(stmt, 3,
+                           static_cast<sqlite3_int64>(page.limit) + 1);
+      },
+      [&result](sqlite3_stmt* stmt) {
+        result.comments.emplace_back(
+            sqlite3_column_int(stmt, 0), columnText(stmt, 1),
+            columnText(stmt, 2), sqlite3_column_int64(stmt, 3));
+      });
+  if (result.comments.size() > page.limit) {
+    result.comments.resize(page.limit);
+    result.next = result.comments.back().getId();
+  }
+  return result;
+}
+
+IssueDigest SQLiteIssueRepository::getIssueDigest(int issueId,
+                                                  std::size_t latest) const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  std::vector<IssueSummary> found = loadSummaries(
+      "WHERE id = ?",
+      [issueId](sqlite3_stmt* stmt) { sqlite3_bind_int(stmt, 1, issueId); });
+  if (found.empty()) {
+    throw std::invalid_argument("Issue with given ID does not exist");
+  }
+
+  IssueDigest digest;
+  digest.summary = std::move(found.front());
+  // The description by key, then the newest other comments walking the
+  // primary key backwards; neither part touches older comments.
+  forEachRow(
+      "SELECT id, author_id, text, timestamp, 1 FROM comments "
+      "WHERE issue_id = ?1 AND id = "
+      "(SELECT description_comment_id FROM issues WHERE id = ?1) "
+      "UNION ALL "
+      "SELECT * FROM (SELECT id, author_id, text, timestamp, 0 "
+      "FROM comments WHERE issue_id = ?1 AND id IS NOT "
+      "(SELECT description_comment_id FROM issues WHERE id = ?1) "
+      "ORDER BY id DESC LIMIT ?2);",
+      [&](sqlite3_stmt* stmt) {
+        sqlite3_bind_int(stmt, 1, issueId);
+        sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(latest));
+      },
+      [&digest](sqlite3_stmt* stmt) {
+        Comment comment(sqlite3_column_int(stmt, 0), columnText(stmt, 1),
+                        columnText(stmt, 2), sqlite3_column_int64(stmt, 3));
+        if (sqlite3_column_int(stmt, 4) != 0) {
+          digest.description = std::move(comment);
+        } else {
+          digest.latestComments.push_back(std::move(comment));
+        }
+      });
+  std::reverse(digest.latestComments.begin(), digest.latestComments.end());
+  return digest;
+}
 
+Comment SQLiteIssueRepository::saveComment(int issueId,
+                                           const Comment& comment) {
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
   if (!comment.hasPersistentId()) {
-    const int newId = nextCommentIdForIssue(issueId);
-    return insertCommentRow(issueId, comment, newId);
+    return appendCommentRow(issueId, comment);
+  }
+  if (!issueExists(issueId)) {
+    throw std::invalid_argument("Issue with given ID does not exist");
   }
 
   const int commentId = comment.getId();
@@ -702,8 +2078,7 @@ Comment SQLiteIssueRepository::saveComment(int issueId,
 
   Comment updated = comment;
 
-  SqliteStmt stmt(
-      db_,
+  auto stmt = prepare(
       "UPDATE comments SET author_id = ?, text = ?, timestamp = ? "
       "WHERE issue_id = ? AND id = ?;");
 
@@ -723,6 +2098,7 @@ Comment SQLiteIssueRepository::saveComment(int issueId,
 }
 
 bool SQLiteIssueRepository::deleteComment(int issueId, int commentId) {
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
   if (!issueExists(issueId)) {
     throw std::invalid_argument("Issue with given ID does not exist");
   }
@@ -731,30 +2107,28 @@ bool SQLiteIssueRepository::deleteComment(int issueId, int commentId) {
     throw std::invalid_argument("Comment with given ID does not exist");
   }
 
-  SqliteStmt clearDesc(
-      db_,
+  auto clearDesc = prepare(
       "UPDATE issues SET description_comment_id = -1 WHERE id = ? "
       "AND description_comment_id = ?;");
   sqlite3_bind_int(clearDesc.get(), 1, issueId);
   sqlite3_bind_int(clearDesc.get(), 2, commentId);
   sqlite3_step(clearDesc.get());
 
-  SqliteStmt stmt(
-      db_,
+  auto stmt = prepare(
       "DELETE FROM comments WHERE issue_id = ? AND id = ?;");
   sqlite3_bind_int(stmt.get(), 1, issueId);
   sqlite3_bind_int(stmt.get(), 2, commentId);
   if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
     throw std::runtime_error("Failed to delete comment");
   }
-  return sqlite3_changes(db_) > 0;
+  return sqlite3_changes(connection().db) > 0;
 }
 
 // --- Users ---
 
 User SQLiteIssueRepository::getUser(const std::string& userId) const {
-  SqliteStmt stmt(
-      db_,
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  auto stmt = prepare(
       "SELECT name, role FROM users WHERE name = ? LIMIT 1;");
   sqlite3_bind_text(stmt.get(), 1, userId.c_str(), -1, SQLITE_TRANSIENT);
 
@@ -768,12 +2142,12 @@ User SQLiteIssueRepository::getUser(const std::string& userId) const {
 }
 
 User SQLiteIssueRepository::saveUser(const User& user) {
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
   if (user.getName().empty()) {
     throw std::invalid_argument("User ID must be non-empty");
   }
 
-  SqliteStmt stmt(
-      db_,
+  auto stmt = prepare(
       "INSERT INTO users (name, role) VALUES (?, ?) "
       "ON CONFLICT(name) DO UPDATE SET role = excluded.role;");
   sqlite3_bind_text(stmt.get(), 1, user.getName().c_str(), -1,
@@ -788,15 +2162,17 @@ User SQLiteIssueRepository::saveUser(const User& user) {
 }
 
 bool SQLiteIssueRepository::deleteUser(const std::string& userId) {
-  SqliteStmt stmt(db_, "DELETE FROM users WHERE name = ?;");
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
+  auto stmt = prepare("DELETE FROM users WHERE name = ?;");
   sqlite3_bind_text(stmt.get(), 1, userId.c_str(), -1, SQLITE_TRANSIENT);
   if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
     throw std::runtime_error("Failed to delete user");
   }
-  return sqlite3_changes(db_) > 0;
+  return sqlite3_changes(connection().db) > 0;
 }
 
 std::vector<User> SQLiteIssueRepository::listAllUsers() const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
   std::vector<User> users;
   forEachRow(
       "SELECT name, role FROM users ORDER BY name ASC;",
@@ -827,7 +2203,7 @@ std::vector<int> SQLiteIssueRepository::loadMilestoneIssueIds(
 }
 
 bool SQLiteIssueRepository::milestoneExists(int milestoneId) const {
-  SqliteStmt stmt(db_, "SELECT 1 FROM milestones WHERE id = ? LIMIT 1;");
+  auto stmt = prepare("SELECT 1 FROM milestones WHERE id = ? LIMIT 1;");
   sqlite3_bind_int(stmt.get(), 1, milestoneId);
   int rc = sqlite3_step(stmt.get());
   if (rc == SQLITE_ROW) {
@@ -840,40 +2216,25 @@ bool SQLiteIssueRepository::milestoneExists(int milestoneId) const {
 }
 
 Milestone SQLiteIssueRepository::saveMilestone(const Milestone& milestone) {
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
   if (milestone.getName().empty() || milestone.getStartDate().empty() ||
       milestone.getEndDate().empty()) {
     throw std::invalid_argument("Milestone requires name/start/end dates");
   }
 
-  if (!milestone.hasPersistentId()) {
-    SqliteStmt stmt(
-        db_,
-        "INSERT INTO milestones (name, description, start_date, end_date) "
-        "VALUES (?, ?, ?, ?);");
-    sqlite3_bind_text(stmt.get(), 1, milestone.getName().c_str(), -1,
-                      SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 2, milestone.getDescription().c_str(), -1,
-                      SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 3, milestone.getStartDate().c_str(), -1,
-                      SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 4, milestone.getEndDate().c_str(), -1,
-                      SQLITE_TRANSIENT);
-
-    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
-      throw std::runtime_error("Failed to insert milestone");
-    }
-    int newId = static_cast<int>(sqlite3_last_insert_rowid(db_));
-    return getMilestone(newId);
-  }
-
-  if (!milestoneExists(milestone.getId())) {
-    throw std::out_of_range("Milestone not found");
-  }
-
-  SqliteStmt stmt(
-      db_,
-      "UPDATE milestones SET name = ?, description = ?, start_date = ?, "
-      "end_date = ? WHERE id = ?;");
+  // Both statements return the row as written, with the linked issue ids
+  // aggregated in a subquery, so nothing is read back afterwards.
+  const bool inserting = !milestone.hasPersistentId();
+  auto stmt = prepare(
+      std::string(inserting
+                      ? "INSERT INTO milestones (name, description, "
+                        "start_date, end_date) VALUES (?, ?, ?, ?) "
+                      : "UPDATE milestones SET name = ?, description = ?, "
+                        "start_date = ?, end_date = ? WHERE id = ? ") +
+      "RETURNING id, name, description, start_date, end_date, "
+      "(SELECT GROUP_CONCAT(issue_id) FROM (SELECT issue_id "
+      "FROM milestone_issues WHERE milestone_id = milestones.id "
+      "ORDER BY issue_id));");
   sqlite3_bind_text(stmt.get(), 1, milestone.getName().c_str(), -1,
                     SQLITE_TRANSIENT);
   sqlite3_bind_text(stmt.get(), 2, milestone.getDescription().c_str(), -1,
@@ -882,40 +2243,54 @@ Milestone SQLiteIssueRepository::saveMilestone(const Milestone& milestone) {
                     SQLITE_TRANSIENT);
   sqlite3_bind_text(stmt.get(), 4, milestone.getEndDate().c_str(), -1,
                     SQLITE_TRANSIENT);
-  sqlite3_bind_int(stmt.get(), 5, milestone.getId());
+  if (!inserting) {
+    sqlite3_bind_int(stmt.get(), 5, milestone.getId());
+  }
 
-  if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
-    throw std::runtime_error("Failed to update milestone");
+  const int rc = sqlite3_step(stmt.get());
+  if (rc == SQLITE_DONE && !inserting) {
+    throw std::out_of_range("Milestone not found");
+  }
+  if (rc != SQLITE_ROW) {
+    throw std::runtime_error(inserting ? "Failed to insert milestone"
+                                       : "Failed to update milestone");
   }
-  return getMilestone(milestone.getId());
+
+  std::vector<int> issueIds;
+  const std::string linked = columnText(stmt.get(), 5);
+  for (std::size_t begin = 0; begin < linked.size();) {
+    std::size_t comma = linked.find(',', begin);
+    if (comma == std::string::npos) {
+      comma = linked.size();
+    }
+    issueIds.push_back(std::stoi(linked.substr(begin, comma - begin)));
+    begin = comma + 1;
+  }
+  return Milestone(sqlite3_column_int(stmt.get(), 0),
+                   columnText(stmt.get(), 1), columnText(stmt.get(), 2),
+                   columnText(stmt.get(), 3), columnText(stmt.get(), 4),
+                   std::move(issueIds));
 }
 
 Milestone SQLiteIssueRepository::getMilestone(int milestoneId) const {
-  SqliteStmt stmt(db_,
-                  "SELECT id, name, description, start_date, end_date "
-                  "FROM milestones WHERE id = ?;");
-  sqlite3_bind_int(stmt.get(), 1, milestoneId);
-
-  if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  std::vector<Milestone> found = loadMilestones(
+      "WHERE milestones.id = ?", [milestoneId](sqlite3_stmt* stmt) {
+        sqlite3_bind_int(stmt, 1, milestoneId);
+      });
+  if (found.empty()) {
     throw std::out_of_range("Milestone not found");
   }
-
-  int id = sqlite3_column_int(stmt.get(), 0);
-  std::string name = columnText(stmt.get(), 1);
-  std::string desc = columnText(stmt.get(), 2);
-  std::string start = columnText(stmt.get(), 3);
-  std::string end = columnText(stmt.get(), 4);
-  std::vector<int> issueIds = loadMilestoneIssueIds(id);
-
-  return Milestone(id, name, desc, start, end, issueIds);
+  return std::move(found.front());
 }
 
 bool SQLiteIssueRepository::deleteMilestone(int milestoneId, bool cascade) {
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
   if (!milestoneExists(milestoneId)) {
     throw std::out_of_range("Milestone not found");
   }
 
-  SqliteTxn txn(db_);
+  SqliteTxn txn(connection().db, connection().statements);
   if (cascade) {
     std::vector<int> issueIds = loadMilestoneIssueIds(milestoneId);
     for (int issueId : issueIds) {
@@ -923,34 +2298,66 @@ bool SQLiteIssueRepository::deleteMilestone(int milestoneId, bool cascade) {
     }
   }
 
-  SqliteStmt stmt(db_, "DELETE FROM milestones WHERE id = ?;");
+  auto stmt = prepare("DELETE FROM milestones WHERE id = ?;");
   sqlite3_bind_int(stmt.get(), 1, milestoneId);
   if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
     throw std::runtime_error("Failed to delete milestone");
   }
-  bool removed = sqlite3_changes(db_) > 0;
+  bool removed = sqlite3_changes(connection().db) > 0;
   txn.commit();
   return removed;
 }
 
-std::vector<Milestone> SQLiteIssueRepository::listAllMilestones() const {
+std::vector<Milestone> SQLiteIssueRepository::loadMilestones(
+    const std::string& filterSql,
+    const std::function<void(sqlite3_stmt*)>& binder) const {
+  // One row per link, or one NULL-issue row for an empty milestone. The
+  // order keeps each milestone's rows together with ascending issue ids.
   std::vector<Milestone> list;
+  std::vector<int> issueIds;
+  int currentId = -1;
+  std::string name, desc, start, end;
+  auto flush = [&] {
+    if (currentId >= 0) {
+      list.emplace_back(currentId, std::move(name), std::move(desc),
+                        std::move(start), std::move(end),
+                        std::move(issueIds));
+      issueIds.clear();
+    }
+  };
   forEachRow(
-      "SELECT id, name, description, start_date, end_date FROM milestones "
-      "ORDER BY start_date ASC, id ASC;",
-      {}, [this, &list](sqlite3_stmt* stmt) {
-        int id = sqlite3_column_int(stmt, 0);
-        std::string name = columnText(stmt, 1);
-        std::string desc = columnText(stmt, 2);
-        std::string start = columnText(stmt, 3);
-        std::string end = columnText(stmt, 4);
-        list.emplace_back(id, name, desc, start, end,
-                          loadMilestoneIssueIds(id));
+      "SELECT milestones.id, name, description, start_date, end_date, "
+      "milestone_issues.issue_id FROM milestones "
+      "LEFT JOIN milestone_issues "
+      "ON milestone_issues.milestone_id = milestones.id " +
+          filterSql +
+          " ORDER BY start_date ASC, milestones.id ASC, "
+          "milestone_issues.issue_id ASC;",
+      binder, [&](sqlite3_stmt* stmt) {
+        const int id = sqlite3_column_int(stmt, 0);
+        if (id != currentId) {
+          flush();
+          currentId = id;
+          name = columnText(stmt, 1);
+          desc = columnText(stmt, 2);
+          start = columnText(stmt, 3);
+          end = columnText(stmt, 4);
+        }
+        if (sqlite3_column_type(stmt, 5) != SQLITE_NULL) {
+          issueIds.push_back(sqlite3_column_int(stmt, 5));
+        }
       });
+  flush();
   return list;
 }
 
+std::vector<Milestone> SQLiteIssueRepository::listAllMilestones() const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  return loadMilestones("", nullptr);
+}
+
 bool SQLiteIssueRepository::addIssueToMilestone(int milestoneId, int issueId) {
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
   if (!milestoneExists(milestoneId)) {
     throw std::out_of_range("Milestone not found");
   }
@@ -958,8 +2365,7 @@ bool SQLiteIssueRepository::addIssueToMilestone(int milestoneId, int issueId) {
     throw std::invalid_argument("Issue with given ID does not exist");
   }
 
-  SqliteStmt stmt(
-      db_,
+  auto stmt = prepare(
       "INSERT OR IGNORE INTO milestone_issues (milestone_id, issue_id) "
       "VALUES (?, ?);");
   sqlite3_bind_int(stmt.get(), 1, milestoneId);
@@ -968,17 +2374,17 @@ bool SQLiteIssueRepository::addIssueToMilestone(int milestoneId, int issueId) {
   if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
     throw std::runtime_error("Failed to link issue to milestone");
   }
-  return sqlite3_changes(db_) > 0;
+  return sqlite3_changes(connection().db) > 0;
 }
 
 bool SQLiteIssueRepository::removeIssueFromMilestone(int milestoneId,
                                                      int issueId) {
+  ConnectionScope scope(*this, ConnectionScope::kWrite);
   if (!milestoneExists(milestoneId)) {
     throw std::out_of_range("Milestone not found");
   }
 
-  SqliteStmt stmt(
-      db_,
+  auto stmt = prepare(
       "DELETE FROM milestone_issues WHERE milestone_id = ? AND issue_id = ?;");
   sqlite3_bind_int(stmt.get(), 1, milestoneId);
   sqlite3_bind_int(stmt.get(), 2, issueId);
@@ -986,24 +2392,96 @@ bool SQLiteIssueRepository::removeIssueFromMilestone(int milestoneId,
   if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
     throw std::runtime_error("Failed to unlink issue from milestone");
   }
-  return sqlite3_changes(db_) > 0;
+  return sqlite3_changes(connection().db) > 0;
 }
 
 std::vector<Issue> SQLiteIssueRepository::getIssuesForMilestone(
     int milestoneId) const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
   if (!milestoneExists(milestoneId)) {
     throw std::out_of_range("Milestone not found");
   }
 
-  std::vector<Issue> issues;
+  return hydrateIssues(
+      "WHERE id IN (SELECT issue_id FROM milestone_issues "
+      "WHERE milestone_id = ?)",
+      [milestoneId](sqlite3_stmt* stmt) {
+        sqlite3_bind_int(stmt, 1, milestoneId);
+      });
+}
+
+MilestoneStats SQLiteIssueRepository::getMilestoneStats(
+    int milestoneId) const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  // Starting from milestones makes an unknown id return no rows and an
+  // empty milestone a single row with a NULL status.
+  bool found = false;
+  MilestoneStats stats;
+  stats.milestoneId = milestoneId;
   forEachRow(
-      "SELECT issue_id FROM milestone_issues WHERE milestone_id = ?;",
+      "SELECT issues.status, COUNT(issues.id) FROM milestones "
+      "LEFT JOIN milestone_issues "
+      "ON milestone_issues.milestone_id = milestones.id "
+      "LEFT JOIN issues ON issues.id = milestone_issues.issue_id "
+      "WHERE milestones.id = ? GROUP BY issues.status;",
       [milestoneId](sqlite3_stmt* stmt) {
         sqlite3_bind_int(stmt, 1, milestoneId);
       },
-      [this, &issues](sqlite3_stmt* stmt) {
-        int issueId = sqlite3_column_int(stmt, 0);
-        issues.push_back(getIssue(issueId));
+      [&](sqlite3_stmt* stmt) {
+        found = true;
+        const auto count =
+            static_cast<std::size_t>(sqlite3_column_int64(stmt, 1));
+        if (count == 0) {
+          return;
+        }
+        const std::string status = columnText(stmt, 0);
+        stats.byStatus[status] += count;
+        stats.total += count;
+        if (IssueQuery::statusKey(status) == "done") {
+          stats.closed += count;
+        }
       });
-  return issues;
+  if (!found) {
+    throw std::out_of_range("Milestone not found");
+  }
+  return stats;
+}
+
+std::vector<Milestone> SQLiteIssueRepository::findMilestonesInRange(
+    const std::string& from, const std::string& to) const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  std::vector<std::string> clauses;
+  if (!to.empty()) {
+    clauses.push_back("start_date <= ?");
+  }
+  if (!from.empty()) {
+    clauses.push_back("end_date >= ?");
+  }
+  std::string filterSql;
+  for (const std::string& clause : clauses) {
+    filterSql += (filterSql.empty() ? "WHERE " : " AND ") + clause;
+  }
+  return loadMilestones(filterSql, [&](sqlite3_stmt* stmt) {
+    int index = 1;
+    if (!to.empty()) {
+      sqlite3_bind_text(stmt, index++, to.c_str(), -1, SQLITE_TRANSIENT);
+    }
+    if (!from.empty()) {
+      sqlite3_bind_text(stmt, index++, from.c_str(), -1, SQLITE_TRANSIENT);
+    }
+  });
+}
+
+std::vector<Milestone> SQLiteIssueRepository::findCompletedMilestones()
+    const {
+  ConnectionScope scope(*this, ConnectionScope::kRead);
+  return loadMilestones(
+      std::string("WHERE EXISTS (SELECT 1 FROM milestone_issues "
+                  "WHERE milestone_id = milestones.id) "
+                  "AND NOT EXISTS (SELECT 1 FROM milestone_issues "
+                  "JOIN issues ON issues.id = milestone_issues.issue_id "
+                  "WHERE milestone_issues.milestone_id = milestones.id "
+                  "AND ") +
+          kStatusKeySql + " <> 'done')",
+      nullptr);
 }
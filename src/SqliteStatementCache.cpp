@@ -0,0 +1,111 @@
+#include "SqliteStatementCache.hpp"
+
+#include <stdexcept>
+#include <string>
+
+SqliteStatementCache::Lease::Lease(Lease&& other) noexcept
+    : stmt_(other.stmt_), inUse_(other.inUse_) {
+  other.stmt_ = nullptr;
+  other.inUse_ = nullptr;
+}
+
+SqliteStatementCache::Lease::~Lease() {
+  if (stmt_ == nullptr) {
+    return;
+  }
+  if (inUse_ == nullptr) {
+    sqlite3_finalize(stmt_);
+    return;
+  }
+  // Reset so the statement releases any read transaction it holds and
+  // the next lease does not see stale bindings.
+  sqlite3_reset(stmt_);
+  sqlite3_clear_bindings(stmt_);
+  *inUse_ = false;
+}
+
+SqliteStatementCache::SqliteStatementCache(sqlite3* db,
+                                           std::size_t capacity)
+    : db_(db), capacity_(capacity), hits_(0), misses_(0), size_(0) {}
+
+SqliteStatementCache::~SqliteStatementCache() {
+  for (auto& [sql, entry] : entries_) {
+    sqlite3_finalize(entry.stmt);
+  }
+}
+
+sqlite3_stmt* SqliteStatementCache::prepare(const std::string& sql) const {
+  sqlite3_stmt* stmt = nullptr;
+  if (sqlite3_prepare_v3(db_, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT,
+                         &stmt, nullptr) != SQLITE_OK) {
+    throw std::runtime_error(sqlite3_errmsg(db_));
+  }
+  return stmt;
+}
+
+SqliteStatementCache::Lease SqliteStatementCache::acquire(
+    const std::string& sql) {
+  auto it = entries_.find(sql);
+  if (it != entries_.end()) {
+    recent_.splice(recent_.begin(), recent_, it->second.recent);
+    if (!it->second.inUse) {
+      ++hits_;
+      it->second.inUse = true;
+      return Lease(it->second.stmt, &it->second.inUse);
+    }
+    // Same SQL already running further up the stack.
+    ++misses_;
+    return Lease(prepare(sql), nullptr);
+  }
+
+  ++misses_;
+  sqlite3_stmt* stmt = prepare(sql);
+  if (entries_.size() >= capacity_ && !evictOne()) {
+    return Lease(stmt, nullptr);
+  }
+  // unordered_map never moves its nodes, so &entry.inUse and the key
+  // pointer in recent_ stay valid.
+  auto inserted = entries_.emplace(sql, Entry()).first;
+  Entry& entry = inserted->second;
+  entry.stmt = stmt;
+  entry.inUse = true;
+  entry.recent = recent_.insert(recent_.begin(), &inserted->first);
+  ++size_;
+  return Lease(stmt, &entry.inUse);
+}
+
+bool SqliteStatementCache::evictOne() {
+  for (auto key = recent_.rbegin(); key != recent_.rend(); ++key) {
+    auto it = entries_.find(**key);
+    if (it->second.inUse) {
+      continue;
+    }
+    sqlite3_finalize(it->second.stmt);
+    recent_.erase(it->second.recent);
+    entries_.erase(it);
+    --size_;
+    return true;
+  }
+  return false;
+}
+
+SqliteStatementCache::Stats SqliteStatementCache::stats() const {
+  Stats stats;
+  stats.hits = hits_.load();
+  stats.misses = misses_.load();
+  stats.size = size_.load();
+  return stats;
+}
+
+void SqliteStatementCache::clear() {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.inUse) {
+      ++it;
+      continue;
+    }
+    sqlite3_finalize(it->second.stmt);
+    recent_.erase(it->second.recent);
+    it = entries_.erase(it);
+    --size_;
+  }
+}
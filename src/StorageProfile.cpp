@@ -0,0 +1,185 @@
+#include "StorageProfile.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+std::string trim(const std::string& text) {
+  const auto notSpace = [](unsigned char c) { return !std::isspace(c); };
+  auto begin = std::find_if(text.begin(), text.end(), notSpace);
+  auto end = std::find_if(text.rbegin(), text.rend(), notSpace).base();
+  return begin < end ? std::string(begin, end) : std::string();
+}
+
+std::string toUpperCopy(std::string value) {
+  std::transform(
+      value.begin(), value.end(), value.begin(),
+      [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+  return value;
+}
+
+std::int64_t parseInteger(const std::string& key, const std::string& value) {
+  std::size_t used = 0;
+  std::int64_t parsed = 0;
+  try {
+    parsed = std::stoll(value, &used);
+  } catch (const std::exception&) {
+    used = 0;
+  }
+  if (used == 0 || used != value.size()) {
+    throw std::invalid_argument("storage setting " + key +
+                                " must be an integer: " + value);
+  }
+  return parsed;
+}
+
+// Upper-cased value if it is one of the allowed keywords. The keywords
+// are spliced into PRAGMA statements, so nothing else may pass.
+std::string parseKeyword(const std::string& key, const std::string& value,
+                         std::initializer_list<const char*> allowed) {
+  const std::string upper = toUpperCopy(value);
+  for (const char* keyword : allowed) {
+    if (upper == keyword) {
+      return upper;
+    }
+  }
+  throw std::invalid_argument("storage setting " + key +
+                              " has an unknown value: " + value);
+}
+
+// Settings in storage.conf, in file order; none when it is missing.
+std::vector<std::pair<std::string, std::string>> readConfigFile(
+    const std::filesystem::path& path) {
+  std::vector<std::pair<std::string, std::string>> settings;
+  std::ifstream in(path);
+  std::string line;
+  while (std::getline(in, line)) {
+    line = trim(line.substr(0, line.find('#')));
+    if (line.empty()) {
+      continue;
+    }
+    const std::size_t equals = line.find('=');
+    if (equals == std::string::npos) {
+      throw std::invalid_argument("malformed line in " + path.string() +
+                                  ": " + line);
+    }
+    settings.emplace_back(trim(line.substr(0, equals)),
+                          trim(line.substr(equals + 1)));
+  }
+  return settings;
+}
+}  // namespace
+
+StorageProfile StorageProfile::preset(const std::string& name) {
+  StorageProfile profile;
+  const std::string upper = toUpperCopy(name);
+  if (upper == "DURABLE") {
+    return profile;
+  }
+  if (upper == "BALANCED") {
+    profile.name = "balanced";
+    profile.mmapSize = 64LL << 20;
+    profile.cacheSize = -16384;
+    profile.synchronous = "NORMAL";
+    profile.tempStore = "MEMORY";
+    return profile;
+  }
+  if (upper == "THROUGHPUT") {
+    profile.name = "throughput";
+    profile.mmapSize = 256LL << 20;
+    profile.cacheSize = -65536;
+    profile.synchronous = "OFF";
+    profile.tempStore = "MEMORY";
+    profile.busyTimeoutMs = 10000;
+    profile.writeBatch = 64;
+    return profile;
+  }
+  throw std::invalid_argument("unknown storage profile: " + name);
+}
+
+void StorageProfile::set(const std::string& key, const std::string& value) {
+  if (key == "mmap_size") {
+    mmapSize = parseInteger(key, value);
+    if (mmapSize < 0) {
+      throw std::invalid_argument("storage setting mmap_size is negative");
+    }
+  } else if (key == "cache_size") {
+    cacheSize = parseInteger(key, value);
+  } else if (key == "synchronous") {
+    synchronous = parseKeyword(key, value, {"OFF", "NORMAL", "FULL", "EXTRA"});
+  } else if (key == "temp_store") {
+    tempStore = parseKeyword(key, value, {"DEFAULT", "FILE", "MEMORY"});
+  } else if (key == "busy_timeout") {
+    const std::int64_t timeout = parseInteger(key, value);
+    if (timeout < 0 || timeout > 3600000) {
+      throw std::invalid_argument(
+          "storage setting busy_timeout is out of range");
+    }
+    busyTimeoutMs = static_cast<int>(timeout);
+  } else if (key == "write_batch") {
+    const std::int64_t batch = parseInteger(key, value);
+    if (batch < 0 || batch > 100000) {
+      throw std::invalid_argument(
+          "storage setting write_batch is out of range");
+    }
+    writeBatch = static_cast<std::size_t>(batch);
+  } else if (key == "write_batch_delay_us") {
+    writeBatchDelayUs = parseInteger(key, value);
+    if (writeBatchDelayUs < 0 || writeBatchDelayUs > 1000000) {
+      throw std::invalid_argument(
+          "storage setting write_batch_delay_us is out of range");
+    }
+  } else {
+    throw std::invalid_argument("unknown storage setting: " + key);
+  }
+}
+
+StorageProfile StorageProfile::load(const std::string& dbPath) {
+  std::filesystem::path directory =
+      std::filesystem::path(dbPath).parent_path();
+  if (directory.empty()) {
+    directory = ".";
+  }
+  auto settings = readConfigFile(directory / "storage.conf");
+
+  std::string presetName = "durable";
+  for (const auto& setting : settings) {
+    if (setting.first == "profile") {
+      presetName = setting.second;
+    }
+  }
+  if (const char* env = std::getenv("ISSUE_DB_PROFILE")) {
+    presetName = env;
+  }
+
+  StorageProfile profile = preset(presetName);
+  for (const auto& setting : settings) {
+    if (setting.first != "profile") {
+      profile.set(setting.first, setting.second);
+    }
+  }
+
+  const std::pair<const char*, const char*> overrides[] = {
+      {"ISSUE_DB_MMAP_SIZE", "mmap_size"},
+      {"ISSUE_DB_CACHE_SIZE", "cache_size"},
+      {"ISSUE_DB_SYNCHRONOUS", "synchronous"},
+      {"ISSUE_DB_TEMP_STORE", "temp_store"},
+      {"ISSUE_DB_BUSY_TIMEOUT", "busy_timeout"},
+      {"ISSUE_DB_WRITE_BATCH", "write_batch"},
+      {"ISSUE_DB_WRITE_BATCH_DELAY_US", "write_batch_delay_us"},
+  };
+  for (const auto& entry : overrides) {
+    if (const char* env = std::getenv(entry.first)) {
+      profile.set(entry.second, env);
+    }
+  }
+  return profile;
+}
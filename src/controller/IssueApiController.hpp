@@ -3,27 +3,43 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
 #include <memory>
 #include <optional>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "Comment.hpp"
 #include "CommentDto.hpp"
+#include "CommentPage.hpp"
 #include "DatabaseDto.hpp"
 #include "ErrorDto.hpp"
+#include "ExportDto.hpp"
 #include "Issue.hpp"
 #include "IssueDto.hpp"
+#include "IssueQuery.hpp"
+#include "IssueSearch.hpp"
+#include "IssueStats.hpp"
+#include "IssueSummary.hpp"
 #include "Milestone.hpp"
 #include "MilestoneDto.hpp"
+#include "SearchDto.hpp"
 #include "TagDto.hpp"
 #include "User.hpp"
 #include "UserDto.hpp"
 #include "UserRoles.hpp"
 
 #include "oatpp/core/Types.hpp"
+#include "oatpp/core/data/stream/Stream.hpp"
 #include "oatpp/core/macro/codegen.hpp"
+#include "oatpp/web/protocol/http/outgoing/StreamingBody.hpp"
 #include "oatpp/web/server/api/ApiController.hpp"
 
 #include "service/DatabaseService.hpp"
@@ -46,7 +62,11 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
     return std::optional<std::string>(*value);
   }
 
-  IssueService& issues() const { return dbService->getIssueService(); }
+  // Handlers that make several calls take one handle up front so a
+  // concurrent database switch cannot split a request across databases.
+  std::shared_ptr<IssueService> issues() const {
+    return dbService->getIssueService();
+  }
 
   static std::string withDbExtension(const std::string& name) {
     if (name.size() >= 3 && name.substr(name.size() - 3) == ".db") {
@@ -94,6 +114,611 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
     return raw;
   }
 
+  static std::vector<std::string> splitTags(const std::string& csv) {
+    std::vector<std::string> tags;
+    std::istringstream iss(csv);
+    std::string tag;
+    while (std::getline(iss, tag, ',')) {
+      tag.erase(0, tag.find_first_not_of(" \t"));
+      tag.erase(tag.find_last_not_of(" \t") + 1);
+      if (!tag.empty()) {
+        tags.push_back(tag);
+      }
+    }
+    return tags;
+  }
+
+  static bool parseInt64(const std::string& raw, std::int64_t* value) {
+    try {
+      std::size_t used = 0;
+      *value = std::stoll(raw, &used);
+      return used == raw.size();
+    } catch (const std::exception&) {
+      return false;
+    }
+  }
+
+  // Builds an IssueQuery from the optional filter parameters of
+  // GET /issues. Returns the offending parameter name on bad input.
+  static std::optional<std::string> parseIssueQuery(
+      const std::shared_ptr<IncomingRequest>& request, IssueQuery* query) {
+    auto text = [&](const char* name) {
+      return asOptionalStdString(request->getQueryParameter(name));
+    };
+    if (auto status = text("status")) {
+      query->status = canonicalStatusLabel(*status);
+    }
+    query->assignee = text("assignee");
+    query->author = text("author");
+    if (auto tags = text("tags")) {
+      query->tagsAny = splitTags(*tags);
+    }
+    if (auto tags = text("tags_all")) {
+      query->tagsAll = splitTags(*tags);
+    }
+    if (auto unassigned = text("unassigned")) {
+      query->unassignedOnly = *unassigned == "true" || *unassigned == "1";
+    }
+    const std::pair<const char*, std::optional<Issue::TimePoint>*> ranges[] =
+        {{"created_from", &query->createdFrom},
+         {"created_to", &query->createdTo}};
+    for (const auto& [name, target] : ranges) {
+      if (auto raw = text(name)) {
+        std::int64_t value = 0;
+        if (!parseInt64(*raw, &value)) {
+          return std::string(name);
+        }
+        *target = value;
+      }
+    }
+    if (auto raw = text("milestone")) {
+      std::int64_t value = 0;
+      if (!parseInt64(*raw, &value)) {
+        return std::string("milestone");
+      }
+      query->milestoneId = static_cast<int>(value);
+    }
+    return std::nullopt;
+  }
+
+  // Page size used when a client sends a cursor without a limit, and the
+  // largest limit accepted.
+  static constexpr std::size_t kDefaultPageSize = 50;
+  static constexpr std::size_t kMaxPageSize = 500;
+  static constexpr std::size_t kDefaultDigestComments = 10;
+
+  // Reads the limit/cursor/sort paging parameters shared by the issue list
+  // endpoints. *page stays empty when neither limit nor cursor is given.
+  // Returns the offending parameter name on bad input.
+  static std::optional<std::string> parsePageRequest(
+      const std::shared_ptr<IncomingRequest>& request,
+      std::optional<IssuePageRequest>* page) {
+    auto text = [&](const char* name) {
+      return asOptionalStdString(request->getQueryParameter(name));
+    };
+    const auto limit = text("limit");
+    const auto cursor = text("cursor");
+    if (!limit && !cursor) {
+      return std::nullopt;
+    }
+
+    IssuePageRequest parsed;
+    parsed.limit = kDefaultPageSize;
+    if (limit) {
+      std::int64_t value = 0;
+      if (!parseInt64(*limit, &value) || value < 1 ||
+          value > static_cast<std::int64_t>(kMaxPageSize)) {
+        return std::string("limit");
+      }
+      parsed.limit = static_cast<std::size_t>(value);
+    }
+    if (auto sort = text("sort")) {
+      if (*sort == "created_at") {
+        parsed.sort = IssueSort::kCreatedAt;
+      } else if (*sort != "id") {
+        return std::string("sort");
+      }
+    }
+    if (cursor) {
+      parsed.after = IssueCursor::decode(*cursor);
+      if (!parsed.after || parsed.after->sort != parsed.sort) {
+        return std::string("cursor");
+      }
+    }
+    *page = parsed;
+    return std::nullopt;
+  }
+
+  // Responds with the issues of a list endpoint. Paged requests get one
+  // keyset page and, if more follow, the cursor for the next one in the
+  // X-Next-Cursor header, so the body keeps the plain list shape.
+  // view=summary lists IssueSummaryDto objects instead of full issues.
+  std::shared_ptr<OutgoingResponse> issueListResponse(
+      const std::shared_ptr<IncomingRequest>& request,
+      const std::shared_ptr<IssueService>& service,
+      const IssueQuery& query,
+      const std::function<std::vector<Issue>()>& unpaged) {
+    std::optional<IssuePageRequest> page;
+    if (auto bad = parsePageRequest(request, &page)) {
+      return error(Status::CODE_400,
+                   "INVALID_PAGE",
+                   "Malformed value for '" + *bad + "'");
+    }
+
+    const auto view =
+        asOptionalStdString(request->getQueryParameter("view"));
+    if (view && *view == "summary") {
+      return summaryListResponse(service, query, page);
+    }
+    if (view && *view != "full") {
+      return error(Status::CODE_400,
+                   "INVALID_VIEW",
+                   "view must be 'full' or 'summary'");
+    }
+
+    auto list = oatpp::List<oatpp::Object<IssueDto>>::createShared();
+    if (!page) {
+      for (const auto& issue : unpaged()) {
+        list->push_back(issueToDto(issue));
+      }
+      return createDtoResponse(Status::CODE_200, list);
+    }
+
+    IssuePage result = service->findIssuePage(query, *page);
+    for (const auto& issue : result.issues) {
+      list->push_back(issueToDto(issue));
+    }
+    return withNextCursor(createDtoResponse(Status::CODE_200, list),
+                          result.next);
+  }
+
+  std::shared_ptr<OutgoingResponse> summaryListResponse(
+      const std::shared_ptr<IssueService>& service,
+      const IssueQuery& query,
+      const std::optional<IssuePageRequest>& page) {
+    auto list = oatpp::List<oatpp::Object<IssueSummaryDto>>::createShared();
+    if (!page) {
+      for (const auto& summary : service->findIssueSummaries(query)) {
+        list->push_back(summaryToDto(summary));
+      }
+      return createDtoResponse(Status::CODE_200, list);
+    }
+
+    IssueSummaryPage result = service->findIssueSummaryPage(query, *page);
+    for (const auto& summary : result.summaries) {
+      list->push_back(summaryToDto(summary));
+    }
+    return withNextCursor(createDtoResponse(Status::CODE_200, list),
+                          result.next);
+  }
+
+  static std::shared_ptr<OutgoingResponse> withNextCursor(
+      std::shared_ptr<OutgoingResponse> response,
+      const std::optional<IssueCursor>& next) {
+    if (next) {
+      response->putHeader("X-Next-Cursor", next->encode().c_str());
+    }
+    return response;
+  }
+
+  // Receives a POST /import body as it streams in, splits it into NDJSON
+  // lines and imports the records kImportBatch at a time, each batch in
+  // one transaction, so memory stays bounded by a batch whatever the body
+  // size. The first bad line, or a batch the database fails to store,
+  // stops the import (earlier batches stay committed) and the rest of the
+  // body is drained unread.
+  class ImportSink : public oatpp::data::stream::WriteCallback {
+   public:
+    static constexpr std::size_t kImportBatch = 1000;
+    static constexpr std::size_t kMaxLineBytes = 16 << 20;
+
+    ImportSink(std::shared_ptr<IssueService> service,
+               std::shared_ptr<oatpp::data::mapping::ObjectMapper> mapper)
+        : service_(std::move(service)), mapper_(std::move(mapper)) {
+      batch_.reserve(kImportBatch);
+    }
+
+    oatpp::v_io_size write(const void* data, v_buff_size count,
+                           oatpp::async::Action& action) override {
+      (void)action;
+      const char* next = static_cast<const char*>(data);
+      const char* end = next + count;
+      while (next < end && error_.empty()) {
+        const char* newline = std::find(next, end, '\n');
+        line_.append(next, newline);
+        if (newline == end) {
+          break;
+        }
+        next = newline + 1;
+        takeLine();
+      }
+      if (error_.empty() && line_.size() > kMaxLineBytes) {
+        fail("line " + std::to_string(lineNumber_ + 1) + " is too long");
+      }
+      return count;
+    }
+
+    // Takes a last line without a newline and imports the partial batch.
+    void finish() {
+      if (error_.empty()) {
+        takeLine();
+      }
+      if (error_.empty()) {
+        flush();
+      }
+    }
+
+    const std::string& error() const { return error_; }
+    // Whether error() is the database's fault rather than the body's.
+    bool storageFailed() const { return storageFailed_; }
+    std::int64_t imported() const { return imported_; }
+    std::int64_t batches() const { return batches_; }
+
+   private:
+    void takeLine() {
+      ++lineNumber_;
+      const auto notSpace = [](unsigned char c) { return !std::isspace(c); };
+      const bool blank =
+          std::find_if(line_.begin(), line_.end(), notSpace) == line_.end();
+      if (!blank) {
+        try {
+          batch_.push_back(toIssue(
+              mapper_->readFromString<oatpp::Object<IssueImportDto>>(
+                  oatpp::String(line_))));
+        } catch (const std::exception& ex) {
+          fail("line " + std::to_string(lineNumber_) + ": " + ex.what());
+        }
+      }
+      line_.clear();
+      if (error_.empty() && batch_.size() == kImportBatch) {
+        flush();
+      }
+    }
+
+    void flush() {
+      if (batch_.empty()) {
+        return;
+      }
+      try {
+        service_->importIssues(batch_);
+      } catch (const std::invalid_argument& ex) {
+        fail("batch ending at line " + std::to_string(lineNumber_) + ": " +
+             ex.what());
+        return;
+      } catch (const std::exception& ex) {
+        storageFailed_ = true;
+        fail("batch ending at line " + std::to_string(lineNumber_) + ": " +
+             ex.what());
+        return;
+      }
+      imported_ += static_cast<std::int64_t>(batch_.size());
+      ++batches_;
+      batch_.clear();
+    }
+
+    void fail(const std::string& message) {
+      error_ = message;
+      batch_.clear();
+      line_.clear();
+    }
+
+    static Issue toIssue(const oatpp::Object<IssueImportDto>& dto) {
+      if (!dto || !dto->title || !dto->authorId) {
+        throw std::invalid_argument("title and author_id are required");
+      }
+      const std::int64_t createdAt = dto->createdAt ? *dto->createdAt : 0;
+      if (createdAt < 0) {
+        throw std::invalid_argument("created_at must not be negative");
+      }
+      Issue issue(0, asStdString(dto->authorId), asStdString(dto->title),
+                  createdAt);
+      if (dto->status) {
+        issue.setStatus(canonicalStatusLabel(*dto->status));
+      }
+      issue.assignTo(asStdString(dto->assignedTo));
+
+      int commentId = 0;
+      const std::string description = asStdString(dto->description);
+      if (!description.empty()) {
+        issue.addComment(
+            Comment(commentId++, issue.getAuthorId(), description, createdAt));
+        issue.setDescriptionCommentId(0);
+      }
+      if (dto->comments) {
+        for (const auto& comment : *dto->comments) {
+          if (!comment) {
+            throw std::invalid_argument("comment must be an object");
+          }
+          issue.addComment(Comment(
+              commentId++, asStdString(comment->authorId),
+              asStdString(comment->text),
+              comment->timestamp ? *comment->timestamp : 0));
+        }
+      }
+      if (dto->tags) {
+        for (const auto& tag : *dto->tags) {
+          if (!tag || asStdString(tag->tag).empty()) {
+            throw std::invalid_argument("tag name is required");
+          }
+          issue.addTag(Tag(asStdString(tag->tag), asStdString(tag->color)));
+        }
+      }
+      return issue;
+    }
+
+    std::shared_ptr<IssueService> service_;
+    std::shared_ptr<oatpp::data::mapping::ObjectMapper> mapper_;
+    std::vector<Issue> batch_;
+    std::string line_;
+    std::size_t lineNumber_{0};
+    std::int64_t imported_{0};
+    std::int64_t batches_{0};
+    std::string error_;
+    bool storageFailed_{false};
+  };
+
+  // Produces a GET /export body as the response is written: each read()
+  // formats only as many records as fit the chunk being sent, so memory
+  // stays bounded by a record whatever the database size. Everything is
+  // read from one snapshot, opened on the first read() on the connection's
+  // thread and released there as soon as the export is complete, so a
+  // long export never holds up writers (beyond the writer connection it
+  // pins on an in-memory database).
+  //
+  // NDJSON is users, milestones, then issues (with comments and tags), one
+  // typed record per line. CSV is a section per table, each a title line
+  // and a header row, separated by blank lines; the comments and
+  // issue_tags sections take further passes over the same snapshot.
+  class ExportSource : public oatpp::data::stream::ReadCallback {
+   public:
+    enum class Format { kNdjson, kCsv };
+
+    ExportSource(std::shared_ptr<IssueService> service,
+                 std::shared_ptr<oatpp::data::mapping::ObjectMapper> mapper,
+                 Format format)
+        : service_(std::move(service)),
+          mapper_(std::move(mapper)),
+          format_(format) {}
+
+    oatpp::v_io_size read(void* buffer, v_buff_size count,
+                          oatpp::async::Action& action) override {
+      (void)action;
+      const auto wanted = static_cast<std::size_t>(count);
+      while (pending_.size() - sent_ < wanted && fill()) {
+      }
+      const std::size_t size = std::min(pending_.size() - sent_, wanted);
+      std::copy_n(pending_.data() + sent_, size, static_cast<char*>(buffer));
+      sent_ += size;
+      if (sent_ == pending_.size()) {
+        pending_.clear();
+        sent_ = 0;
+      }
+      return static_cast<oatpp::v_io_size>(size);
+    }
+
+   private:
+    enum class Section { kStart, kUsers, kMilestones, kIssues, kComments,
+                         kTags, kDone };
+
+    // Appends the next record (or section heading) to pending_; false once
+    // the export is complete.
+    bool fill() {
+      const bool csv = format_ == Format::kCsv;
+      switch (section_) {
+        case Section::kStart:
+          if (auto opened = service_->openExport()) {
+            snapshot_.emplace(std::move(*opened));
+          }
+          begin(snapshot_ ? Section::kUsers : Section::kDone);
+          return true;
+        case Section::kUsers:
+          if (index_ < snapshot_->users().size()) {
+            writeUser(snapshot_->users()[index_++]);
+          } else {
+            begin(Section::kMilestones);
+          }
+          return true;
+        case Section::kMilestones:
+          if (index_ < snapshot_->milestones().size()) {
+            writeMilestone(snapshot_->milestones()[index_++]);
+          } else {
+            begin(Section::kIssues);
+          }
+          return true;
+        case Section::kIssues:
+          if (stream_->next(&issue_)) {
+            writeIssue();
+          } else {
+            begin(csv ? Section::kComments : Section::kDone);
+          }
+          return true;
+        case Section::kComments:
+          if (stream_->next(&issue_)) {
+            for (const Comment& c : issue_.getComments()) {
+              writeCsvRow({std::to_string(issue_.getId()),
+                           std::to_string(c.getId()), c.getAuthor(),
+                           c.getText(), std::to_string(c.getTimeStamp())});
+            }
+          } else {
+            begin(Section::kTags);
+          }
+          return true;
+        case Section::kTags:
+          if (stream_->next(&issue_)) {
+            for (const Tag& t : issue_.getTags()) {
+              writeCsvRow({std::to_string(issue_.getId()), t.getName(),
+                           t.getColor()});
+            }
+          } else {
+            begin(Section::kDone);
+          }
+          return true;
+        case Section::kDone:
+          return false;
+      }
+      return false;
+    }
+
+    void begin(Section section) {
+      section_ = section;
+      index_ = 0;
+      stream_.reset();
+      if (section == Section::kDone) {
+        snapshot_.reset();
+        return;
+      }
+      if (section >= Section::kIssues) {
+        stream_.emplace(snapshot_->issues());
+      }
+      if (format_ != Format::kCsv) {
+        return;
+      }
+      if (section != Section::kUsers) {
+        pending_ += '\n';
+      }
+      switch (section) {
+        case Section::kUsers:
+          pending_ += "users\nname,role\n";
+          break;
+        case Section::kMilestones:
+          pending_ += "milestones\n"
+                      "id,name,description,start_date,end_date,issue_ids\n";
+          break;
+        case Section::kIssues:
+          pending_ += "issues\n"
+                      "id,title,author_id,assigned_to,status,created_at,"
+                      "description_comment_id\n";
+          break;
+        case Section::kComments:
+          pending_ += "comments\nissue_id,id,author_id,text,timestamp\n";
+          break;
+        case Section::kTags:
+          pending_ += "issue_tags\nissue_id,tag,color\n";
+          break;
+        default:
+          break;
+      }
+    }
+
+    void writeUser(const User& u) {
+      if (format_ == Format::kCsv) {
+        writeCsvRow({u.getName(), u.getRole()});
+        return;
+      }
+      auto dto = ExportUserDto::createShared();
+      dto->type = "user";
+      dto->name = u.getName().c_str();
+      dto->role = u.getRole().c_str();
+      writeJsonLine(dto);
+    }
+
+    void writeMilestone(const Milestone& m) {
+      if (format_ == Format::kCsv) {
+        std::string issueIds;
+        for (int id : m.getIssueIds()) {
+          issueIds += (issueIds.empty() ? "" : " ") + std::to_string(id);
+        }
+        writeCsvRow({std::to_string(m.getId()), m.getName(),
+                     m.getDescription(), m.getStartDate(), m.getEndDate(),
+                     issueIds});
+        return;
+      }
+      auto dto = ExportMilestoneDto::createShared();
+      dto->type = "milestone";
+      dto->id = m.getId();
+      dto->name = m.getName().c_str();
+      dto->description = m.getDescription().c_str();
+      dto->startDate = m.getStartDate().c_str();
+      dto->endDate = m.getEndDate().c_str();
+      dto->issueIds = oatpp::List<oatpp::Int32>::createShared();
+      for (int id : m.getIssueIds()) {
+        dto->issueIds->push_back(id);
+      }
+      writeJsonLine(dto);
+    }
+
+    void writeIssue() {
+      const Issue& i = issue_;
+      if (format_ == Format::kCsv) {
+        writeCsvRow({std::to_string(i.getId()), i.getTitle(),
+                     i.getAuthorId(), i.getAssignedTo(), i.getStatus(),
+                     std::to_string(i.getCreatedAt()),
+                     i.hasDescriptionComment()
+                         ? std::to_string(i.getDescriptionCommentId())
+                         : std::string()});
+        return;
+      }
+      auto dto = ExportIssueDto::createShared();
+      dto->type = "issue";
+      dto->id = i.getId();
+      dto->title = i.getTitle().c_str();
+      dto->description = i.hasDescriptionComment()
+                             ? i.getDescriptionComment().c_str()
+                             : "";
+      dto->authorId = i.getAuthorId().c_str();
+      dto->assignedTo = i.getAssignedTo().c_str();
+      dto->status = i.getStatus().c_str();
+      dto->createdAt = i.getCreatedAt();
+      dto->comments = oatpp::List<oatpp::Object<CommentDto>>::createShared();
+      for (const Comment& c : i.getComments()) {
+        if (!i.hasDescriptionComment() ||
+            c.getId() != i.getDescriptionCommentId()) {
+          dto->comments->push_back(commentToDto(c));
+        }
+      }
+      dto->tags = oatpp::List<oatpp::Object<TagDto>>::createShared();
+      for (const Tag& t : i.getTags()) {
+        auto tag = TagDto::createShared();
+        tag->tag = t.getName().c_str();
+        tag->color = t.getColor().c_str();
+        dto->tags->push_back(tag);
+      }
+      writeJsonLine(dto);
+    }
+
+    template <typename Dto>
+    void writeJsonLine(const Dto& dto) {
+      pending_ += *mapper_->writeToString(dto);
+      pending_ += '\n';
+    }
+
+    // RFC 4180: fields holding a separator, quote or line break are
+    // quoted, with quotes doubled.
+    void writeCsvRow(const std::vector<std::string>& fields) {
+      for (std::size_t f = 0; f < fields.size(); ++f) {
+        if (f > 0) {
+          pending_ += ',';
+        }
+        const std::string& field = fields[f];
+        if (field.find_first_of(",\"\r\n") == std::string::npos) {
+          pending_ += field;
+          continue;
+        }
+        pending_ += '"';
+        for (char c : field) {
+          pending_ += c;
+          if (c == '"') {
+            pending_ += '"';
+          }
+        }
+        pending_ += '"';
+      }
+      pending_ += '\n';
+    }
+
+    std::shared_ptr<IssueService> service_;
+    std::shared_ptr<oatpp::data::mapping::ObjectMapper> mapper_;
+    const Format format_;
+    Section section_{Section::kStart};
+    std::size_t index_{0};
+    // Declared before the stream, which must be destroyed first.
+    std::optional<SQLiteIssueRepository::ExportSnapshot> snapshot_;
+    std::optional<SQLiteIssueRepository::IssueStream> stream_;
+    Issue issue_;
+    std::string pending_;  // formatted, not yet sent past sent_
+    std::size_t sent_{0};
+  };
+
   std::shared_ptr<OutgoingResponse> error(const Status& status,
                                           const std::string& code,
                                           const std::string& message) {
@@ -145,6 +770,25 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
     return dto;
   }
 
+  static oatpp::Object<IssueSummaryDto> summaryToDto(
+      const IssueSummary& s) {
+    auto dto = IssueSummaryDto::createShared();
+    dto->id = s.id;
+    dto->title = s.title.c_str();
+    dto->status = s.status.c_str();
+    dto->assignedTo = s.assignedTo.c_str();
+    dto->authorId = s.authorId.c_str();
+    dto->createdAt = s.createdAt;
+
+    auto tags = oatpp::List<oatpp::String>::createShared();
+    for (const auto& tag : s.tags) {
+      tags->push_back(tag.c_str());
+    }
+    dto->tags = tags;
+    dto->commentCount = static_cast<std::int32_t>(s.commentCount);
+    return dto;
+  }
+
   static oatpp::Object<CommentDto> commentToDto(const Comment& c) {
     auto dto = CommentDto::createShared();
     dto->id = c.getId();
@@ -154,6 +798,32 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
     return dto;
   }
 
+  static oatpp::Object<IssueDigestDto> digestToDto(const IssueDigest& d) {
+    const IssueSummary& s = d.summary;
+    auto dto = IssueDigestDto::createShared();
+    dto->id = s.id;
+    dto->title = s.title.c_str();
+    dto->description = d.description ? d.description->getText().c_str() : "";
+    dto->status = s.status.c_str();
+    dto->assignedTo = s.assignedTo.c_str();
+    dto->authorId = s.authorId.c_str();
+    dto->createdAt = s.createdAt;
+
+    auto tags = oatpp::List<oatpp::String>::createShared();
+    for (const auto& tag : s.tags) {
+      tags->push_back(tag.c_str());
+    }
+    dto->tags = tags;
+    dto->commentCount = static_cast<std::int32_t>(s.commentCount);
+
+    auto comments = oatpp::List<oatpp::Object<CommentDto>>::createShared();
+    for (const auto& c : d.latestComments) {
+      comments->push_back(commentToDto(c));
+    }
+    dto->latestComments = comments;
+    return dto;
+  }
+
   static oatpp::Object<UserDto> userToDto(const User& u) {
     auto dto = UserDto::createShared();
     dto->name = u.getName().c_str();
@@ -161,6 +831,24 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
     return dto;
   }
 
+  static oatpp::Fields<oatpp::Int64> countFields(
+      const std::map<std::string, std::size_t>& groups) {
+    auto fields = oatpp::Fields<oatpp::Int64>::createShared();
+    for (const auto& [key, count] : groups) {
+      fields->push_back({key.c_str(), static_cast<std::int64_t>(count)});
+    }
+    return fields;
+  }
+
+  static oatpp::List<oatpp::Object<MilestoneDto>> milestonesToDto(
+      const std::vector<Milestone>& list) {
+    auto dtoList = oatpp::List<oatpp::Object<MilestoneDto>>::createShared();
+    for (const auto& m : list) {
+      dtoList->push_back(milestoneToDto(m));
+    }
+    return dtoList;
+  }
+
   static oatpp::Object<MilestoneDto> milestoneToDto(const Milestone& m) {
     auto dto = MilestoneDto::createShared();
     dto->id = m.getId();
@@ -197,7 +885,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
                    "title and authorId are required");
     }
 
-    Issue i = issues().createIssue(
+    Issue i = issues()->createIssue(
         asStdString(body->title),
         asStdString(body->description),
         asStdString(body->authorId));
@@ -209,50 +897,222 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
     return createDtoResponse(Status::CODE_201, issueToDto(i));
   }
 
+  ENDPOINT_INFO(importIssues) {
+    info->summary = "Bulk import issues from newline-delimited JSON";
+    info->addConsumes<Object<IssueImportDto>>("application/x-ndjson");
+    info->addResponse<Object<ImportResultDto>>(Status::CODE_201,
+                                               "application/json");
+    info->addResponse<Object<ErrorDto>>(
+        Status::CODE_400,
+        "application/json",
+        "Malformed or invalid record; earlier batches stay imported");
+    info->addResponse<Object<ErrorDto>>(
+        Status::CODE_500,
+        "application/json",
+        "A batch failed to store; earlier batches stay imported");
+  }
+
+  // The body is read as it arrives, never buffered whole; every
+  // ImportSink::kImportBatch records commit in one transaction.
+  ENDPOINT("POST", "/import", importIssues,
+           REQUEST(std::shared_ptr<IncomingRequest>, request)) {
+    ImportSink sink(issues(), getDefaultObjectMapper());
+    request->transferBody(&sink);
+    sink.finish();
+    if (sink.storageFailed()) {
+      return error(Status::CODE_500,
+                   "IMPORT_FAILED",
+                   sink.error() + " (" + std::to_string(sink.imported()) +
+                       " issues imported before it)");
+    }
+    if (!sink.error().empty()) {
+      return error(Status::CODE_400,
+                   "INVALID_RECORD",
+                   sink.error() + " (" + std::to_string(sink.imported()) +
+                       " issues imported before it)");
+    }
+
+    auto dto = ImportResultDto::createShared();
+    dto->imported = sink.imported();
+    dto->batches = sink.batches();
+    return createDtoResponse(Status::CODE_201, dto);
+  }
+
+  ENDPOINT_INFO(exportDatabase) {
+    info->summary = "Export the active database as NDJSON or CSV";
+    info->queryParams.add<String>("format").required = false;
+    info->addResponse<String>(Status::CODE_200, "application/x-ndjson",
+                              "Chunked export; text/csv with format=csv");
+    info->addResponse<Object<ErrorDto>>(Status::CODE_400,
+                                        "application/json",
+                                        "Unknown format");
+  }
+
+  // Sent chunked as ExportSource produces it; see there for the layout.
+  ENDPOINT("GET", "/export", exportDatabase,
+           REQUEST(std::shared_ptr<IncomingRequest>, request)) {
+    const std::string format = asOptionalStdString(
+        request->getQueryParameter("format")).value_or("ndjson");
+    ExportSource::Format parsed;
+    const char* contentType;
+    if (format == "ndjson") {
+      parsed = ExportSource::Format::kNdjson;
+      contentType = "application/x-ndjson";
+    } else if (format == "csv") {
+      parsed = ExportSource::Format::kCsv;
+      contentType = "text/csv";
+    } else {
+      return error(Status::CODE_400,
+                   "INVALID_FORMAT",
+                   "format must be ndjson or csv");
+    }
+
+    auto body =
+        std::make_shared<oatpp::web::protocol::http::outgoing::StreamingBody>(
+            std::make_shared<ExportSource>(issues(), getDefaultObjectMapper(),
+                                           parsed));
+    auto response = OutgoingResponse::createShared(Status::CODE_200, body);
+    response->putHeader("Content-Type", contentType);
+    return response;
+  }
+
   ENDPOINT_INFO(listIssues) {
-    info->summary = "List all issues";
+    info->summary = "List issues, optionally filtered";
+    info->queryParams.add<String>("status").required = false;
+    info->queryParams.add<String>("assignee").required = false;
+    info->queryParams.add<String>("author").required = false;
+    info->queryParams.add<String>("tags").required = false;
+    info->queryParams.add<String>("tags_all").required = false;
+    info->queryParams.add<Int32>("milestone").required = false;
+    info->queryParams.add<Boolean>("unassigned").required = false;
+    info->queryParams.add<Int64>("created_from").required = false;
+    info->queryParams.add<Int64>("created_to").required = false;
+    info->queryParams.add<Int32>("limit").required = false;
+    info->queryParams.add<String>("cursor").required = false;
+    info->queryParams.add<String>("sort").required = false;
+    info->queryParams.add<String>("view").required = false;
     info->addResponse<List<Object<IssueDto>>>(
         Status::CODE_200, "application/json");
+    info->addResponse<Object<ErrorDto>>(Status::CODE_400,
+                                        "application/json",
+                                        "Malformed filter or paging "
+                                        "parameter");
   }
 
-  ENDPOINT("GET", "/issues", listIssues) {
-    auto issueList = issues().listAllIssues();
-    auto list = oatpp::List<oatpp::Object<IssueDto>>::createShared();
-    for (auto& i : issueList) {
-      list->push_back(issueToDto(i));
+  ENDPOINT("GET", "/issues", listIssues,
+           REQUEST(std::shared_ptr<IncomingRequest>, request)) {
+    IssueQuery query;
+    if (auto bad = parseIssueQuery(request, &query)) {
+      return error(Status::CODE_400,
+                   "INVALID_FILTER",
+                   "Malformed value for '" + *bad + "'");
     }
-    return createDtoResponse(Status::CODE_200, list);
+    auto service = issues();
+    return issueListResponse(request, service, query,
+                             [&] { return service->findIssues(query); });
+  }
+
+  ENDPOINT_INFO(getIssueStats) {
+    info->summary = "Count issues by status, assignee and tag";
+    info->queryParams.add<Int32>("milestone").required = false;
+    info->queryParams.add<Int64>("created_from").required = false;
+    info->queryParams.add<Int64>("created_to").required = false;
+    info->addResponse<Object<IssueStatsDto>>(Status::CODE_200,
+                                             "application/json");
+    info->addResponse<Object<ErrorDto>>(Status::CODE_400,
+                                        "application/json",
+                                        "Malformed filter parameter");
+  }
+
+  // Takes the same filters as GET /issues.
+  ENDPOINT("GET", "/issues/stats", getIssueStats,
+           REQUEST(std::shared_ptr<IncomingRequest>, request)) {
+    IssueQuery query;
+    if (auto bad = parseIssueQuery(request, &query)) {
+      return error(Status::CODE_400,
+                   "INVALID_FILTER",
+                   "Malformed value for '" + *bad + "'");
+    }
+    const IssueStats stats = issues()->countIssues(query);
+
+    auto dto = IssueStatsDto::createShared();
+    dto->total = static_cast<std::int64_t>(stats.total);
+    dto->unassigned = static_cast<std::int64_t>(stats.unassigned);
+    dto->byStatus = countFields(stats.byStatus);
+    dto->byAssignee = countFields(stats.byAssignee);
+    dto->byTag = countFields(stats.byTag);
+    return createDtoResponse(Status::CODE_200, dto);
   }
 
   ENDPOINT_INFO(listUnassignedIssues) {
     info->summary = "List all unassigned issues";
+    info->queryParams.add<Int32>("limit").required = false;
+    info->queryParams.add<String>("cursor").required = false;
+    info->queryParams.add<String>("sort").required = false;
+    info->queryParams.add<String>("view").required = false;
     info->addResponse<List<Object<IssueDto>>>(
         Status::CODE_200, "application/json");
+    info->addResponse<Object<ErrorDto>>(Status::CODE_400,
+                                        "application/json",
+                                        "Malformed paging parameter");
   }
 
-  ENDPOINT("GET", "/issues/unassigned", listUnassignedIssues) {
-    auto issueList = issues().listAllUnassignedIssues();
-    auto list = oatpp::List<oatpp::Object<IssueDto>>::createShared();
-
-    for (auto& i : issueList) {
-      list->push_back(issueToDto(i));
-    }
-    return createDtoResponse(Status::CODE_200, list);
+  ENDPOINT("GET", "/issues/unassigned", listUnassignedIssues,
+           REQUEST(std::shared_ptr<IncomingRequest>, request)) {
+    auto service = issues();
+    IssueQuery query;
+    query.unassignedOnly = true;
+    return issueListResponse(request, service, query, [&] {
+      return service->listAllUnassignedIssues();
+    });
   }
 
   ENDPOINT_INFO(getIssue) {
     info->summary = "Get an issue by id";
+    info->queryParams.add<String>("view").required = false;
+    info->queryParams.add<Int32>("comments").required = false;
     info->addResponse<Object<IssueDto>>(Status::CODE_200,
                                         "application/json");
+    info->addResponse<Object<ErrorDto>>(Status::CODE_400,
+                                        "application/json",
+                                        "Unknown view or comment count");
     info->addResponse<Object<ErrorDto>>(Status::CODE_404,
                                         "application/json",
                                         "Issue not found");
   }
 
+  // view=digest answers with the description and only the newest
+  // `comments` comments, so the cost does not grow with the thread.
   ENDPOINT("GET", "/issues/{id}", getIssue,
-           PATH(oatpp::Int32, id)) {
+           PATH(oatpp::Int32, id),
+           REQUEST(std::shared_ptr<IncomingRequest>, request)) {
+    const auto view =
+        asOptionalStdString(request->getQueryParameter("view"));
+    if (view && *view != "full" && *view != "digest") {
+      return error(Status::CODE_400,
+                   "INVALID_VIEW",
+                   "view must be 'full' or 'digest'");
+    }
+    std::size_t latest = kDefaultDigestComments;
+    if (auto raw = asOptionalStdString(
+            request->getQueryParameter("comments"))) {
+      std::int64_t value = 0;
+      if (!parseInt64(*raw, &value) || value < 0 ||
+          value > static_cast<std::int64_t>(kMaxPageSize)) {
+        return error(Status::CODE_400,
+                     "INVALID_PAGE",
+                     "Malformed value for 'comments'");
+      }
+      latest = static_cast<std::size_t>(value);
+    }
+
     try {
-      Issue i = issues().getIssue(id);
+      if (view && *view == "digest") {
+        return createDtoResponse(
+            Status::CODE_200,
+            digestToDto(issues()->getIssueDigest(id, latest)));
+      }
+      Issue i = issues()->getIssue(id);
       return createDtoResponse(Status::CODE_200, issueToDto(i));
     } catch (...) {
       return error(Status::CODE_404,
@@ -276,7 +1136,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
   ENDPOINT("PATCH", "/issues/{id}", updateIssue,
            PATH(oatpp::Int32, id),
            BODY_DTO(oatpp::Object<IssueUpdateFieldDto>, body)) {
-    bool ok = issues().updateIssueField(
+    bool ok = issues()->updateIssueField(
         id, asStdString(body->field), asStdString(body->value));
     return ok ? createResponse(Status::CODE_204, "")
               : error(Status::CODE_400,
@@ -296,7 +1156,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
 
   ENDPOINT("DELETE", "/issues/{id}", deleteIssue,
            PATH(oatpp::Int32, id)) {
-    bool ok = issues().deleteIssue(id);
+    bool ok = issues()->deleteIssue(id);
     if (ok) {
       return createResponse(Status::CODE_204, "");
     }
@@ -330,7 +1190,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
                    "text and authorId are required");
     }
 
-    Comment c = issues().addCommentToIssue(
+    Comment c = issues()->addCommentToIssue(
         id,
         asStdString(body->text),
         asStdString(body->authorId));
@@ -345,20 +1205,69 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
 
   ENDPOINT_INFO(listComments) {
     info->summary = "List comments for an issue";
+    info->queryParams.add<Int32>("after").required = false;
+    info->queryParams.add<Int32>("limit").required = false;
     info->addResponse<List<Object<CommentDto>>>(
         Status::CODE_200, "application/json");
+    info->addResponse<Object<ErrorDto>>(Status::CODE_400,
+                                        "application/json",
+                                        "Malformed paging parameter");
     info->addResponse<Object<ErrorDto>>(Status::CODE_404,
                                         "application/json",
                                         "Issue not found");
   }
 
+  // With after or limit the comments come one keyset page at a time; the
+  // id to pass as the next after is in the X-Next-Cursor header.
   ENDPOINT("GET", "/issues/{id}/comments", listComments,
-           PATH(oatpp::Int32, id)) {
+           PATH(oatpp::Int32, id),
+           REQUEST(std::shared_ptr<IncomingRequest>, request)) {
+    const auto after =
+        asOptionalStdString(request->getQueryParameter("after"));
+    const auto limit =
+        asOptionalStdString(request->getQueryParameter("limit"));
+    std::optional<CommentPageRequest> page;
+    if (after || limit) {
+      // The synthetic description comment (id 0) is never listed.
+      page = CommentPageRequest{kDefaultPageSize, 0};
+      std::int64_t value = 0;
+      if (limit) {
+        if (!parseInt64(*limit, &value) || value < 1 ||
+            value > static_cast<std::int64_t>(kMaxPageSize)) {
+          return error(Status::CODE_400,
+                       "INVALID_PAGE",
+                       "Malformed value for 'limit'");
+        }
+        page->limit = static_cast<std::size_t>(value);
+      }
+      if (after) {
+        if (!parseInt64(*after, &value) || value < 0 ||
+            value > std::numeric_limits<std::int32_t>::max()) {
+          return error(Status::CODE_400,
+                       "INVALID_PAGE",
+                       "Malformed value for 'after'");
+        }
+        page->after = static_cast<int>(value);
+      }
+    }
+
     try {
-      auto comments = issues().getAllComments(id);
       auto list =
           oatpp::List<oatpp::Object<CommentDto>>::createShared();
+      if (page) {
+        CommentPage result = issues()->getCommentPage(id, *page);
+        for (auto& c : result.comments) {
+          list->push_back(commentToDto(c));
+        }
+        auto response = createDtoResponse(Status::CODE_200, list);
+        if (result.next) {
+          response->putHeader("X-Next-Cursor",
+                              std::to_string(*result.next).c_str());
+        }
+        return response;
+      }
 
+      auto comments = issues()->getAllComments(id);
       for (auto& c : comments) {
         // Skip the synthetic description comment (id == 0).
         if (c.getId() <= 0) {
@@ -399,7 +1308,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
                    "text is required");
     }
 
-    bool ok = issues().updateComment(
+    bool ok = issues()->updateComment(
         issueId, commentId, asStdString(body->text));
 
     return ok ? createResponse(Status::CODE_204, "")
@@ -422,7 +1331,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
            deleteComment,
            PATH(oatpp::Int32, issueId),
            PATH(oatpp::Int32, commentId)) {
-    bool ok = issues().deleteComment(issueId, commentId);
+    bool ok = issues()->deleteComment(issueId, commentId);
     return ok ? createResponse(Status::CODE_204, "")
               : error(Status::CODE_404,
                       "COMMENT_NOT_FOUND",
@@ -456,7 +1365,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
                    "Invalid name or role");
     }
 
-    User u = issues().createUser(name, role);
+    User u = issues()->createUser(name, role);
 
     return createDtoResponse(Status::CODE_201, userToDto(u));
   }
@@ -468,7 +1377,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
   }
 
   ENDPOINT("GET", "/users", listUsers) {
-    auto usersList = issues().listAllUsers();
+    auto usersList = issues()->listAllUsers();
     auto list = oatpp::List<oatpp::Object<UserDto>>::createShared();
     for (auto& u : usersList) {
       list->push_back(userToDto(u));
@@ -504,7 +1413,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
   ENDPOINT("PATCH", "/users/{id}", updateUser,
            PATH(oatpp::String, id),
            BODY_DTO(oatpp::Object<UserUpdateDto>, body)) {
-    bool ok = issues().updateUser(asStdString(id),
+    bool ok = issues()->updateUser(asStdString(id),
                                   asStdString(body->field),
                                   asStdString(body->value));
     return ok ? createResponse(Status::CODE_204, "")
@@ -525,7 +1434,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
 
   ENDPOINT("DELETE", "/users/{id}", deleteUser,
            PATH(oatpp::String, id)) {
-    bool ok = issues().removeUser(asStdString(id));
+    bool ok = issues()->removeUser(asStdString(id));
     return ok ? createResponse(Status::CODE_204, "")
               : error(Status::CODE_404,
                       "USER_NOT_FOUND",
@@ -534,20 +1443,29 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
 
   ENDPOINT_INFO(listIssuesByUser) {
     info->summary = "List issues created or assigned to a user";
+    info->queryParams.add<Int32>("limit").required = false;
+    info->queryParams.add<String>("cursor").required = false;
+    info->queryParams.add<String>("sort").required = false;
+    info->queryParams.add<String>("view").required = false;
     info->addResponse<List<Object<IssueDto>>>(
         Status::CODE_200, "application/json");
+    info->addResponse<Object<ErrorDto>>(Status::CODE_400,
+                                        "application/json",
+                                        "Malformed paging parameter");
     info->addResponse<Object<ErrorDto>>(Status::CODE_404,
                                         "application/json",
                                         "User not found");
   }
 
   ENDPOINT("GET", "/users/{id}/issues", listIssuesByUser,
-           PATH(oatpp::String, id)) {
+           PATH(oatpp::String, id),
+           REQUEST(std::shared_ptr<IncomingRequest>, request)) {
     std::string input = toLower(asStdString(id));
     std::string realId;
     bool found = false;
+    auto service = issues();
 
-    auto allUsers = issues().listAllUsers();
+    auto allUsers = service->listAllUsers();
     for (const auto& user : allUsers) {
       if (toLower(user.getName()) == input) {
         realId = user.getName();
@@ -562,13 +1480,11 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
                    "User not found");
     }
 
-    auto userIssues = issues().findIssuesByUserId(realId);
-    auto list = oatpp::List<oatpp::Object<IssueDto>>::createShared();
-    for (auto& issue : userIssues) {
-      list->push_back(issueToDto(issue));
-    }
-
-    return createDtoResponse(Status::CODE_200, list);
+    IssueQuery query;
+    query.author = realId;
+    return issueListResponse(request, service, query, [&] {
+      return service->findIssuesByUserId(realId);
+    });
   }
 
   ENDPOINT_INFO(assignUserToIssue) {
@@ -596,8 +1512,9 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
     std::string inputUser = toLower(asStdString(id));
     std::string realUser;
     bool found = false;
+    auto service = issues();
 
-    for (const auto& user : issues().listAllUsers()) {
+    for (const auto& user : service->listAllUsers()) {
       if (toLower(user.getName()) == inputUser) {
         realUser = user.getName();
         found = true;
@@ -611,7 +1528,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
                    "User not found");
     }
 
-    bool ok = issues().assignUserToIssue(body->issueId, realUser);
+    bool ok = service->assignUserToIssue(body->issueId, realUser);
     if (!ok) {
       return error(Status::CODE_404,
                    "ISSUE_NOT_FOUND",
@@ -619,7 +1536,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
     }
 
     try {
-      Issue updated = issues().getIssue(body->issueId);
+      Issue updated = service->getIssue(body->issueId);
       return createDtoResponse(Status::CODE_200, issueToDto(updated));
     } catch (...) {
       return error(Status::CODE_404,
@@ -630,7 +1547,8 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
 
   ENDPOINT("PATCH", "/issues/{issueId}/unassign", unassignIssue,
            PATH(oatpp::Int32, issueId)) {
-    bool ok = issues().unassignUserFromIssue(issueId);
+    auto service = issues();
+    bool ok = service->unassignUserFromIssue(issueId);
 
     if (!ok) {
       return createResponse(
@@ -639,7 +1557,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
     }
 
     try {
-      Issue updated = issues().getIssue(issueId);
+      Issue updated = service->getIssue(issueId);
       return createDtoResponse(Status::CODE_200, issueToDto(updated));
     } catch (...) {
       return createResponse(Status::CODE_500, "Unexpected error");
@@ -678,7 +1596,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
     const std::string color =
         body->color ? asStdString(body->color) : std::string();
 
-    bool ok = issues().addTagToIssue(id, Tag(tag, color));
+    bool ok = issues()->addTagToIssue(id, Tag(tag, color));
 
     return ok ? createResponse(Status::CODE_201, "Tag added")
               : error(Status::CODE_400,
@@ -713,7 +1631,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
                    "Missing tag");
     }
 
-    bool ok = issues().removeTagFromIssue(id, tag);
+    bool ok = issues()->removeTagFromIssue(id, tag);
 
     return ok ? createResponse(Status::CODE_204, "")
               : error(Status::CODE_404,
@@ -733,7 +1651,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
   ENDPOINT("GET", "/issues/{id}/tags", listTags,
            PATH(oatpp::Int32, id)) {
     try {
-      Issue issue = issues().getIssue(id);
+      Issue issue = issues()->getIssue(id);
 
       auto list =
           oatpp::List<oatpp::Object<TagDto>>::createShared();
@@ -760,7 +1678,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
 
   ENDPOINT("GET", "/tags", listAllTags) {
     auto list = oatpp::List<oatpp::Object<TagDto>>::createShared();
-    for (const auto& tag : issues().listAllTags()) {
+    for (const auto& tag : issues()->listAllTags()) {
       auto dto = TagDto::createShared();
       dto->tag = tag.getName().c_str();
       dto->color = tag.getColor().c_str();
@@ -789,7 +1707,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
                    "MISSING_TAG",
                    "Missing tag");
     }
-    bool ok = issues().deleteTagDefinition(asStdString(tag));
+    bool ok = issues()->deleteTagDefinition(asStdString(tag));
     return ok ? createResponse(Status::CODE_204, "Tag deleted")
               : error(Status::CODE_404,
                       "TAG_NOT_FOUND",
@@ -815,12 +1733,8 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
       return createDtoResponse(Status::CODE_200, list);
     }
 
-    auto allIssues = issues().listAllIssues();
-
-    for (const auto& issue : allIssues) {
-      if (issue.hasTag(searchTag)) {
-        list->push_back(issueToDto(issue));
-      }
+    for (const auto& issue : issues()->findIssuesByTag(searchTag)) {
+      list->push_back(issueToDto(issue));
     }
 
     return createDtoResponse(Status::CODE_200, list);
@@ -846,30 +1760,13 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
       return createDtoResponse(Status::CODE_200, list);
     }
 
-    std::vector<std::string> searchTags;
-    std::istringstream iss(tagsStr);
-    std::string tag;
-    while (std::getline(iss, tag, ',')) {
-      tag.erase(0, tag.find_first_not_of(" \t"));
-      tag.erase(tag.find_last_not_of(" \t") + 1);
-      if (!tag.empty()) {
-        searchTags.push_back(tag);
-      }
-    }
-
+    std::vector<std::string> searchTags = splitTags(tagsStr);
     if (searchTags.empty()) {
       return createDtoResponse(Status::CODE_200, list);
     }
 
-    auto allIssues = issues().listAllIssues();
-
-    for (const auto& issue : allIssues) {
-      for (const auto& searchTag : searchTags) {
-        if (issue.hasTag(searchTag)) {
-          list->push_back(issueToDto(issue));
-          break;
-        }
-      }
+    for (const auto& issue : issues()->findIssuesByTags(searchTags)) {
+      list->push_back(issueToDto(issue));
     }
 
     return createDtoResponse(Status::CODE_200, list);
@@ -909,7 +1806,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
 
     try {
       Milestone m =
-          issues().createMilestone(name, desc, start, end);
+          issues()->createMilestone(name, desc, start, end);
       return createDtoResponse(Status::CODE_201, milestoneToDto(m));
     } catch (const std::invalid_argument& ex) {
       return error(Status::CODE_400,
@@ -919,21 +1816,57 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
   }
 
   ENDPOINT_INFO(listMilestones) {
-    info->summary = "List all milestones";
+    info->summary = "List milestones, optionally by date range";
+    info->queryParams.add<String>("from").required = false;
+    info->queryParams.add<String>("to").required = false;
     info->addResponse<List<Object<MilestoneDto>>>(
         Status::CODE_200, "application/json");
+    info->addResponse<Object<ErrorDto>>(Status::CODE_400,
+                                        "application/json",
+                                        "from is after to");
   }
 
-  ENDPOINT("GET", "/milestones", listMilestones) {
-    auto list = issues().listAllMilestones();
-
-    auto dtoList =
-        oatpp::List<oatpp::Object<MilestoneDto>>::createShared();
-    for (auto& m : list) {
-      dtoList->push_back(milestoneToDto(m));
+  // from/to keep the milestones whose schedule overlaps the range.
+  ENDPOINT("GET", "/milestones", listMilestones,
+           REQUEST(std::shared_ptr<IncomingRequest>, request)) {
+    const std::string fromDate =
+        asOptionalStdString(request->getQueryParameter("from")).value_or("");
+    const std::string toDate =
+        asOptionalStdString(request->getQueryParameter("to")).value_or("");
+    try {
+      auto list = fromDate.empty() && toDate.empty()
+                      ? issues()->listAllMilestones()
+                      : issues()->findMilestonesByDateRange(fromDate, toDate);
+      return createDtoResponse(Status::CODE_200, milestonesToDto(list));
+    } catch (const std::invalid_argument& ex) {
+      return error(Status::CODE_400, "INVALID_DATE_RANGE", ex.what());
     }
+  }
+
+  ENDPOINT_INFO(listActiveMilestones) {
+    info->summary = "List milestones scheduled on a date (default today)";
+    info->queryParams.add<String>("on").required = false;
+    info->addResponse<List<Object<MilestoneDto>>>(
+        Status::CODE_200, "application/json");
+  }
+
+  ENDPOINT("GET", "/milestones/active", listActiveMilestones,
+           REQUEST(std::shared_ptr<IncomingRequest>, request)) {
+    auto list = issues()->getActiveMilestones(
+        asOptionalStdString(request->getQueryParameter("on")).value_or(""));
+    return createDtoResponse(Status::CODE_200, milestonesToDto(list));
+  }
 
-    return createDtoResponse(Status::CODE_200, dtoList);
+  ENDPOINT_INFO(listCompletedMilestones) {
+    info->summary = "List milestones whose issues are all done";
+    info->addResponse<List<Object<MilestoneDto>>>(
+        Status::CODE_200, "application/json");
+  }
+
+  ENDPOINT("GET", "/milestones/completed", listCompletedMilestones) {
+    return createDtoResponse(Status::CODE_200,
+                             milestonesToDto(
+                                 issues()->getCompletedMilestones()));
   }
 
   ENDPOINT_INFO(getMilestone) {
@@ -948,7 +1881,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
   ENDPOINT("GET", "/milestones/{id}", getMilestone,
            PATH(oatpp::Int32, id)) {
     try {
-      auto m = issues().getMilestone(id);
+      auto m = issues()->getMilestone(id);
       return createDtoResponse(Status::CODE_200, milestoneToDto(m));
     } catch (const std::out_of_range&) {
       return error(Status::CODE_404,
@@ -987,7 +1920,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
     }
 
     try {
-      auto updated = issues().updateMilestone(
+      auto updated = issues()->updateMilestone(
           id,
           asOptionalStdString(body->name),
           asOptionalStdString(body->description),
@@ -1020,7 +1953,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
            PATH(oatpp::Int32, id),
            QUERY(oatpp::Boolean, cascade)) {
     try {
-      bool ok = issues().deleteMilestone(id, cascade);
+      bool ok = issues()->deleteMilestone(id, cascade);
       return createResponse(Status::CODE_200,
                             ok ? "Deleted" : "Failed");
     } catch (const std::out_of_range&) {
@@ -1046,14 +1979,15 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
            addIssueToMilestone,
            PATH(oatpp::Int32, id),
            PATH(oatpp::Int32, issueId)) {
+    auto service = issues();
     try {
-      bool linked = issues().addIssueToMilestone(id, issueId);
+      bool linked = service->addIssueToMilestone(id, issueId);
       if (!linked) {
         return error(Status::CODE_400,
                      "ISSUE_ALREADY_LINKED",
                      "Issue already linked");
       }
-      auto milestone = issues().getMilestone(id);
+      auto milestone = service->getMilestone(id);
       return createDtoResponse(Status::CODE_200,
                                milestoneToDto(milestone));
     } catch (const std::out_of_range&) {
@@ -1083,7 +2017,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
            PATH(oatpp::Int32, id),
            PATH(oatpp::Int32, issueId)) {
     try {
-      bool ok = issues().removeIssueFromMilestone(id, issueId);
+      bool ok = issues()->removeIssueFromMilestone(id, issueId);
       return ok ? createResponse(Status::CODE_204, "")
                 : error(Status::CODE_404,
                         "ISSUE_NOT_LINKED",
@@ -1107,7 +2041,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
   ENDPOINT("GET", "/milestones/{id}/issues", getMilestoneIssues,
            PATH(oatpp::Int32, id)) {
     try {
-      auto list = issues().getIssuesForMilestone(id);
+      auto list = issues()->getIssuesForMilestone(id);
 
       auto dtoList =
           oatpp::List<oatpp::Object<IssueDto>>::createShared();
@@ -1123,6 +2057,33 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
     }
   }
 
+  ENDPOINT_INFO(getMilestoneStats) {
+    info->summary = "Issue counts and completion of a milestone";
+    info->addResponse<Object<MilestoneStatsDto>>(Status::CODE_200,
+                                                 "application/json");
+    info->addResponse<Object<ErrorDto>>(Status::CODE_404,
+                                        "application/json",
+                                        "Milestone not found");
+  }
+
+  ENDPOINT("GET", "/milestones/{id}/stats", getMilestoneStats,
+           PATH(oatpp::Int32, id)) {
+    try {
+      const MilestoneStats stats = issues()->getMilestoneStatistics(id);
+      auto dto = MilestoneStatsDto::createShared();
+      dto->milestoneId = stats.milestoneId;
+      dto->total = static_cast<std::int64_t>(stats.total);
+      dto->closed = static_cast<std::int64_t>(stats.closed);
+      dto->percentComplete = stats.percentComplete();
+      dto->byStatus = countFields(stats.byStatus);
+      return createDtoResponse(Status::CODE_200, dto);
+    } catch (const std::out_of_range&) {
+      return error(Status::CODE_404,
+                   "MILESTONE_NOT_FOUND",
+                   "Milestone not found");
+    }
+  }
+
   // ---- Database endpoints ----
 
   ENDPOINT_INFO(listDatabases) {
@@ -1134,6 +2095,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
   ENDPOINT("GET", "/databases", listDatabases) {
     auto databases = dbService->listDatabases();
     std::string active = dbService->getActiveDatabaseName();
+    const auto switchFailure = dbService->lastSwitchFailure();
 
     auto list =
         oatpp::List<oatpp::Object<DatabaseDto>>::createShared();
@@ -1143,6 +2105,9 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
       auto dto = DatabaseDto::createShared();
       dto->name = name.c_str();
       dto->active = (name == active);
+      if (switchFailure && switchFailure->target == name) {
+        dto->switchError = switchFailure->error.c_str();
+      }
       activeIncluded = activeIncluded || dto->active;
       list->push_back(dto);
     }
@@ -1212,7 +2177,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
                                         "Database not found");
     info->addResponse<Object<ErrorDto>>(Status::CODE_409,
                                         "application/json",
-                                        "Cannot delete active database");
+                                        "Database is active or still in use");
   }
 
   ENDPOINT("DELETE", "/databases/{name}", deleteDatabase,
@@ -1236,11 +2201,17 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
                    "Cannot delete the active database");
     }
 
-    bool deleted = dbService->deleteDatabase(provided);
-    return deleted ? createResponse(Status::CODE_204, "")
-                   : error(Status::CODE_400,
-                           "DATABASE_DELETE_FAILED",
-                           "Unable to delete database");
+    if (dbService->deleteDatabase(provided)) {
+      return createResponse(Status::CODE_204, "");
+    }
+    if (dbService->isDatabaseInUse(provided)) {
+      return error(Status::CODE_409,
+                   "DATABASE_BUSY",
+                   "Database is still in use; try again later");
+    }
+    return error(Status::CODE_400,
+                 "DATABASE_DELETE_FAILED",
+                 "Unable to delete database");
   }
 
   ENDPOINT_INFO(renameDatabase) {
@@ -1253,7 +2224,8 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
                                         "Database not found");
     info->addResponse<Object<ErrorDto>>(Status::CODE_409,
                                         "application/json",
-                                        "Target name already exists");
+                                        "Target name already exists or "
+                                        "database still in use");
   }
 
   ENDPOINT("PATCH", "/databases/{name}", renameDatabase,
@@ -1292,6 +2264,11 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
     }
 
     bool ok = dbService->renameDatabase(current, proposed);
+    if (!ok && dbService->isDatabaseInUse(current)) {
+      return error(Status::CODE_409,
+                   "DATABASE_BUSY",
+                   "Database is still in use; try again later");
+    }
     if (!ok) {
       return error(Status::CODE_400,
                    "DATABASE_RENAME_FAILED",
@@ -1309,11 +2286,15 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
     info->summary = "Switch the active database";
     info->addResponse<Object<DatabaseDto>>(Status::CODE_200,
                                            "application/json");
+    info->addResponse<Object<DatabaseDto>>(
+        Status::CODE_202, "application/json",
+        "Database is being opened; it becomes active when ready");
     info->addResponse<Object<ErrorDto>>(Status::CODE_404,
                                         "application/json",
                                         "Database not found");
   }
 
+  // Never waits for the target to open; see DatabaseService::switchDatabase.
   ENDPOINT("POST", "/databases/{name}/switch", switchDatabase,
            PATH(oatpp::String, name)) {
     std::string provided = asStdString(name);
@@ -1325,8 +2306,185 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
     }
 
     auto dto = DatabaseDto::createShared();
-    dto->name = dbService->getActiveDatabaseName().c_str();
-    dto->active = true;
+    dto->name = withDbExtension(provided).c_str();
+    dto->active = dto->name == dbService->getActiveDatabaseName();
+    return createDtoResponse(
+        dto->active ? Status::CODE_200 : Status::CODE_202, dto);
+  }
+
+  static oatpp::Object<BackupDto> backupToDto(
+      const DatabaseService::BackupStatus& status) {
+    static const char* const kStates[] = {"running", "done", "failed"};
+    auto dto = BackupDto::createShared();
+    dto->source = status.source.c_str();
+    dto->snapshot = status.snapshot.c_str();
+    dto->state = kStates[static_cast<int>(status.state)];
+    dto->pagesCopied = status.pagesCopied;
+    dto->pagesTotal = status.pagesTotal;
+    dto->error = status.error.c_str();
+    return dto;
+  }
+
+  ENDPOINT_INFO(backupDatabase) {
+    info->summary = "Start an online backup into a new database";
+    info->addConsumes<Object<BackupCreateDto>>("application/json");
+    info->addResponse<Object<BackupDto>>(Status::CODE_202,
+                                         "application/json");
+    info->addResponse<Object<ErrorDto>>(Status::CODE_404,
+                                        "application/json",
+                                        "Database not found");
+    info->addResponse<Object<ErrorDto>>(Status::CODE_409,
+                                        "application/json",
+                                        "Snapshot exists or backup running");
+  }
+
+  // Returns once the backup has started; poll GET for its progress.
+  ENDPOINT("POST", "/databases/{name}/backup", backupDatabase,
+           PATH(oatpp::String, name),
+           BODY_DTO(oatpp::Object<BackupCreateDto>, body)) {
+    if (!body || !body->name) {
+      return error(Status::CODE_400,
+                   "MISSING_NAME",
+                   "Snapshot name is required");
+    }
+    const std::string source = asStdString(name);
+    const std::string snapshot = asStdString(body->name);
+
+    auto existing = dbService->listDatabases();
+    if (std::find(existing.begin(), existing.end(),
+                  withDbExtension(source)) == existing.end()) {
+      return error(Status::CODE_404,
+                   "DATABASE_NOT_FOUND",
+                   "Database not found");
+    }
+    if (std::find(existing.begin(), existing.end(),
+                  withDbExtension(snapshot)) != existing.end()) {
+      return error(Status::CODE_409,
+                   "DATABASE_EXISTS",
+                   "Database already exists");
+    }
+    auto previous = dbService->backupStatus(source);
+    if (previous &&
+        previous->state == DatabaseService::BackupStatus::State::kRunning) {
+      return error(Status::CODE_409,
+                   "BACKUP_RUNNING",
+                   "A backup of this database is still running");
+    }
+
+    if (!dbService->startBackup(source, snapshot)) {
+      return error(Status::CODE_400,
+                   "BACKUP_FAILED",
+                   "Unable to start backup");
+    }
+    return createDtoResponse(Status::CODE_202,
+                             backupToDto(*dbService->backupStatus(source)));
+  }
+
+  ENDPOINT_INFO(getBackupStatus) {
+    info->summary = "Progress of the latest backup of a database";
+    info->addResponse<Object<BackupDto>>(Status::CODE_200,
+                                         "application/json");
+    info->addResponse<Object<ErrorDto>>(Status::CODE_404,
+                                        "application/json",
+                                        "No backup started");
+  }
+
+  ENDPOINT("GET", "/databases/{name}/backup", getBackupStatus,
+           PATH(oatpp::String, name)) {
+    auto status = dbService->backupStatus(asStdString(name));
+    if (!status) {
+      return error(Status::CODE_404,
+                   "BACKUP_NOT_FOUND",
+                   "No backup of this database was started");
+    }
+    return createDtoResponse(Status::CODE_200, backupToDto(*status));
+  }
+
+  ENDPOINT_INFO(getStorageSettings) {
+    info->summary = "Storage settings in effect on the active database";
+    info->addResponse<Object<StorageSettingsDto>>(Status::CODE_200,
+                                                  "application/json");
+  }
+
+  ENDPOINT("GET", "/diagnostics/storage", getStorageSettings) {
+    // Name first: the service handle is dropped at the end of its
+    // statement, so a rename or delete waiting on it cannot block on us.
+    const std::string database = dbService->getActiveDatabaseName();
+    const StorageProfile settings =
+        dbService->getIssueService()->storageSettings().value_or(
+            dbService->storageProfile());
+
+    auto dto = StorageSettingsDto::createShared();
+    dto->database = database.c_str();
+    dto->profile = settings.name.c_str();
+    dto->mmapSize = settings.mmapSize;
+    dto->cacheSize = settings.cacheSize;
+    dto->synchronous = settings.synchronous.c_str();
+    dto->tempStore = settings.tempStore.c_str();
+    dto->busyTimeoutMs = settings.busyTimeoutMs;
+    dto->writeBatch = static_cast<v_int64>(settings.writeBatch);
+    dto->writeBatchDelayUs = settings.writeBatchDelayUs;
+    return createDtoResponse(Status::CODE_200, dto);
+  }
+
+  // ---- Search endpoint ----
+
+  ENDPOINT_INFO(searchIssues) {
+    info->summary = "Full-text search over issue titles and comments";
+    info->queryParams.add<String>("q").required = true;
+    info->queryParams.add<Int32>("limit").required = false;
+    info->queryParams.add<Int32>("offset").required = false;
+    info->addResponse<Object<SearchResultDto>>(Status::CODE_200,
+                                               "application/json");
+    info->addResponse<Object<ErrorDto>>(Status::CODE_400,
+                                        "application/json",
+                                        "Missing query or bad paging value");
+  }
+
+  ENDPOINT("GET", "/search", searchIssues,
+           REQUEST(std::shared_ptr<IncomingRequest>, request)) {
+    auto text = [&](const char* name) {
+      return asOptionalStdString(request->getQueryParameter(name));
+    };
+
+    SearchRequest search;
+    search.text = text("q").value_or("");
+    if (search.terms().empty()) {
+      return error(Status::CODE_400,
+                   "MISSING_QUERY",
+                   "q must contain at least one search term");
+    }
+    const std::pair<const char*, std::size_t*> paging[] = {
+        {"limit", &search.limit}, {"offset", &search.offset}};
+    for (const auto& [name, target] : paging) {
+      if (auto raw = text(name)) {
+        std::int64_t value = 0;
+        if (!parseInt64(*raw, &value) || value < 0 ||
+            (target == &search.limit &&
+             (value < 1 || value > static_cast<std::int64_t>(kMaxPageSize)))) {
+          return error(Status::CODE_400,
+                       "INVALID_PAGE",
+                       "Malformed value for '" + std::string(name) + "'");
+        }
+        *target = static_cast<std::size_t>(value);
+      }
+    }
+
+    SearchPage page = issues()->searchIssues(search);
+    auto dto = SearchResultDto::createShared();
+    dto->hits = oatpp::List<oatpp::Object<SearchHitDto>>::createShared();
+    for (const SearchHit& hit : page.hits) {
+      auto hitDto = SearchHitDto::createShared();
+      hitDto->issueId = hit.issueId;
+      hitDto->commentId = hit.commentId;
+      hitDto->title = hit.title.c_str();
+      hitDto->snippet = hit.snippet.c_str();
+      hitDto->score = hit.score;
+      dto->hits->push_back(hitDto);
+    }
+    if (page.nextOffset) {
+      dto->nextOffset = static_cast<std::int64_t>(*page.nextOffset);
+    }
     return createDtoResponse(Status::CODE_200, dto);
   }
 
@@ -1357,7 +2515,7 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
     const std::string canonical =
         canonicalStatusLabel(asStdString(status));
 
-    bool ok = issues().updateIssueField(id, "status", canonical);
+    bool ok = issues()->updateIssueField(id, "status", canonical);
 
     return ok ? createResponse(Status::CODE_200, "Status updated")
               : error(Status::CODE_404,
@@ -1367,15 +2525,20 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
 
   ENDPOINT_INFO(getIssuesByStatus) {
     info->summary = "List issues filtered by status";
+    info->queryParams.add<Int32>("limit").required = false;
+    info->queryParams.add<String>("cursor").required = false;
+    info->queryParams.add<String>("sort").required = false;
+    info->queryParams.add<String>("view").required = false;
     info->addResponse<List<Object<IssueDto>>>(
         Status::CODE_200, "application/json");
     info->addResponse<Object<ErrorDto>>(Status::CODE_400,
                                         "application/json",
-                                        "Invalid status value");
+                                        "Invalid status or paging value");
   }
 
   ENDPOINT("GET", "/issues/status/{status}", getIssuesByStatus,
-           PATH(oatpp::String, status)) {
+           PATH(oatpp::String, status),
+           REQUEST(std::shared_ptr<IncomingRequest>, request)) {
     auto list = oatpp::List<oatpp::Object<IssueDto>>::createShared();
 
     if (!status) {
@@ -1396,14 +2559,12 @@ class IssueApiController : public oatpp::web::server::api::ApiController {
           "'tobedone').");
     }
 
-    auto all = issues().listAllIssues();
-    for (const auto& issue : all) {
-      if (canonicalStatusLabel(issue.getStatus()) == canonical) {
-        list->push_back(issueToDto(issue));
-      }
-    }
-
-    return createDtoResponse(Status::CODE_200, list);
+    auto service = issues();
+    IssueQuery query;
+    query.status = canonical;
+    return issueListResponse(request, service, query, [&] {
+      return service->findIssuesByStatus(canonical);
+    });
   }
 };
 
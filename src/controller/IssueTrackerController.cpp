@@ -3,8 +3,10 @@
 
 #include <algorithm>
 #include <cctype>
+#include <ctime>
 #include <exception>
 #include <optional>
+#include <set>
 #include <stdexcept>
 
 #include "UserRoles.hpp"
@@ -30,24 +32,55 @@ Issue IssueTrackerController::createIssue(const std::string& title,
     return Issue();
   }
 
-  // 1. Create the Issue (no description yet, timestamp 0 means "unspecified"
-  //    or "let the repo / model decide").
-  Issue newIssue(0, author_id, title, 0);
-  Issue savedIssue = repo->saveIssue(newIssue);
-
-  // 2. Create the first Comment = Description
-  if (!desc.empty()) {
-    Comment descComment(0, author_id, desc, 0);
-    Comment savedComment = repo->saveComment(savedIssue.getId(), descComment);
-
-    // 3. Link comment #1 as description
-    savedIssue.setDescriptionCommentId(savedComment.getId());
-    // Keep the in-memory Issue object consistent with what was persisted.
-    savedIssue.addComment(savedComment);
-    repo->saveIssue(savedIssue);
-  }
+  // The three writes below commit together, so a failure never leaves an
+  // issue without its description.
+  return repo->inTransaction([&] {
+    // 1. Create the Issue (no description yet, timestamp 0 means
+    //    "unspecified" or "let the repo / model decide").
+    Issue newIssue(0, author_id, title, 0);
+    Issue savedIssue = repo->saveIssue(newIssue);
+
+    // 2. Create the first Comment = Description
+    if (!desc.empty()) {
+      Comment descComment(0, author_id, desc, 0);
+      Comment savedComment =
+          repo->saveComment(savedIssue.getId(), descComment);
+
+      // 3. Link comment #1 as description
+      savedIssue.setDescriptionCommentId(savedComment.getId());
+      // Keep the in-memory Issue object consistent with what was persisted.
+      savedIssue.addComment(savedComment);
+      repo->saveIssue(savedIssue);
+    }
 
-  return savedIssue;
+    return savedIssue;
+  });
+}
+
+std::vector<int> IssueTrackerController::importIssues(
+    const std::vector<Issue>& issues) {
+  // Every user is looked up once per call, however many records name it.
+  std::set<std::string> known;
+  auto requireUser = [&](const std::string& user) {
+    if (user.empty() || known.count(user) > 0) {
+      return;
+    }
+    try {
+      repo->getUser(user);
+    } catch (const std::exception&) {
+      throw std::invalid_argument("Unknown user: " + user);
+    }
+    known.insert(user);
+  };
+
+  for (const Issue& issue : issues) {
+    requireUser(issue.getAuthorId());
+    requireUser(issue.getAssignedTo());
+    for (const Comment& comment : issue.getComments()) {
+      requireUser(comment.getAuthor());
+    }
+  }
+  return repo->importIssues(issues);
 }
 
 // returns the issue from IR
@@ -60,62 +93,64 @@ bool IssueTrackerController::updateIssueField(int id,
                                               const std::string& field,
                                               const std::string& value) {
   try {
-    Issue issue = repo->getIssue(id);
+    return repo->inTransaction([&] {
+      Issue issue = repo->getIssue(id);
 
-    if (field == "title") {
-      issue.setTitle(value);
-      repo->saveIssue(issue);
-      return true;
+      if (field == "title") {
+        issue.setTitle(value);
+        repo->saveIssue(issue);
+        return true;
 
-    } else if (field == "description") {
-      // Get the description comment
-      const Comment* descComment =
-          issue.findCommentById(issue.getDescriptionCommentId());
+      } else if (field == "description") {
+        // Get the description comment
+        const Comment* descComment =
+            issue.findCommentById(issue.getDescriptionCommentId());
 
-      if (descComment) {
-        // Update existing description comment
-        Comment updated = *descComment;
-        updated.setText(value);
-        repo->saveComment(issue.getId(), updated);
-      } else {
-        // Create a new description comment
-        Comment newDesc(0, issue.getAuthorId(), value, 0);
-        Comment saved = repo->saveComment(issue.getId(), newDesc);
-        issue.setDescriptionCommentId(saved.getId());
-        repo->saveIssue(issue);
-      }
-      return true;
+        if (descComment) {
+          // Update existing description comment
+          Comment updated = *descComment;
+          updated.setText(value);
+          repo->saveComment(issue.getId(), updated);
+        } else {
+          // Create a new description comment
+          Comment newDesc(0, issue.getAuthorId(), value, 0);
+          Comment saved = repo->saveComment(issue.getId(), newDesc);
+          issue.setDescriptionCommentId(saved.getId());
+          repo->saveIssue(issue);
+        }
+        return true;
 
-    } else if (field == "status") {
-      // Normalize possible numeric input ("1"/"2"/"3") to status text,
-      // in case the view or API ever passes the numeric choice instead of
-      // the label.
-      std::string normalized = value;
-
-      if (normalized == "1") {
-        normalized = "To Be Done";
-      } else if (normalized == "2") {
-        normalized = "In Progress";
-      } else if (normalized == "3") {
-        normalized = "Done";
-      }
+      } else if (field == "status") {
+        // Normalize possible numeric input ("1"/"2"/"3") to status text,
+        // in case the view or API ever passes the numeric choice instead of
+        // the label.
+        std::string normalized = value;
+
+        if (normalized == "1") {
+          normalized = "To Be Done";
+        } else if (normalized == "2") {
+          normalized = "In Progress";
+        } else if (normalized == "3") {
+          normalized = "Done";
+        }
 
-      // Store the status on the Issue model
-      issue.setStatus(normalized);
-      repo->saveIssue(issue);
-      return true;
+        // Store the status on the Issue model
+        issue.setStatus(normalized);
+        repo->saveIssue(issue);
+        return true;
 
-    } else if (field == "authorId" || field == "author") {
-      // Ensure the new author exists before updating.
-      repo->getUser(value);
-      issue.setAuthorId(value);
-      repo->saveIssue(issue);
-      return true;
+      } else if (field == "authorId" || field == "author") {
+        // Ensure the new author exists before updating.
+        repo->getUser(value);
+        issue.setAuthorId(value);
+        repo->saveIssue(issue);
+        return true;
 
-    } else {
-      // Unknown field
-      return false;
-    }
+      } else {
+        // Unknown field
+        return false;
+      }
+    });
   } catch (const std::out_of_range&) {
     return false;
   } catch (const std::invalid_argument&) {
@@ -127,13 +162,15 @@ bool IssueTrackerController::updateIssueField(int id,
 bool IssueTrackerController::assignUserToIssue(int issueId,
                                                const std::string& user_name) {
   try {
-    // ensure user exists
-    repo->getUser(user_name);
+    return repo->inTransaction([&] {
+      // ensure user exists
+      repo->getUser(user_name);
 
-    Issue issue = repo->getIssue(issueId);
-    issue.assignTo(user_name);  // must exist in Issue.hpp
-    repo->saveIssue(issue);
-    return true;
+      Issue issue = repo->getIssue(issueId);
+      issue.assignTo(user_name);  // must exist in Issue.hpp
+      repo->saveIssue(issue);
+      return true;
+    });
   } catch (const std::out_of_range&) {
     return false;
   } catch (const std::invalid_argument&) {
@@ -144,10 +181,12 @@ bool IssueTrackerController::assignUserToIssue(int issueId,
 // Unassigns a user from an issue
 bool IssueTrackerController::unassignUserFromIssue(int issueId) {
   try {
-    Issue issue = repo->getIssue(issueId);
-    issue.unassign();
-    repo->saveIssue(issue);
-    return true;
+    return repo->inTransaction([&] {
+      Issue issue = repo->getIssue(issueId);
+      issue.unassign();
+      repo->saveIssue(issue);
+      return true;
+    });
   } catch (const std::out_of_range&) {
     return false;
   }
@@ -163,6 +202,16 @@ std::vector<Comment> IssueTrackerController::getallComments(int issueId) {
   return repo->getAllComments(issueId);
 }
 
+CommentPage IssueTrackerController::getCommentPage(
+    int issueId, const CommentPageRequest& page) {
+  return repo->getCommentPage(issueId, page);
+}
+
+IssueDigest IssueTrackerController::getIssueDigest(int issueId,
+                                                   std::size_t latest) {
+  return repo->getIssueDigest(issueId, latest);
+}
+
 // allows the view / API to display a single comment
 Comment IssueTrackerController::getComment(int issueId, int commentId) {
   return repo->getComment(issueId, commentId);
@@ -180,23 +229,28 @@ Comment IssueTrackerController::addCommentToIssue(
       return Comment();
     }
 
-    // Ensure the issue exists
-    Issue issue = repo->getIssue(issueId);
+    return repo->inTransaction([&] {
+      // Ensure the issue exists
+      Issue issue = repo->getIssue(issueId);
 
-    // Ensure the user exists
-    repo->getUser(authorId);
+      // Ensure the user exists
+      repo->getUser(authorId);
 
-    // Create and save the new comment
-    Comment newComment(-1, authorId, text, 0);  // -1 so repo assigns id
-    Comment savedComment = repo->saveComment(issueId, newComment);
+      // Create and save the new comment
+      Comment newComment(-1, authorId, text, 0);  // -1 so repo assigns id
+      Comment savedComment = repo->saveComment(issueId, newComment);
 
-    // Link comment to issue and save
-    issue.addComment(savedComment.getId());
-    repo->saveIssue(issue);
+      // Link comment to issue and save
+      issue.addComment(savedComment.getId());
+      repo->saveIssue(issue);
 
-    return savedComment;
+      return savedComment;
+    });
   } catch (const std::out_of_range&) {
     return Comment();
+  } catch (const std::invalid_argument&) {
+    // SQLite reports a missing issue this way
+    return Comment();
   }
 }
 
@@ -205,10 +259,12 @@ bool IssueTrackerController::updateComment(int issueId,
                                            int commentId,
                                            const std::string& newText) {
   try {
-    Comment comment = repo->getComment(issueId, commentId);
-    comment.setText(newText);
-    repo->saveComment(issueId, comment);
-    return true;
+    return repo->inTransaction([&] {
+      Comment comment = repo->getComment(issueId, commentId);
+      comment.setText(newText);
+      repo->saveComment(issueId, comment);
+      return true;
+    });
   } catch (const std::out_of_range&) {
     return false;
   }
@@ -217,17 +273,19 @@ bool IssueTrackerController::updateComment(int issueId,
 // deletes comments by issue id and comment id
 bool IssueTrackerController::deleteComment(int issueId, int commentId) {
   try {
-    repo->getComment(issueId, commentId);
+    return repo->inTransaction([&] {
+      repo->getComment(issueId, commentId);
 
-    bool deleted = repo->deleteComment(issueId, commentId);
+      bool deleted = repo->deleteComment(issueId, commentId);
 
-    if (deleted) {
-      Issue issue = repo->getIssue(issueId);
-      issue.removeComment(commentId);
-      repo->saveIssue(issue);
-      return true;
-    }
-    return false;
+      if (deleted) {
+        Issue issue = repo->getIssue(issueId);
+        issue.removeComment(commentId);
+        repo->saveIssue(issue);
+        return true;
+      }
+      return false;
+    });
   } catch (const std::out_of_range&) {
     return false;
   }
@@ -247,59 +305,62 @@ bool IssueTrackerController::updateUser(const std::string& userId,
                                         const std::string& field,
                                         const std::string& value) {
   try {
-    User userObj = repo->getUser(userId);
-    if (field == "name") {
-      if (value.empty()) {
-        return false;
-      }
-      if (value == userId) {
-        return true;
-      }
-
-      try {
-        if (repo->getUser(value).getName() == value) {
+    // A rename rewrites issues, comments and users; commit it as one.
+    return repo->inTransaction([&] {
+      User userObj = repo->getUser(userId);
+      if (field == "name") {
+        if (value.empty()) {
           return false;
         }
-      } catch (...) {
-      }
-
-      for (Issue issue : repo->listIssues()) {
-        bool issueChanged = false;
-        if (issue.getAuthorId() == userId) {
-          issue.setAuthorId(value);
-          issueChanged = true;
-        }
-        if (issue.hasAssignee() && issue.getAssignedTo() == userId) {
-          issue.assignTo(value);
-          issueChanged = true;
+        if (value == userId) {
+          return true;
         }
 
-        for (Comment c : repo->getAllComments(issue.getId())) {
-          if (c.getAuthor() == userId) {
-            c.setAuthor(value);
-            repo->saveComment(issue.getId(), c);
+        try {
+          if (repo->getUser(value).getName() == value) {
+            return false;
           }
+        } catch (...) {
         }
 
-        if (issueChanged) {
-          repo->saveIssue(issue);
+        for (Issue issue : repo->listIssues()) {
+          bool issueChanged = false;
+          if (issue.getAuthorId() == userId) {
+            issue.setAuthorId(value);
+            issueChanged = true;
+          }
+          if (issue.hasAssignee() && issue.getAssignedTo() == userId) {
+            issue.assignTo(value);
+            issueChanged = true;
+          }
+
+          for (Comment c : repo->getAllComments(issue.getId())) {
+            if (c.getAuthor() == userId) {
+              c.setAuthor(value);
+              repo->saveComment(issue.getId(), c);
+            }
+          }
+
+          if (issueChanged) {
+            repo->saveIssue(issue);
+          }
         }
-      }
 
-      userObj.setName(value);
-      repo->saveUser(userObj);
-      repo->deleteUser(userId);
-      return true;
+        userObj.setName(value);
+        repo->saveUser(userObj);
+        repo->deleteUser(userId);
+        return true;
 
-    } else if (field == "role") {
-      if (!isValidRole(value)) {
-        return false;
+      } else if (field == "role") {
+        if (!isValidRole(value)) {
+          return false;
+        }
+        userObj.setRole(value);
+        repo->saveUser(userObj);
+        return true;
       }
-      userObj.setRole(value);
-      repo->saveUser(userObj);
-      return true;
-    }
-    return false;
+      return false;
+    });
   } catch (...) {
     return false;
   }
@@ -320,64 +381,66 @@ std::vector<Issue> IssueTrackerController::listAllUnassignedIssues() {
   return repo->listAllUnassigned();
 }
 
-// returns issues by username inputted
+// returns issues authored by the user, case-insensitively
 std::vector<Issue> IssueTrackerController::findIssuesByUserId(
     const std::string& user_name) {
+  IssueQuery query;
+  query.author = user_name;
+  return repo->findIssues(query);
+}
 
-    std::string target = user_name;
-    std::transform(target.begin(), target.end(),
-    target.begin(), ::tolower);
+std::vector<Issue> IssueTrackerController::findIssues(
+    const IssueQuery& query) {
+  return repo->findIssues(query);
+}
 
-    return repo->findIssues([&](const Issue& issue) {
-        std::string author = issue.getAuthorId();
-        std::transform(author.begin(), author.end(),
-        author.begin(), ::tolower);
-        return author == target;
-    });
+IssuePage IssueTrackerController::findIssuePage(
+    const IssueQuery& query, const IssuePageRequest& page) {
+  return repo->findIssuePage(query, page);
+}
+
+std::vector<IssueSummary> IssueTrackerController::findIssueSummaries(
+    const IssueQuery& query) {
+  return repo->findIssueSummaries(query);
+}
+
+IssueSummaryPage IssueTrackerController::findIssueSummaryPage(
+    const IssueQuery& query, const IssuePageRequest& page) {
+  return repo->findIssueSummaryPage(query, page);
+}
+
+IssueStats IssueTrackerController::countIssues(const IssueQuery& query) {
+  return repo->countIssues(query);
+}
+
+SearchPage IssueTrackerController::searchIssues(
+    const SearchRequest& request) {
+  return repo->searchIssues(request);
 }
 
 std::vector<Issue> IssueTrackerController::findIssuesByStatus(
     const std::string& status) {
-  std::vector<Issue> all = repo->listIssues();
-  std::vector<Issue> filtered;
-
-  for (const auto& issue : all) {
-    if (issue.getStatus() == status) {
-      filtered.push_back(issue);
-    }
-  }
-  return filtered;
+  IssueQuery query;
+  query.status = status;
+  return repo->findIssues(query);
 }
 
 std::vector<Issue> IssueTrackerController::findIssuesByTag(
     const std::string& tag) {
-
-  std::vector<Issue> all = repo->listIssues();
-  std::vector<Issue> filtered;
-
-  for (const auto& issue : all) {
-    if (issue.hasTag(tag)) {
-      filtered.push_back(issue);
-    }
-  }
-  return filtered;
+  IssueQuery query;
+  query.tagsAny = {tag};
+  return repo->findIssues(query);
 }
 
 std::vector<Issue> IssueTrackerController::findIssuesByTags(
     const std::vector<std::string>& tags) {
-
-  std::vector<Issue> all = repo->listIssues();
-  std::vector<Issue> filtered;
-
-  for (const auto& issue : all) {
-    for (const auto& tag : tags) {
-      if (issue.hasTag(tag)) {
-        filtered.push_back(issue);
-        break;
-      }
-    }
+  // An empty tagsAny would match everything.
+  if (tags.empty()) {
+    return {};
   }
-  return filtered;
+  IssueQuery query;
+  query.tagsAny = tags;
+  return repo->findIssues(query);
 }
 
 std::vector<Tag> IssueTrackerController::listAllTags() {
@@ -475,22 +538,24 @@ Milestone IssueTrackerController::updateMilestone(int milestoneId,
         throw std::invalid_argument("No milestone fields provided");
     }
 
-    Milestone milestone = repo->getMilestone(milestoneId);
+    return repo->inTransaction([&] {
+        Milestone milestone = repo->getMilestone(milestoneId);
 
-    if (name) {
-        milestone.setName(*name);
-    }
-    if (description) {
-        milestone.setDescription(*description);
-    }
-    if (startDate) {
-        milestone.setStartDate(*startDate);
-    }
-    if (endDate) {
-        milestone.setEndDate(*endDate);
-    }
+        if (name) {
+            milestone.setName(*name);
+        }
+        if (description) {
+            milestone.setDescription(*description);
+        }
+        if (startDate) {
+            milestone.setStartDate(*startDate);
+        }
+        if (endDate) {
+            milestone.setEndDate(*endDate);
+        }
 
-    return repo->saveMilestone(milestone);
+        return repo->saveMilestone(milestone);
+    });
 }
 
 bool IssueTrackerController::addIssueToMilestone(
@@ -529,3 +594,34 @@ std::vector<Issue> IssueTrackerController::getIssuesForMilestone(
     int milestoneId) {
     return repo->getIssuesForMilestone(milestoneId);
 }
+
+MilestoneStats IssueTrackerController::getMilestoneStatistics(
+    int milestoneId) {
+    return repo->getMilestoneStats(milestoneId);
+}
+
+std::vector<Milestone> IssueTrackerController::findMilestonesByDateRange(
+    const std::string& startDate, const std::string& endDate) {
+    if (!startDate.empty() && !endDate.empty() && startDate > endDate) {
+        throw std::invalid_argument("Start date is after end date");
+    }
+    return repo->findMilestonesInRange(startDate, endDate);
+}
+
+std::vector<Milestone> IssueTrackerController::getActiveMilestones(
+    const std::string& onDate) {
+    std::string day = onDate;
+    if (day.empty()) {
+        const std::time_t now = std::time(nullptr);
+        std::tm utc{};
+        gmtime_r(&now, &utc);
+        char buffer[11];
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d", &utc);
+        day = buffer;
+    }
+    return repo->findMilestonesInRange(day, day);
+}
+
+std::vector<Milestone> IssueTrackerController::getCompletedMilestones() {
+    return repo->findCompletedMilestones();
+}
@@ -11,6 +11,8 @@ class DatabaseDto : public oatpp::DTO {
 
   DTO_FIELD(oatpp::String, name);
   DTO_FIELD(oatpp::Boolean, active);
+  // Set on the target of the latest switch if it could not be opened.
+  DTO_FIELD(oatpp::String, switchError, "switch_error");
 };
 
 class DatabaseCreateDto : public oatpp::DTO {
@@ -25,6 +27,37 @@ class DatabaseRenameDto : public oatpp::DTO {
   DTO_FIELD(oatpp::String, name, "name");
 };
 
+class BackupCreateDto : public oatpp::DTO {
+  DTO_INIT(BackupCreateDto, DTO)
+
+  DTO_FIELD(oatpp::String, name);
+};
+
+class BackupDto : public oatpp::DTO {
+  DTO_INIT(BackupDto, DTO)
+
+  DTO_FIELD(oatpp::String, source);
+  DTO_FIELD(oatpp::String, snapshot);
+  DTO_FIELD(oatpp::String, state);
+  DTO_FIELD(oatpp::Int32, pagesCopied, "pages_copied");
+  DTO_FIELD(oatpp::Int32, pagesTotal, "pages_total");
+  DTO_FIELD(oatpp::String, error);
+};
+
+class StorageSettingsDto : public oatpp::DTO {
+  DTO_INIT(StorageSettingsDto, DTO)
+
+  DTO_FIELD(oatpp::String, database);
+  DTO_FIELD(oatpp::String, profile);
+  DTO_FIELD(oatpp::Int64, mmapSize, "mmap_size");
+  DTO_FIELD(oatpp::Int64, cacheSize, "cache_size");
+  DTO_FIELD(oatpp::String, synchronous);
+  DTO_FIELD(oatpp::String, tempStore, "temp_store");
+  DTO_FIELD(oatpp::Int32, busyTimeoutMs, "busy_timeout_ms");
+  DTO_FIELD(oatpp::Int64, writeBatch, "write_batch");
+  DTO_FIELD(oatpp::Int64, writeBatchDelayUs, "write_batch_delay_us");
+};
+
 #include OATPP_CODEGEN_END(DTO)
 
 #endif
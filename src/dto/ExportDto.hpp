@@ -0,0 +1,51 @@
+#ifndef EXPORT_DTO_HPP_
+#define EXPORT_DTO_HPP_
+
+#include "oatpp/core/macro/codegen.hpp"
+#include "oatpp/core/Types.hpp"
+#include "CommentDto.hpp"
+#include "TagDto.hpp"
+
+#include OATPP_CODEGEN_BEGIN(DTO)
+
+// One line each of an NDJSON export, told apart by type. Users and
+// milestones carry the fields the API returns for them; issue lines are
+// also valid IssueImport records.
+class ExportUserDto : public oatpp::DTO {
+  DTO_INIT(ExportUserDto, DTO)
+
+  DTO_FIELD(oatpp::String, type);
+  DTO_FIELD(oatpp::String, name);
+  DTO_FIELD(oatpp::String, role);
+};
+
+class ExportMilestoneDto : public oatpp::DTO {
+  DTO_INIT(ExportMilestoneDto, DTO)
+
+  DTO_FIELD(oatpp::String, type);
+  DTO_FIELD(Int32, id);
+  DTO_FIELD(String, name);
+  DTO_FIELD(String, description);
+  DTO_FIELD(String, startDate);
+  DTO_FIELD(String, endDate);
+  DTO_FIELD(List<Int32>, issueIds);
+};
+
+class ExportIssueDto : public oatpp::DTO {
+  DTO_INIT(ExportIssueDto, DTO)
+
+  DTO_FIELD(oatpp::String, type);
+  DTO_FIELD(oatpp::Int32, id);
+  DTO_FIELD(oatpp::String, title);
+  DTO_FIELD(oatpp::String, description);
+  DTO_FIELD(oatpp::String, authorId, "author_id");
+  DTO_FIELD(oatpp::String, assignedTo, "assigned_to");
+  DTO_FIELD(oatpp::String, status);
+  DTO_FIELD(oatpp::Int64, createdAt, "created_at");
+  DTO_FIELD(oatpp::List<oatpp::Object<CommentDto>>, comments);
+  DTO_FIELD(oatpp::List<oatpp::Object<TagDto>>, tags);
+};
+
+#include OATPP_CODEGEN_END(DTO)
+
+#endif
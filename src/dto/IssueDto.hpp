@@ -3,6 +3,7 @@
 
 #include "oatpp/core/macro/codegen.hpp"
 #include "oatpp/core/Types.hpp"
+#include "CommentDto.hpp"
 #include "TagDto.hpp"
 
 #include OATPP_CODEGEN_BEGIN(DTO)
@@ -20,6 +21,45 @@ class IssueDto : public oatpp::DTO {
   DTO_FIELD(oatpp::List<oatpp::Object<TagDto>>, tags);
 };
 
+class IssueSummaryDto : public oatpp::DTO {
+  DTO_INIT(IssueSummaryDto, DTO)
+
+  DTO_FIELD(oatpp::Int32, id);
+  DTO_FIELD(oatpp::String, title);
+  DTO_FIELD(oatpp::String, status);
+  DTO_FIELD(oatpp::String, assignedTo, "assigned_to");
+  DTO_FIELD(oatpp::String, authorId, "author_id");
+  DTO_FIELD(oatpp::Int64, createdAt, "created_at");
+  DTO_FIELD(oatpp::List<oatpp::String>, tags);
+  DTO_FIELD(oatpp::Int32, commentCount, "comment_count");
+};
+
+class IssueDigestDto : public oatpp::DTO {
+  DTO_INIT(IssueDigestDto, DTO)
+
+  DTO_FIELD(oatpp::Int32, id);
+  DTO_FIELD(oatpp::String, title);
+  DTO_FIELD(oatpp::String, description);
+  DTO_FIELD(oatpp::String, status);
+  DTO_FIELD(oatpp::String, assignedTo, "assigned_to");
+  DTO_FIELD(oatpp::String, authorId, "author_id");
+  DTO_FIELD(oatpp::Int64, createdAt, "created_at");
+  DTO_FIELD(oatpp::List<oatpp::String>, tags);
+  DTO_FIELD(oatpp::Int32, commentCount, "comment_count");
+  DTO_FIELD(oatpp::List<oatpp::Object<CommentDto>>, latestComments,
+            "latest_comments");
+};
+
+class IssueStatsDto : public oatpp::DTO {
+  DTO_INIT(IssueStatsDto, DTO)
+
+  DTO_FIELD(oatpp::Int64, total);
+  DTO_FIELD(oatpp::Int64, unassigned);
+  DTO_FIELD(oatpp::Fields<oatpp::Int64>, byStatus, "by_status");
+  DTO_FIELD(oatpp::Fields<oatpp::Int64>, byAssignee, "by_assignee");
+  DTO_FIELD(oatpp::Fields<oatpp::Int64>, byTag, "by_tag");
+};
+
 class IssueCreateDto : public oatpp::DTO {
   DTO_INIT(IssueCreateDto, DTO)
 
@@ -34,5 +74,26 @@ class IssueUpdateFieldDto : public oatpp::DTO {
   DTO_FIELD(oatpp::String, field);
   DTO_FIELD(oatpp::String, value);
 };
+// One NDJSON line of POST /import. The description becomes comment 0 and
+// the comments follow it in order; their ids are assigned on import.
+class IssueImportDto : public oatpp::DTO {
+  DTO_INIT(IssueImportDto, DTO)
+
+  DTO_FIELD(oatpp::String, title);
+  DTO_FIELD(oatpp::String, description);
+  DTO_FIELD(oatpp::String, authorId, "author_id");
+  DTO_FIELD(oatpp::String, assignedTo, "assigned_to");
+  DTO_FIELD(oatpp::String, status);
+  DTO_FIELD(oatpp::Int64, createdAt, "created_at");
+  DTO_FIELD(oatpp::List<oatpp::Object<CommentDto>>, comments);
+  DTO_FIELD(oatpp::List<oatpp::Object<TagDto>>, tags);
+};
+
+class ImportResultDto : public oatpp::DTO {
+  DTO_INIT(ImportResultDto, DTO)
+
+  DTO_FIELD(oatpp::Int64, imported);
+  DTO_FIELD(oatpp::Int64, batches);
+};
 #include OATPP_CODEGEN_END(DTO)
 #endif
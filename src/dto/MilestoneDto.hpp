@@ -35,6 +35,16 @@ class MilestoneUpdateDto : public oatpp::DTO {
   DTO_FIELD(String, endDate);
 };
 
+class MilestoneStatsDto : public oatpp::DTO {
+  DTO_INIT(MilestoneStatsDto, DTO)
+
+  DTO_FIELD(Int32, milestoneId, "milestone_id");
+  DTO_FIELD(Int64, total);
+  DTO_FIELD(Int64, closed);
+  DTO_FIELD(Float64, percentComplete, "percent_complete");
+  DTO_FIELD(Fields<Int64>, byStatus, "by_status");
+};
+
 #include OATPP_CODEGEN_END(DTO)
 
 #endif
@@ -0,0 +1,28 @@
+#ifndef SEARCH_DTO_HPP_
+#define SEARCH_DTO_HPP_
+
+#include "oatpp/core/macro/codegen.hpp"
+#include "oatpp/core/Types.hpp"
+
+#include OATPP_CODEGEN_BEGIN(DTO)
+
+class SearchHitDto : public oatpp::DTO {
+  DTO_INIT(SearchHitDto, DTO)
+
+  DTO_FIELD(oatpp::Int32, issueId, "issue_id");
+  DTO_FIELD(oatpp::Int32, commentId, "comment_id");
+  DTO_FIELD(oatpp::String, title);
+  DTO_FIELD(oatpp::String, snippet);
+  DTO_FIELD(oatpp::Float64, score);
+};
+
+class SearchResultDto : public oatpp::DTO {
+  DTO_INIT(SearchResultDto, DTO)
+
+  DTO_FIELD(oatpp::List<oatpp::Object<SearchHitDto>>, hits);
+  DTO_FIELD(oatpp::Int64, nextOffset, "next_offset");
+};
+
+#include OATPP_CODEGEN_END(DTO)
+
+#endif  // SEARCH_DTO_HPP_
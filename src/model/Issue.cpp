@@ -62,7 +62,37 @@ void Issue::setAuthorId(std::string author_id) {
   author_id_ = std::move(author_id);
 }
 
+void Issue::deferComments(int description_comment_id,
+                          CommentLoader loader) {
+  comment_ids_.clear();
+  comments_.clear();
+  description_comment_id_ = description_comment_id;
+  comment_loader_ = std::move(loader);
+}
+
+void Issue::loadComments() const {
+  if (!comment_loader_) {
+    return;
+  }
+  // Keep the loader if it throws, so a later access can retry.
+  std::vector<Comment> loaded = comment_loader_();
+  comment_loader_ = nullptr;
+
+  comment_ids_.clear();
+  for (const Comment& comment : loaded) {
+    comment_ids_.push_back(comment.getId());
+  }
+  comments_ = std::move(loaded);
+
+  if (description_comment_id_ >= 0 &&
+      std::find(comment_ids_.begin(), comment_ids_.end(),
+                description_comment_id_) == comment_ids_.end()) {
+    description_comment_id_ = -1;
+  }
+}
+
 void Issue::addComment(int comment_id) {
+  loadComments();
   if (comment_id < 0) {
     throw std::invalid_argument("comment_id must be >= 0 but was "
                                 + std::to_string(comment_id));
@@ -75,6 +105,7 @@ void Issue::addComment(int comment_id) {
 }
 
 bool Issue::removeComment(int comment_id) {
+  loadComments();
   auto it =
       std::find(comment_ids_.begin(), comment_ids_.end(), comment_id);
   if (it == comment_ids_.end()) {
@@ -88,6 +119,7 @@ bool Issue::removeComment(int comment_id) {
 }
 
 void Issue::setDescriptionCommentId(int comment_id) {
+  loadComments();
   if (comment_id < 0) {
     throw std::invalid_argument("comment_id must be >= 0 but was "
                                 + std::to_string(comment_id));
@@ -110,6 +142,7 @@ std::string Issue::getDescriptionComment() const {
 // --------------------------------------------
 
 void Issue::addComment(const Comment& comment) {
+  loadComments();
   const int commentId = comment.getId();
   if (commentId < 0) {
     throw std::invalid_argument("comment.id must be >= 0 but was "
@@ -135,6 +168,7 @@ void Issue::addComment(const Comment& comment) {
 }
 
 void Issue::addComment(Comment&& comment) {
+  loadComments();
   const int commentId = comment.getId();
   if (commentId < 0) {
     throw std::invalid_argument("comment.id must be >= 0 but was "
@@ -159,7 +193,8 @@ void Issue::addComment(Comment&& comment) {
   addComment(commentId);
 }
 
-const Comment* Issue::findCommentById(int id) const noexcept {
+const Comment* Issue::findCommentById(int id) const {
+  loadComments();
   auto it = std::find_if(
       comments_.begin(),
       comments_.end(),
@@ -169,7 +204,8 @@ const Comment* Issue::findCommentById(int id) const noexcept {
   return (it == comments_.end()) ? nullptr : &(*it);
 }
 
-Comment* Issue::findCommentById(int id) noexcept {
+Comment* Issue::findCommentById(int id) {
+  loadComments();
   auto it = std::find_if(
       comments_.begin(),
       comments_.end(),
@@ -180,6 +216,7 @@ Comment* Issue::findCommentById(int id) noexcept {
 }
 
 bool Issue::removeCommentById(int id) {
+  loadComments();
   auto it = std::find_if(
       comments_.begin(),
       comments_.end(),
@@ -0,0 +1,103 @@
+#include "IssueQuery.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+std::string toLower(std::string value) {
+  std::transform(
+      value.begin(), value.end(), value.begin(),
+      [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return value;
+}
+
+}  // namespace
+
+std::string IssueQuery::statusKey(const std::string& status) {
+  std::string key;
+  key.reserve(status.size());
+  for (char ch : toLower(status)) {
+    if (ch != ' ' && ch != '-' && ch != '_') {
+      key.push_back(ch);
+    }
+  }
+  return key;
+}
+
+bool IssueQuery::matches(const Issue& issue) const {
+  if (status && statusKey(issue.getStatus()) != statusKey(*status)) {
+    return false;
+  }
+  if (assignee && issue.getAssignedTo() != *assignee) {
+    return false;
+  }
+  if (author && toLower(issue.getAuthorId()) != toLower(*author)) {
+    return false;
+  }
+  if (unassignedOnly && issue.hasAssignee()) {
+    return false;
+  }
+  if (createdFrom && issue.getCreatedAt() < *createdFrom) {
+    return false;
+  }
+  if (createdTo && issue.getCreatedAt() >= *createdTo) {
+    return false;
+  }
+  if (!tagsAny.empty() &&
+      std::none_of(tagsAny.begin(), tagsAny.end(),
+                   [&](const std::string& tag) { return issue.hasTag(tag); })) {
+    return false;
+  }
+  return std::all_of(tagsAll.begin(), tagsAll.end(),
+                     [&](const std::string& tag) { return issue.hasTag(tag); });
+}
+
+// Token layout: hex of "<sort>.<sortKey>.<id>", where sort is 'i' or 'c'.
+std::string IssueCursor::encode() const {
+  const std::string plain = std::string(sort == IssueSort::kId ? "i" : "c") +
+                            "." + std::to_string(sortKey) + "." +
+                            std::to_string(id);
+  static const char kHex[] = "0123456789abcdef";
+  std::string token;
+  token.reserve(plain.size() * 2);
+  for (unsigned char c : plain) {
+    token.push_back(kHex[c >> 4]);
+    token.push_back(kHex[c & 0x0f]);
+  }
+  return token;
+}
+
+std::optional<IssueCursor> IssueCursor::decode(const std::string& token) {
+  if (token.empty() || token.size() % 2 != 0) {
+    return std::nullopt;
+  }
+  std::string plain;
+  for (std::size_t i = 0; i < token.size(); i += 2) {
+    unsigned int byte = 0;
+    if (!std::isxdigit(static_cast<unsigned char>(token[i])) ||
+        !std::isxdigit(static_cast<unsigned char>(token[i + 1])) ||
+        std::sscanf(token.substr(i, 2).c_str(), "%2x", &byte) != 1) {
+      return std::nullopt;
+    }
+    plain.push_back(static_cast<char>(byte));
+  }
+
+  char sort = 0;
+  long long sortKey = 0;
+  int id = 0;
+  int consumed = 0;
+  if (std::sscanf(plain.c_str(), "%c.%lld.%d%n", &sort, &sortKey, &id,
+                  &consumed) != 3 ||
+      static_cast<std::size_t>(consumed) != plain.size() ||
+      (sort != 'i' && sort != 'c')) {
+    return std::nullopt;
+  }
+  IssueCursor cursor;
+  cursor.sort = sort == 'i' ? IssueSort::kId : IssueSort::kCreatedAt;
+  cursor.sortKey = sortKey;
+  cursor.id = id;
+  return cursor;
+}
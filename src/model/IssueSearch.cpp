@@ -0,0 +1,13 @@
+#include "IssueSearch.hpp"
+
+#include <sstream>
+
+std::vector<std::string> SearchRequest::terms() const {
+  std::vector<std::string> result;
+  std::istringstream stream(text);
+  std::string term;
+  while (stream >> term) {
+    result.push_back(term);
+  }
+  return result;
+}
@@ -0,0 +1,33 @@
+#include "IssueSummary.hpp"
+
+#include <algorithm>
+
+IssueSummary IssueSummary::of(const Issue& issue) {
+  IssueSummary summary;
+  summary.id = issue.getId();
+  summary.title = issue.getTitle();
+  summary.status = issue.getStatus();
+  summary.assignedTo = issue.getAssignedTo();
+  summary.authorId = issue.getAuthorId();
+  summary.createdAt = issue.getCreatedAt();
+  for (const Tag& tag : issue.getTags()) {
+    summary.tags.push_back(tag.getName());
+  }
+  summary.commentCount = issue.getCommentIds().size();
+  return summary;
+}
+
+IssueDigest IssueDigest::of(const Issue& issue, std::size_t latest) {
+  IssueDigest digest;
+  digest.summary = IssueSummary::of(issue);
+  const std::vector<Comment>& comments = issue.getComments();
+  for (auto it = comments.rbegin(); it != comments.rend(); ++it) {
+    if (it->getId() == issue.getDescriptionCommentId()) {
+      digest.description = *it;
+    } else if (digest.latestComments.size() < latest) {
+      digest.latestComments.push_back(*it);
+    }
+  }
+  std::reverse(digest.latestComments.begin(), digest.latestComments.end());
+  return digest;
+}
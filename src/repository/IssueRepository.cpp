@@ -16,7 +16,9 @@ std::vector<Issue> IssueRepository::findIssues(
 }
 
 std::vector<Issue> IssueRepository::listAllUnassigned() const {
-  return findIssues([](const Issue& issue) { return !issue.hasAssignee(); });
+  IssueQuery query;
+  query.unassignedOnly = true;
+  return findIssues(query);
 }
 
 bool IssueRepository::addTagToIssue(int issueId,
@@ -2,22 +2,104 @@
 #define DATABASE_SERVICE_HPP_
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <cstdlib>
+#include <exception>
 #include <filesystem>
+#include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "IssueService.hpp"
 #include "SQLiteIssueRepository.hpp"
+#include "StorageProfile.hpp"
 
+// Owns the active IssueService and the database directory. All public
+// methods may be called concurrently. Callers receive reference-counted
+// service handles, so a switch never destroys a service that an
+// in-flight request is still using; the old service is closed when its
+// last handle goes away.
 class DatabaseService {
+ public:
+  // Progress of a backup started by startBackup.
+  struct BackupStatus {
+    enum class State { kRunning, kDone, kFailed };
+
+    std::string source;    // database backed up
+    std::string snapshot;  // database it is copied into
+    State state{State::kRunning};
+    int pagesCopied{0};
+    int pagesTotal{0};  // 0 until the first step
+    std::string error;  // why it failed
+  };
+
+  // Why the latest switch, accepted by switchDatabase, was not made.
+  struct SwitchFailure {
+    std::string target;  // database it was to switch to
+    std::string error;
+  };
+
  private:
+  // Pages copied per sqlite3_backup_step; each step holds the target's
+  // write lock only briefly.
+  static constexpr int kBackupPagesPerStep = 256;
+
+  // A backup on its own thread. status is updated under mutex as pages
+  // are copied; the thread is joined when the job is replaced or the
+  // service is destroyed.
+  struct BackupJob {
+    std::thread thread;
+    mutable std::mutex mutex;
+    BackupStatus status;
+  };
+
+  // Database files that still have an open service, including services
+  // switched away from but still held by requests. Shared with the
+  // service deleters, which may run after DatabaseService is gone.
+  struct OpenFiles {
+    std::mutex mutex;
+    std::condition_variable closed;
+    std::map<std::string, int> counts;
+  };
+
  bool useMemoryBackend_;
   std::string activeDbPath_;
   std::string dbDirectory_;
-  std::unique_ptr<IssueService> issueService_;
+  // Resolved once at startup from the environment and storage.conf.
+  StorageProfile profile_;
+  std::shared_ptr<IssueService> issueService_;
+  std::map<std::string, std::weak_ptr<IssueService>> services_;
+  std::shared_ptr<OpenFiles> openFiles_;
+  // Latest backup of each database, by file name.
+  std::map<std::string, std::shared_ptr<BackupJob>> backups_;
+  std::atomic<bool> stopping_{false};  // abandons running backups
+  mutable std::mutex mutex_;
+  // Files a rename or delete is closing; no service is opened on them.
+  std::set<std::string> closing_;
+  // Signalled when issueService_ is set again after the active file was
+  // closed (it is null only then).
+  mutable std::condition_variable activeReady_;
+  // Switches to a database without a live service are handed to the
+  // switcher thread, which opens and warms it off the request path.
+  std::string switchTarget_;  // path queued for the switcher, or empty
+  bool warming_{false};       // the switcher is opening a target
+  std::uint64_t switches_{0};  // switchDatabase calls that succeeded
+  std::optional<SwitchFailure> switchFailure_;  // of the latest switch
+  bool stopSwitcher_{false};
+  std::condition_variable switchQueued_;
+  std::condition_variable switchSettled_;  // nothing queued or warming
+  std::thread switcher_;
 
   static bool isMemoryBackendConfigured() {
     const char* backendEnv = std::getenv("ISSUE_REPO_BACKEND");
@@ -92,36 +174,301 @@ class DatabaseService {
     return path.string();
   }
 
-  std::unique_ptr<IssueRepository> buildRepository(
+  std::unique_ptr<SQLiteIssueRepository> buildRepository(
       const std::string& dbPath) const {
+    const std::size_t readers = SQLiteIssueRepository::defaultReaderPoolSize();
     if (useMemoryBackend_) {
-      return std::make_unique<SQLiteIssueRepository>(":memory:");
+      return std::make_unique<SQLiteIssueRepository>(":memory:", readers,
+                                                     profile_);
     }
-    return std::make_unique<SQLiteIssueRepository>(dbPath);
+    return std::make_unique<SQLiteIssueRepository>(dbPath, readers,
+                                                   profile_);
   }
 
-  std::unique_ptr<IssueService> buildIssueService(
-      const std::string& dbPath) const {
-    return std::make_unique<IssueService>(buildRepository(dbPath));
+  static std::string fileKey(const std::string& dbPath) {
+    return std::filesystem::absolute(dbPath).lexically_normal().string();
+  }
+
+  // Opens (and migrates) dbPath, then warms it if asked. Reads only
+  // settings fixed at construction, so it runs without mutex_.
+  std::unique_ptr<IssueService> buildService(const std::string& dbPath,
+                                             bool warm) const {
+    auto repository = buildRepository(dbPath);
+    if (warm) {
+      repository->warmUp();
+    }
+    if (profile_.writeBatch > 0) {
+      GroupCommitQueue::Limits batching;
+      batching.maxBatch = profile_.writeBatch;
+      batching.maxDelay =
+          std::chrono::microseconds(profile_.writeBatchDelayUs);
+      return std::make_unique<IssueService>(std::move(repository), batching);
+    }
+    return std::make_unique<IssueService>(std::move(repository));
+  }
+
+  // Returns the live service for dbPath if a request still holds one,
+  // so a file never has two services (and two writers) at once.
+  std::shared_ptr<IssueService> serviceFor(const std::string& dbPath) {
+    if (auto live = services_[fileKey(dbPath)].lock()) {
+      return live;
+    }
+    return adopt(dbPath, buildService(dbPath, false));
+  }
+
+  // Registers a service built for dbPath, unless one went live while it
+  // was being built, in which case that one is returned instead.
+  std::shared_ptr<IssueService> adopt(const std::string& dbPath,
+                                      std::unique_ptr<IssueService> built) {
+    const std::string key = fileKey(dbPath);
+    if (auto live = services_[key].lock()) {
+      return live;
+    }
+    auto openFiles = openFiles_;
+    holdFile(*openFiles, key);
+    std::shared_ptr<IssueService> service(
+        built.release(), [openFiles, key](IssueService* closing) {
+          delete closing;
+          releaseFile(*openFiles, key);
+        });
+    services_[key] = service;
+    return service;
+  }
+
+  // Counts key as open, so closeFile waits for the matching releaseFile.
+  static void holdFile(OpenFiles& openFiles, const std::string& key) {
+    std::lock_guard<std::mutex> lock(openFiles.mutex);
+    ++openFiles.counts[key];
+  }
+
+  static void releaseFile(OpenFiles& openFiles, const std::string& key) {
+    {
+      std::lock_guard<std::mutex> lock(openFiles.mutex);
+      if (--openFiles.counts[key] == 0) {
+        openFiles.counts.erase(key);
+      }
+    }
+    openFiles.closed.notify_all();
   }
 
   void resetIssueService(const std::string& dbPath) {
-    issueService_ = buildIssueService(dbPath);
+    issueService_ = serviceFor(dbPath);
     activeDbPath_ = dbPath;
+    activeReady_.notify_all();
+  }
+
+  bool isClosing(const std::string& dbPath) const {
+    return closing_.count(fileKey(dbPath)) != 0;
+  }
+
+  // Drops our reference to the service for dbPath and waits, with lock
+  // on mutex_ released, until every request or backup holding one has
+  // finished and the file is closed. Meanwhile the file is marked
+  // closing, so nothing opens it again, and requests for it wait in
+  // getIssueService if it is the active one. Gives up after the
+  // profile's busy timeout and hands the still-open service back, so a
+  // long export or backup fails the caller rather than stalling the
+  // server. Returns whether the file was closed. Needed before moving or
+  // removing a file: in WAL mode recent commits live in side files named
+  // after the database until it is closed.
+  bool closeFile(std::unique_lock<std::mutex>& lock,
+                 const std::string& dbPath) {
+    const std::string key = fileKey(dbPath);
+    if (!closing_.insert(key).second) {
+      return false;  // another rename or delete is closing it
+    }
+    if (issueService_ && fileKey(activeDbPath_) == key) {
+      issueService_.reset();
+    }
+    lock.unlock();
+    bool closed = false;
+    {
+      std::unique_lock<std::mutex> filesLock(openFiles_->mutex);
+      closed = openFiles_->closed.wait_for(
+          filesLock, std::chrono::milliseconds(profile_.busyTimeoutMs),
+          [&] { return openFiles_->counts.count(key) == 0; });
+    }
+    lock.lock();
+    closing_.erase(key);
+    if (closed) {
+      services_.erase(key);
+    } else if (!issueService_) {
+      // Still the active file: serve it again from its open service.
+      resetIssueService(activeDbPath_);
+    }
+    return closed;
+  }
+
+  // Body of the switcher thread. Only the latest queued switch is made:
+  // a target superseded while it warmed is closed again unused. If the
+  // target cannot be opened the active database stays as it was.
+  void runSwitcher() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      switchQueued_.wait(
+          lock, [this] { return stopSwitcher_ || !switchTarget_.empty(); });
+      if (stopSwitcher_) {
+        return;
+      }
+      const std::string target = std::move(switchTarget_);
+      const std::uint64_t request = switches_;
+      switchTarget_.clear();
+      warming_ = true;
+      lock.unlock();
+
+      std::unique_ptr<IssueService> built;
+      std::string failure;
+      try {
+        built = buildService(target, true);
+      } catch (const std::exception& ex) {
+        // Left unbuilt: the switch is dropped.
+        failure = ex.what();
+      }
+
+      lock.lock();
+      warming_ = false;
+      if (!built && request == switches_) {
+        const std::string name =
+            std::filesystem::path(target).filename().string();
+        std::cerr << "Switch to database " << name << " failed: " << failure
+                  << std::endl;
+        switchFailure_ = SwitchFailure{name, failure};
+      }
+      if (built && request == switches_ && !stopSwitcher_) {
+        issueService_ = adopt(target, std::move(built));
+        activeDbPath_ = target;
+        activeReady_.notify_all();
+      }
+      if (switchTarget_.empty()) {
+        switchSettled_.notify_all();
+      }
+      if (built) {
+        lock.unlock();
+        built.reset();
+        lock.lock();
+      }
+    }
+  }
+
+  // Waits, with lock held on mutex_, until no switch is queued or
+  // warming, so a file a pending switch is about to open is not moved or
+  // removed underneath it.
+  void settleSwitch(std::unique_lock<std::mutex>& lock) {
+    switchSettled_.wait(
+        lock, [this] { return switchTarget_.empty() && !warming_; });
+  }
+
+  // Body of a backup thread. The snapshot is written under a name
+  // listDatabases skips and renamed into place once complete, so it only
+  // ever shows up whole. The source handle keeps the source open for the
+  // whole copy, like any request. Without one (the source was not open),
+  // the source is opened here, off the request path, and registered like
+  // a switch target; startBackup held the file for it until then.
+  void runBackup(std::shared_ptr<IssueService> source,
+                 const std::shared_ptr<BackupJob>& job,
+                 const std::string& sourcePath,
+                 const std::string& targetPath) {
+    const std::string partialPath = targetPath + ".partial";
+    std::string failure;
+    try {
+      if (!source) {
+        std::unique_ptr<IssueService> built;
+        try {
+          built = buildService(sourcePath, false);
+        } catch (...) {
+          releaseFile(*openFiles_, fileKey(sourcePath));
+          throw;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        source = adopt(sourcePath, std::move(built));
+        releaseFile(*openFiles_, fileKey(sourcePath));
+      }
+      const bool complete = source->backupTo(
+          partialPath, kBackupPagesPerStep, [&](int copied, int total) {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->status.pagesCopied = copied;
+            job->status.pagesTotal = total;
+            return !stopping_.load();
+          });
+      source.reset();
+      if (!complete) {
+        throw std::runtime_error("Backup abandoned at shutdown");
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (std::filesystem::exists(targetPath)) {
+        throw std::runtime_error("Database already exists");
+      }
+      std::filesystem::rename(partialPath, targetPath);
+    } catch (const std::exception& ex) {
+      failure = ex.what();
+      std::error_code ec;
+      std::filesystem::remove(partialPath, ec);
+    }
+
+    std::lock_guard<std::mutex> lock(job->mutex);
+    job->status.state = failure.empty() ? BackupStatus::State::kDone
+                                        : BackupStatus::State::kFailed;
+    job->status.error = failure;
   }
 
  public:
   DatabaseService()
       : useMemoryBackend_(isMemoryBackendConfigured()),
         activeDbPath_(resolveInitialDbPath()),
-        dbDirectory_(resolveDirectory(activeDbPath_)) {
+        dbDirectory_(resolveDirectory(activeDbPath_)),
+        profile_(StorageProfile::load(defaultDbPath())),
+        openFiles_(std::make_shared<OpenFiles>()) {
     ensureDbDirectoryExists();
-    issueService_ = buildIssueService(activeDbPath_);
+    issueService_ = serviceFor(activeDbPath_);
+    if (!useMemoryBackend_) {
+      switcher_ = std::thread(&DatabaseService::runSwitcher, this);
+    }
   }
 
-  IssueService& getIssueService() const { return *issueService_; }
+  // Drops a pending switch, abandons running backups (removing their
+  // partial files) and waits for their threads.
+  ~DatabaseService() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopSwitcher_ = true;
+    }
+    switchQueued_.notify_all();
+    if (switcher_.joinable()) {
+      switcher_.join();
+    }
+    stopping_ = true;
+    for (auto& entry : backups_) {
+      if (entry.second->thread.joinable()) {
+        entry.second->thread.join();
+      }
+    }
+  }
+
+  // Handle on the active service; keep it for the whole request. Waits
+  // while a rename is closing the active file.
+  std::shared_ptr<IssueService> getIssueService() const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    activeReady_.wait(lock, [this] { return issueService_ != nullptr; });
+    return issueService_;
+  }
+
+  // Whether a service still has database name open, e.g. for a request,
+  // export or backup in progress; a rename or delete fails while that
+  // outlasts the busy timeout.
+  bool isDatabaseInUse(const std::string& name) const {
+    const std::string path = databasePathForName(name);
+    if (path.empty()) {
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(openFiles_->mutex);
+    return openFiles_->counts.count(fileKey(path)) != 0;
+  }
+
+  // Profile every repository is opened with.
+  StorageProfile storageProfile() const { return profile_; }
 
   std::vector<std::string> listDatabases() const {
+    std::lock_guard<std::mutex> lock(mutex_);
     if (useMemoryBackend_) {
       return {":memory:"};
     }
@@ -142,6 +489,7 @@ class DatabaseService {
   }
 
   std::string getActiveDatabaseName() const {
+    std::lock_guard<std::mutex> lock(mutex_);
     if (useMemoryBackend_) {
       return ":memory:";
     }
@@ -149,6 +497,7 @@ class DatabaseService {
   }
 
   bool createDatabase(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
     if (useMemoryBackend_) {
       return false;
     }
@@ -163,9 +512,11 @@ class DatabaseService {
   }
 
   bool deleteDatabase(const std::string& name) {
+    std::unique_lock<std::mutex> lock(mutex_);
     if (useMemoryBackend_) {
       return false;
     }
+    settleSwitch(lock);
     const std::string target = databasePathForName(name);
     if (target.empty()) {
       return false;
@@ -179,29 +530,127 @@ class DatabaseService {
       return false;
     }
 
-    if (!std::filesystem::exists(target)) {
+    if (!std::filesystem::exists(target) || !closeFile(lock, target)) {
       return false;
     }
     return std::filesystem::remove(target);
   }
 
+  // Returns false if there is no such database, and otherwise in
+  // constant time. A database that already has a live service (e.g. one
+  // switched away from that requests still hold) becomes active at once.
+  // Any other is opened, migrated and warmed up on the switcher thread
+  // and swapped in when ready; until then requests keep using the current
+  // database, and requests holding it finish on it after the swap. A
+  // later switch supersedes a pending one. If the target cannot be
+  // opened, lastSwitchFailure says why.
   bool switchDatabase(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
     if (useMemoryBackend_) {
       return false;
     }
     const std::string target = databasePathForName(name);
-    if (target.empty() || !std::filesystem::exists(target)) {
+    if (target.empty() || !std::filesystem::exists(target) ||
+        isClosing(target)) {
       return false;
     }
-    resetIssueService(target);
+    ++switches_;
+    switchFailure_.reset();
+    if (auto live = services_[fileKey(target)].lock()) {
+      issueService_ = live;
+      activeDbPath_ = target;
+      activeReady_.notify_all();
+      switchTarget_.clear();
+      if (!warming_) {
+        switchSettled_.notify_all();
+      }
+      return true;
+    }
+    switchTarget_ = target;
+    switchQueued_.notify_one();
     return true;
   }
 
+  // Blocks until the latest switch has been made (or has failed).
+  void awaitSwitch() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    settleSwitch(lock);
+  }
+
+  // Set once the latest switch has failed to open its target, which
+  // leaves the active database as it was; cleared by the next switch.
+  std::optional<SwitchFailure> lastSwitchFailure() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return switchFailure_;
+  }
+
+  // Starts an online backup of database name into a new database called
+  // snapshot and returns at once; the copy runs on a background thread
+  // in small steps, reading one snapshot of the source while requests go
+  // on writing to it. A source that is not open yet is opened on that
+  // thread as well. Progress is reported by backupStatus, and the new
+  // database appears in listDatabases once it is complete. Returns false
+  // if either name is invalid, the source does not exist, the snapshot
+  // already does, or a backup of the source is still running.
+  bool startBackup(const std::string& name, const std::string& snapshot) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (useMemoryBackend_) {
+      return false;
+    }
+    const std::string sourcePath = databasePathForName(name);
+    const std::string targetPath = databasePathForName(snapshot);
+    if (sourcePath.empty() || targetPath.empty() ||
+        !std::filesystem::exists(sourcePath) || isClosing(sourcePath) ||
+        std::filesystem::exists(targetPath) ||
+        fileKey(sourcePath) == fileKey(targetPath)) {
+      return false;
+    }
+    const std::string sourceName = nameWithExtension(name);
+    const std::string targetName = nameWithExtension(snapshot);
+    for (const auto& entry : backups_) {
+      std::lock_guard<std::mutex> jobLock(entry.second->mutex);
+      const BackupStatus& status = entry.second->status;
+      if (status.state == BackupStatus::State::kRunning &&
+          (entry.first == sourceName || status.snapshot == targetName)) {
+        return false;
+      }
+    }
+
+    auto& slot = backups_[sourceName];
+    if (slot && slot->thread.joinable()) {
+      slot->thread.join();  // finished, as checked above
+    }
+    slot = std::make_shared<BackupJob>();
+    slot->status.source = sourceName;
+    slot->status.snapshot = targetName;
+    std::shared_ptr<IssueService> live =
+        services_[fileKey(sourcePath)].lock();
+    if (!live) {
+      holdFile(*openFiles_, fileKey(sourcePath));
+    }
+    slot->thread = std::thread(&DatabaseService::runBackup, this,
+                               std::move(live), slot, sourcePath, targetPath);
+    return true;
+  }
+
+  // Latest backup of database name, if one was started.
+  std::optional<BackupStatus> backupStatus(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = backups_.find(nameWithExtension(name));
+    if (it == backups_.end()) {
+      return std::nullopt;
+    }
+    std::lock_guard<std::mutex> jobLock(it->second->mutex);
+    return it->second->status;
+  }
+
   bool renameDatabase(const std::string& currentName,
                       const std::string& newName) {
+    std::unique_lock<std::mutex> lock(mutex_);
     if (useMemoryBackend_) {
       return false;
     }
+    settleSwitch(lock);
 
     const std::string sourcePath = databasePathForName(currentName);
     const std::string targetPath = databasePathForName(newName);
@@ -219,22 +668,24 @@ class DatabaseService {
       return false;
     }
 
-    std::error_code ec;
-    std::filesystem::rename(sourcePath, targetPath, ec);
-    if (ec) {
+    if (!closeFile(lock, sourcePath)) {
       return false;
     }
-
-    const auto normalizedActive =
-        std::filesystem::absolute(std::filesystem::path(activeDbPath_));
+    // Checked again: either may have changed while the file was closing.
     const auto normalizedTarget =
         std::filesystem::absolute(std::filesystem::path(targetPath));
-    if (normalizedActive ==
-        std::filesystem::absolute(std::filesystem::path(sourcePath))) {
-      resetIssueService(normalizedTarget.string());
-    }
+    const bool renamingActive = fileKey(activeDbPath_) == fileKey(sourcePath);
 
-    return true;
+    std::error_code ec;
+    if (std::filesystem::exists(targetPath)) {
+      ec = std::make_error_code(std::errc::file_exists);
+    } else {
+      std::filesystem::rename(sourcePath, targetPath, ec);
+    }
+    if (renamingActive) {
+      resetIssueService(ec ? activeDbPath_ : normalizedTarget.string());
+    }
+    return !ec;
   }
 };
 
@@ -1,25 +1,65 @@
 #ifndef ISSUE_SERVICE_HPP_
 #define ISSUE_SERVICE_HPP_
 
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <utility>
 #include <iostream>
 
+#include "GroupCommitQueue.hpp"
 #include "IssueTrackerController.hpp"
 #include "IssueRepository.hpp"
 #include "Issue.hpp"
+#include "IssueQuery.hpp"
+#include "IssueSearch.hpp"
+#include "IssueStats.hpp"
+#include "IssueSummary.hpp"
 #include "Comment.hpp"
+#include "CommentPage.hpp"
 #include "User.hpp"
 #include "Milestone.hpp"
+#include "SQLiteIssueRepository.hpp"
+#include "StorageProfile.hpp"
 #include "Tag.hpp"
 
+// Safe to share between request threads. Reads take no lock: the
+// repository gives each one a consistent snapshot of its own, so they never
+// wait on a write in progress. Writes (often read-modify-write sequences in
+// the controller) take the write lock one at a time. With write batching,
+// concurrent writes queue up and take it once per batch, which commits as
+// one transaction; each caller still gets its own result or exception.
 class IssueService {
  private:
   std::unique_ptr<IssueRepository> repo_;
   IssueTrackerController controller_;
+  std::mutex writeMutex_;
+  std::unique_ptr<GroupCommitQueue> writes_;  // null => no batching
+
+  template <typename Fn>
+  auto read(Fn&& fn) {
+    return fn();
+  }
+
+  template <typename Fn>
+  auto write(Fn&& fn) {
+    if (writes_) {
+      return writes_->submit(std::forward<Fn>(fn));
+    }
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    return fn();
+  }
+
+  // Issues may defer their comments to the repository; load them before
+  // returning, so callers never reach the repository behind the service.
+  static Issue loaded(Issue issue) {
+    issue.getComments();
+    return issue;
+  }
 
  public:
   IssueService()
@@ -29,104 +69,184 @@ class IssueService {
       : repo_(std::move(repo)),
         controller_(repo_.get()) {}
 
+  // Batches concurrent writes within batching's limits.
+  IssueService(std::unique_ptr<IssueRepository> repo,
+               const GroupCommitQueue::Limits& batching)
+      : IssueService(std::move(repo)) {
+    writes_ = std::make_unique<GroupCommitQueue>(
+        *repo_, batching, [this](const std::function<void()>& batch) {
+          std::lock_guard<std::mutex> lock(writeMutex_);
+          batch();
+        });
+  }
+
+  // Batch counters; none without write batching.
+  std::optional<GroupCommitQueue::Stats> writeBatchStats() const {
+    if (!writes_) {
+      return std::nullopt;
+    }
+    return writes_->stats();
+  }
+
   Issue createIssue(const std::string& title,
                     const std::string& desc,
                     const std::string& authorId) {
-    return controller_.createIssue(title, desc, authorId);
+    return write([&] {
+      return loaded(controller_.createIssue(title, desc, authorId));
+    });
   }
 
-  Issue getIssue(int id) { return controller_.getIssue(id); }
+  // Ids of the new issues, in order. A batch commits as one unit.
+  std::vector<int> importIssues(const std::vector<Issue>& issues) {
+    return write([&] { return controller_.importIssues(issues); });
+  }
+
+  Issue getIssue(int id) {
+    return read([&] { return loaded(controller_.getIssue(id)); });
+  }
 
   bool updateIssueField(int id,
                         const std::string& field,
                         const std::string& value) {
-    return controller_.updateIssueField(id, field, value);
+    return write([&] {
+      return controller_.updateIssueField(id, field, value);
+    });
   }
 
-  bool deleteIssue(int id) { return controller_.deleteIssue(id); }
+  bool deleteIssue(int id) {
+    return write([&] { return controller_.deleteIssue(id); });
+  }
 
   bool assignUserToIssue(int issueId, const std::string& userId) {
-    return controller_.assignUserToIssue(issueId, userId);
+    return write([&] {
+      return controller_.assignUserToIssue(issueId, userId);
+    });
+  }
+
+  std::vector<Issue> findIssues(const IssueQuery& query) {
+    return read([&] { return controller_.findIssues(query); });
+  }
+
+  IssuePage findIssuePage(const IssueQuery& query,
+                          const IssuePageRequest& page) {
+    return read([&] { return controller_.findIssuePage(query, page); });
+  }
+
+  std::vector<IssueSummary> findIssueSummaries(const IssueQuery& query) {
+    return read([&] { return controller_.findIssueSummaries(query); });
+  }
+
+  IssueSummaryPage findIssueSummaryPage(const IssueQuery& query,
+                                        const IssuePageRequest& page) {
+    return read([&] {
+      return controller_.findIssueSummaryPage(query, page);
+    });
+  }
+
+  IssueStats countIssues(const IssueQuery& query) {
+    return read([&] { return controller_.countIssues(query); });
+  }
+
+  SearchPage searchIssues(const SearchRequest& request) {
+    return read([&] { return controller_.searchIssues(request); });
   }
 
   std::vector<Issue> findIssuesByStatus(const std::string& status) {
-    return controller_.findIssuesByStatus(status);
+    return read([&] { return controller_.findIssuesByStatus(status); });
   }
 
   bool unassignUserFromIssue(int issueId) {
-    return controller_.unassignUserFromIssue(issueId);
+    return write([&] { return controller_.unassignUserFromIssue(issueId); });
   }
 
   std::vector<Issue> listAllIssues() {
-    return controller_.listAllIssues();
+    return read([&] { return controller_.listAllIssues(); });
   }
 
   std::vector<Issue> listAllUnassignedIssues() {
-    return controller_.listAllUnassignedIssues();
+    return read([&] { return controller_.listAllUnassignedIssues(); });
   }
 
   // ✅ KEEP ONLY THIS ONE
   std::vector<Issue> findIssuesByUserId(const std::string& userId) {
-    return controller_.findIssuesByUserId(userId);
+    return read([&] { return controller_.findIssuesByUserId(userId); });
   }
 
   Comment addCommentToIssue(int issueId,
                             const std::string& text,
                             const std::string& authorId) {
-    return controller_.addCommentToIssue(issueId, text, authorId);
+    return write([&] {
+      return controller_.addCommentToIssue(issueId, text, authorId);
+    });
   }
 
   bool updateComment(int issueId,
                      int commentId,
                      const std::string& newText) {
-    return controller_.updateComment(issueId, commentId, newText);
+    return write([&] {
+      return controller_.updateComment(issueId, commentId, newText);
+    });
   }
 
   bool deleteComment(int issueId, int commentId) {
-    return controller_.deleteComment(issueId, commentId);
+    return write([&] {
+      return controller_.deleteComment(issueId, commentId);
+    });
   }
 
   std::vector<Comment> getAllComments(int issueId) {
-    return controller_.getallComments(issueId);
+    return read([&] { return controller_.getallComments(issueId); });
+  }
+
+  CommentPage getCommentPage(int issueId, const CommentPageRequest& page) {
+    return read([&] { return controller_.getCommentPage(issueId, page); });
+  }
+
+  IssueDigest getIssueDigest(int issueId, std::size_t latest) {
+    return read([&] { return controller_.getIssueDigest(issueId, latest); });
   }
 
   User createUser(const std::string& name, const std::string& role) {
-    return controller_.createUser(name, role);
+    return write([&] { return controller_.createUser(name, role); });
   }
 
   bool updateUser(const std::string& userId,
                   const std::string& field,
                   const std::string& value) {
-    return controller_.updateUser(userId, field, value);
+    return write([&] {
+      return controller_.updateUser(userId, field, value);
+    });
   }
 
   bool removeUser(const std::string& userId) {
-    return controller_.removeUser(userId);
+    return write([&] { return controller_.removeUser(userId); });
   }
 
   std::vector<User> listAllUsers() {
-    return controller_.listAllUsers();
+    return read([&] { return controller_.listAllUsers(); });
   }
 
   bool addTagToIssue(int issueId, const Tag& tag) {
-    return controller_.addTagToIssue(issueId, tag);
+    return write([&] { return controller_.addTagToIssue(issueId, tag); });
   }
   std::vector<Tag> listAllTags() {
-    return controller_.listAllTags();
+    return read([&] { return controller_.listAllTags(); });
   }
   bool deleteTagDefinition(const std::string& tag) {
-    return controller_.deleteTagDefinition(tag);
+    return write([&] { return controller_.deleteTagDefinition(tag); });
   }
   std::vector<Issue> findIssuesByTag(const std::string& tag) {
-    return controller_.findIssuesByTag(tag);
+    return read([&] { return controller_.findIssuesByTag(tag); });
   }
 
   std::vector<Issue> findIssuesByTags(const std::vector<std::string>& tags) {
-    return controller_.findIssuesByTags(tags);
+    return read([&] { return controller_.findIssuesByTags(tags); });
   }
 
   bool removeTagFromIssue(int issueId, const std::string& tag) {
-    return controller_.removeTagFromIssue(issueId, tag);
+    return write([&] {
+      return controller_.removeTagFromIssue(issueId, tag);
+    });
   }
 
   Milestone createMilestone(
@@ -135,15 +255,17 @@ class IssueService {
     const std::string& start,
     const std::string& end) {
   std::cout << "Creating milestone: " << name << std::endl;
-  return controller_.createMilestone(name, desc, start, end);
+  return write([&] {
+    return controller_.createMilestone(name, desc, start, end);
+  });
 }
 
 std::vector<Milestone> listAllMilestones() {
-  return controller_.listAllMilestones();
+  return read([&] { return controller_.listAllMilestones(); });
 }
 
 Milestone getMilestone(int id) {
-  return controller_.getMilestone(id);
+  return read([&] { return controller_.getMilestone(id); });
 }
 
 Milestone updateMilestone(int id,
@@ -151,23 +273,88 @@ Milestone updateMilestone(int id,
                           const std::optional<std::string>& desc,
                           const std::optional<std::string>& start,
                           const std::optional<std::string>& end) {
-  return controller_.updateMilestone(id, name, desc, start, end);
+  return write([&] {
+    return controller_.updateMilestone(id, name, desc, start, end);
+  });
 }
 
 bool deleteMilestone(int id, bool cascade) {
-  return controller_.deleteMilestone(id, cascade);
+  return write([&] { return controller_.deleteMilestone(id, cascade); });
 }
 
 bool addIssueToMilestone(int mId, int issueId) {
-  return controller_.addIssueToMilestone(mId, issueId);
+  return write([&] { return controller_.addIssueToMilestone(mId, issueId); });
 }
 
 bool removeIssueFromMilestone(int mId, int issueId) {
-  return controller_.removeIssueFromMilestone(mId, issueId);
+  return write([&] {
+    return controller_.removeIssueFromMilestone(mId, issueId);
+  });
 }
 
 std::vector<Issue> getIssuesForMilestone(int mId) {
-  return controller_.getIssuesForMilestone(mId);
+  return read([&] { return controller_.getIssuesForMilestone(mId); });
+}
+
+MilestoneStats getMilestoneStatistics(int mId) {
+  return read([&] { return controller_.getMilestoneStatistics(mId); });
+}
+
+std::vector<Milestone> findMilestonesByDateRange(const std::string& from,
+                                                 const std::string& to) {
+  return read([&] {
+    return controller_.findMilestonesByDateRange(from, to);
+  });
+}
+
+std::vector<Milestone> getActiveMilestones(const std::string& onDate) {
+  return read([&] { return controller_.getActiveMilestones(onDate); });
+}
+
+std::vector<Milestone> getCompletedMilestones() {
+  return read([&] { return controller_.getCompletedMilestones(); });
+}
+
+// Storage settings as the repository's connections report them; none for
+// a repository that is not backed by SQLite.
+std::optional<StorageProfile> storageSettings() {
+  return read([&]() -> std::optional<StorageProfile> {
+    const auto* sqlite =
+        dynamic_cast<const SQLiteIssueRepository*>(repo_.get());
+    if (sqlite == nullptr) {
+      return std::nullopt;
+    }
+    return sqlite->storageSettings();
+  });
+}
+
+// A snapshot of the whole database for a streaming export; none for a
+// repository that is not backed by SQLite. The snapshot keeps later
+// writes out of view, so on a file database a long export never holds up
+// writers. It belongs to the calling thread.
+std::optional<SQLiteIssueRepository::ExportSnapshot> openExport() {
+  return read([&]() -> std::optional<SQLiteIssueRepository::ExportSnapshot> {
+    const auto* sqlite =
+        dynamic_cast<const SQLiteIssueRepository*>(repo_.get());
+    if (sqlite == nullptr) {
+      return std::nullopt;
+    }
+    return sqlite->openExportSnapshot();
+  });
+}
+
+// Online backup of the repository into targetPath; see
+// SQLiteIssueRepository::backupTo. Like an export it reads a snapshot, so
+// it may run for as long as it needs. Throws
+// std::logic_error for a repository that is not backed by SQLite.
+bool backupTo(const std::string& targetPath, int pagesPerStep,
+              const SQLiteIssueRepository::BackupObserver& onStep) {
+  const auto* sqlite =
+      dynamic_cast<const SQLiteIssueRepository*>(repo_.get());
+  if (sqlite == nullptr) {
+    throw std::logic_error("Backups need a SQLite repository");
+  }
+  return sqlite->backupTo(targetPath, pagesPerStep, onStep);
 }
 
 };
@@ -4,11 +4,21 @@
 #include <chrono>
 #include <cstdlib>
 #include <filesystem>
+#include <atomic>
+#include <fstream>
+#include <future>
+#include <memory>
 #include <optional>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "GroupCommitQueue.hpp"
+#include "SQLiteIssueRepository.hpp"
+#include "StorageProfile.hpp"
 #include "service/DatabaseService.hpp"
+#include "service/IssueService.hpp"
 
 using ::testing::ElementsAre;
 
@@ -64,6 +74,27 @@ class TempDirCleaner {
   std::filesystem::path root_;
 };
 
+// Stalls its first saveIssue until released, leaving that write in
+// progress for as long as a test needs.
+class StalledSaveRepository : public SQLiteIssueRepository {
+ public:
+  using SQLiteIssueRepository::SQLiteIssueRepository;
+
+  Issue saveIssue(const Issue& issue) override {
+    if (!stalled_.exchange(true)) {
+      entered.set_value();
+      release.get_future().wait();
+    }
+    return SQLiteIssueRepository::saveIssue(issue);
+  }
+
+  std::promise<void> entered;
+  std::promise<void> release;
+
+ private:
+  std::atomic<bool> stalled_{false};
+};
+
 }  // namespace
 
 TEST(DatabaseServiceTest, MemoryBackendShortCircuitsDiskOperations) {
@@ -118,12 +149,287 @@ TEST(DatabaseServiceTest, CreateListSwitchAndDeleteDatabases) {
   EXPECT_THAT(dbs, ElementsAre("alpha.db", "base.db"));
 
   EXPECT_TRUE(service.switchDatabase("alpha"));
+  EXPECT_FALSE(service.switchDatabase("missing"));
+  service.awaitSwitch();
   EXPECT_EQ(service.getActiveDatabaseName(), "alpha.db");
   EXPECT_FALSE(service.deleteDatabase("alpha"));
   EXPECT_FALSE(service.deleteDatabase("missing"));
 
   EXPECT_TRUE(service.switchDatabase("base.db"));
+  service.awaitSwitch();
   EXPECT_TRUE(service.deleteDatabase("alpha"));
   auto afterDelete = service.listDatabases();
   EXPECT_THAT(afterDelete, ElementsAre("base.db"));
 }
+
+TEST(DatabaseServiceTest, HandlesOutliveSwitchAndRenameKeepsData) {
+  const auto tempRoot = makeTempRoot();
+  const auto basePath = tempRoot / "base.db";
+  TempDirCleaner cleanup(tempRoot);
+
+  EnvVarGuard backend("ISSUE_REPO_BACKEND", "sqlite");
+  EnvVarGuard dbPath("ISSUE_DB_PATH", basePath.string());
+
+  DatabaseService service;
+  ASSERT_TRUE(service.createDatabase("alpha"));
+
+  {
+    auto baseHandle = service.getIssueService();
+    baseHandle->createUser("dev", "Developer");
+    ASSERT_TRUE(service.switchDatabase("alpha"));
+
+    // The switched-away service stays usable while the handle is held,
+    // and switching back reuses it rather than opening a second writer.
+    baseHandle->createIssue("Kept", "desc", "dev");
+    ASSERT_TRUE(service.switchDatabase("base"));
+    EXPECT_EQ(service.getIssueService(), baseHandle);
+  }
+
+  ASSERT_TRUE(service.renameDatabase("base", "renamed"));
+  EXPECT_EQ(service.getActiveDatabaseName(), "renamed.db");
+  auto issues = service.getIssueService()->listAllIssues();
+  ASSERT_EQ(issues.size(), 1u);
+  EXPECT_EQ(issues[0].getTitle(), "Kept");
+}
+
+TEST(DatabaseServiceTest, SwitchWarmsTargetInBackgroundAndLatestWins) {
+  const auto tempRoot = makeTempRoot();
+  const auto basePath = tempRoot / "base.db";
+  TempDirCleaner cleanup(tempRoot);
+
+  EnvVarGuard backend("ISSUE_REPO_BACKEND", "sqlite");
+  EnvVarGuard dbPath("ISSUE_DB_PATH", basePath.string());
+
+  DatabaseService service;
+  ASSERT_TRUE(service.createDatabase("alpha"));
+  ASSERT_TRUE(service.createDatabase("beta"));
+
+  auto baseHandle = service.getIssueService();
+  ASSERT_TRUE(service.switchDatabase("alpha"));
+  ASSERT_TRUE(service.switchDatabase("beta"));
+  // The handle taken before the switch stays on its database.
+  baseHandle->createUser("dev", "Developer");
+  service.awaitSwitch();
+  EXPECT_EQ(service.getActiveDatabaseName(), "beta.db");
+  EXPECT_TRUE(service.getIssueService()->listAllUsers().empty());
+
+  // A database whose service is still held switches back at once.
+  ASSERT_TRUE(service.switchDatabase("base"));
+  EXPECT_EQ(service.getActiveDatabaseName(), "base.db");
+  EXPECT_EQ(service.getIssueService(), baseHandle);
+
+  // Renames wait for a pending switch rather than moving its file.
+  ASSERT_TRUE(service.switchDatabase("alpha"));
+  ASSERT_TRUE(service.renameDatabase("alpha", "gamma"));
+  EXPECT_EQ(service.getActiveDatabaseName(), "gamma.db");
+}
+
+TEST(DatabaseServiceTest, FailedSwitchIsRecordedAndClearedByTheNext) {
+  const auto tempRoot = makeTempRoot();
+  const auto basePath = tempRoot / "base.db";
+  TempDirCleaner cleanup(tempRoot);
+
+  EnvVarGuard backend("ISSUE_REPO_BACKEND", "sqlite");
+  EnvVarGuard dbPath("ISSUE_DB_PATH", basePath.string());
+
+  DatabaseService service;
+  ASSERT_TRUE(service.createDatabase("alpha"));
+  std::ofstream(tempRoot / "broken.db") << "not a database";
+
+  ASSERT_TRUE(service.switchDatabase("broken"));
+  service.awaitSwitch();
+  EXPECT_EQ(service.getActiveDatabaseName(), "base.db");
+  auto failure = service.lastSwitchFailure();
+  ASSERT_TRUE(failure.has_value());
+  EXPECT_EQ(failure->target, "broken.db");
+  EXPECT_FALSE(failure->error.empty());
+
+  ASSERT_TRUE(service.switchDatabase("alpha"));
+  service.awaitSwitch();
+  EXPECT_EQ(service.getActiveDatabaseName(), "alpha.db");
+  EXPECT_FALSE(service.lastSwitchFailure().has_value());
+}
+
+TEST(DatabaseServiceTest, BackupRunsInBackgroundAndListsSnapshot) {
+  const auto tempRoot = makeTempRoot();
+  const auto basePath = tempRoot / "base.db";
+  TempDirCleaner cleanup(tempRoot);
+
+  EnvVarGuard backend("ISSUE_REPO_BACKEND", "sqlite");
+  EnvVarGuard dbPath("ISSUE_DB_PATH", basePath.string());
+
+  DatabaseService service;
+  auto issues = service.getIssueService();
+  issues->createUser("dev", "Developer");
+  // Large enough to take several backup steps.
+  for (int i = 0; i < 300; ++i) {
+    issues->createIssue("Issue " + std::to_string(i),
+                        std::string(4000, 'x'), "dev");
+  }
+
+  EXPECT_FALSE(service.backupStatus("base").has_value());
+  EXPECT_FALSE(service.startBackup("missing", "copy"));
+  EXPECT_FALSE(service.startBackup("base", "base"));
+  EXPECT_FALSE(service.startBackup("base", ".."));
+  ASSERT_TRUE(service.startBackup("base", "copy"));
+
+  // Writes carry on while the backup copies its snapshot.
+  issues->createIssue("During", "", "dev");
+  std::optional<DatabaseService::BackupStatus> status;
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(30);
+  while ((status = service.backupStatus("base.db")) &&
+         status->state == DatabaseService::BackupStatus::State::kRunning &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_TRUE(status.has_value());
+  EXPECT_EQ(status->state, DatabaseService::BackupStatus::State::kDone)
+      << status->error;
+  EXPECT_EQ(status->source, "base.db");
+  EXPECT_EQ(status->snapshot, "copy.db");
+  EXPECT_GT(status->pagesTotal, 256);
+  EXPECT_EQ(status->pagesCopied, status->pagesTotal);
+  EXPECT_THAT(service.listDatabases(), ElementsAre("base.db", "copy.db"));
+  EXPECT_FALSE(service.startBackup("base", "copy"));
+
+  ASSERT_TRUE(service.switchDatabase("copy"));
+  service.awaitSwitch();
+  const std::size_t copied =
+      service.getIssueService()->listAllIssues().size();
+  EXPECT_TRUE(copied == 300u || copied == 301u) << copied;
+
+  // A source nobody has open is opened by the backup thread.
+  ASSERT_TRUE(service.createDatabase("cold"));
+  ASSERT_TRUE(service.startBackup("cold", "cold-copy"));
+  while ((status = service.backupStatus("cold")) &&
+         status->state == DatabaseService::BackupStatus::State::kRunning &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_TRUE(status.has_value());
+  EXPECT_EQ(status->state, DatabaseService::BackupStatus::State::kDone)
+      << status->error;
+  EXPECT_TRUE(service.deleteDatabase("cold"));
+  EXPECT_THAT(service.listDatabases(),
+              ElementsAre("base.db", "cold-copy.db", "copy.db"));
+}
+
+TEST(DatabaseServiceTest, StorageProfileFromConfigFileAndEnvironment) {
+  const auto tempRoot = makeTempRoot();
+  const auto basePath = tempRoot / "base.db";
+  TempDirCleaner cleanup(tempRoot);
+  std::filesystem::create_directories(tempRoot);
+  {
+    std::ofstream config(tempRoot / "storage.conf");
+    config << "# tuned for bulk loads\n"
+           << "profile = throughput\n"
+           << "cache_size = -4096\n";
+  }
+
+  EnvVarGuard backend("ISSUE_REPO_BACKEND", "sqlite");
+  EnvVarGuard dbPath("ISSUE_DB_PATH", basePath.string());
+  EnvVarGuard preset("ISSUE_DB_PROFILE", "balanced");
+  EnvVarGuard synchronous("ISSUE_DB_SYNCHRONOUS", "full");
+  EnvVarGuard writeBatch("ISSUE_DB_WRITE_BATCH", "16");
+
+  StorageProfile expected = StorageProfile::preset("balanced");
+  expected.cacheSize = -4096;
+  expected.synchronous = "FULL";
+  expected.writeBatch = 16;
+  {
+    DatabaseService service;
+    EXPECT_EQ(service.storageProfile(), expected);
+    EXPECT_EQ(service.getIssueService()->storageSettings(), expected);
+
+    auto issues = service.getIssueService();
+    const User author = issues->createUser("author", "Developer");
+    issues->createIssue("Batched", "desc", author.getName());
+    ASSERT_TRUE(issues->writeBatchStats().has_value());
+    EXPECT_EQ(issues->writeBatchStats()->units, 2u);
+    EXPECT_EQ(issues->listAllIssues().front().getTitle(), "Batched");
+
+    ASSERT_TRUE(service.createDatabase("alpha"));
+    ASSERT_TRUE(service.switchDatabase("alpha"));
+    service.awaitSwitch();
+    EXPECT_EQ(service.getActiveDatabaseName(), "alpha.db");
+    EXPECT_EQ(service.getIssueService()->storageSettings(), expected);
+  }
+
+  EnvVarGuard badTimeout("ISSUE_DB_BUSY_TIMEOUT", "soon");
+  EXPECT_THROW(DatabaseService(), std::invalid_argument);
+}
+
+TEST(DatabaseServiceTest, IssueServiceReadsDoNotWaitForWrites) {
+  const auto tempRoot = makeTempRoot();
+  TempDirCleaner cleanup(tempRoot);
+  std::filesystem::create_directories(tempRoot);
+
+  for (const bool batched : {false, true}) {
+    const auto path = tempRoot / (batched ? "batched.db" : "direct.db");
+    auto repo = std::make_unique<StalledSaveRepository>(path.string(), 2);
+    StalledSaveRepository* stalled = repo.get();
+    auto service =
+        batched ? std::make_unique<IssueService>(std::move(repo),
+                                                 GroupCommitQueue::Limits{})
+                : std::make_unique<IssueService>(std::move(repo));
+    const User author = service->createUser("author", "Developer");
+
+    auto writing = std::async(std::launch::async, [&] {
+      return service->createIssue("Stalled", "", author.getName());
+    });
+    stalled->entered.get_future().wait();
+
+    auto reading = std::async(std::launch::async, [&] {
+      return service->listAllUsers().size();
+    });
+    EXPECT_EQ(reading.wait_for(std::chrono::seconds(5)),
+              std::future_status::ready)
+        << (batched ? "batched" : "direct");
+    stalled->release.set_value();
+    EXPECT_EQ(reading.get(), 1u);
+    EXPECT_EQ(writing.get().getTitle(), "Stalled");
+  }
+}
+
+TEST(DatabaseServiceTest, FileInUseFailsRenameAndDeleteWithoutBlocking) {
+  const auto tempRoot = makeTempRoot();
+  const auto basePath = tempRoot / "base.db";
+  TempDirCleaner cleanup(tempRoot);
+
+  EnvVarGuard backend("ISSUE_REPO_BACKEND", "sqlite");
+  EnvVarGuard dbPath("ISSUE_DB_PATH", basePath.string());
+  EnvVarGuard busyTimeout("ISSUE_DB_BUSY_TIMEOUT", "300");
+
+  DatabaseService service;
+  ASSERT_TRUE(service.createDatabase("alpha"));
+  ASSERT_TRUE(service.switchDatabase("alpha"));
+  service.awaitSwitch();
+  auto alphaHandle = service.getIssueService();
+  ASSERT_TRUE(service.switchDatabase("base"));
+  service.awaitSwitch();
+
+  auto deleting = std::async(std::launch::async,
+                             [&] { return service.deleteDatabase("alpha"); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  // Requests and other database calls carry on while it waits.
+  EXPECT_TRUE(service.getIssueService()->listAllUsers().empty());
+  EXPECT_THAT(service.listDatabases(), ElementsAre("alpha.db", "base.db"));
+  EXPECT_EQ(deleting.wait_for(std::chrono::seconds(0)),
+            std::future_status::timeout);
+  EXPECT_FALSE(deleting.get());
+  EXPECT_TRUE(service.isDatabaseInUse("alpha"));
+
+  // The active database is served again after a rename gives up.
+  auto baseHandle = service.getIssueService();
+  EXPECT_FALSE(service.renameDatabase("base", "renamed"));
+  EXPECT_EQ(service.getActiveDatabaseName(), "base.db");
+  EXPECT_EQ(service.getIssueService(), baseHandle);
+  baseHandle.reset();
+  EXPECT_TRUE(service.renameDatabase("base", "renamed"));
+  EXPECT_EQ(service.getActiveDatabaseName(), "renamed.db");
+
+  alphaHandle.reset();
+  EXPECT_FALSE(service.isDatabaseInUse("alpha"));
+  EXPECT_TRUE(service.deleteDatabase("alpha"));
+}
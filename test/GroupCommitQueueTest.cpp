@@ -0,0 +1,118 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GroupCommitQueue.hpp"
+#include "Issue.hpp"
+#include "SQLiteIssueRepository.hpp"
+
+using ::testing::SizeIs;
+
+class GroupCommitQueueTest : public ::testing::Test {
+ protected:
+  GroupCommitQueueTest()
+      : root(std::filesystem::temp_directory_path() /
+             ("group-commit-" +
+              std::to_string(std::chrono::steady_clock::now()
+                                 .time_since_epoch()
+                                 .count()))) {
+    std::filesystem::create_directories(root);
+  }
+
+  ~GroupCommitQueueTest() override {
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+  }
+
+  // A leader that waits long enough for every caller to queue up.
+  static GroupCommitQueue::Limits batchOf(std::size_t size) {
+    GroupCommitQueue::Limits limits;
+    limits.maxBatch = size;
+    limits.maxDelay = std::chrono::seconds(10);
+    return limits;
+  }
+
+  std::string dbPath() const { return (root / "issues.db").string(); }
+
+  std::filesystem::path root;
+};
+
+TEST_F(GroupCommitQueueTest, ConcurrentWritesShareOneCommit) {
+  constexpr int kClients = 4;
+  SQLiteIssueRepository repository(dbPath(), 2);
+  GroupCommitQueue queue(repository, batchOf(kClients));
+
+  std::vector<int> ids(kClients, 0);
+  std::vector<std::thread> clients;
+  for (int i = 0; i < kClients; ++i) {
+    clients.emplace_back([&, i] {
+      ids[i] = queue.submit([&] {
+        return repository.saveIssue(
+            Issue(0, "author", "Issue " + std::to_string(i))).getId();
+      });
+    });
+  }
+  for (auto& client : clients) {
+    client.join();
+  }
+
+  EXPECT_EQ(std::set<int>(ids.begin(), ids.end()).size(), 4u);
+  EXPECT_THAT(repository.listIssues(), SizeIs(kClients));
+  EXPECT_EQ(queue.stats().units, 4u);
+  EXPECT_EQ(queue.stats().batches, 1u);
+
+  GroupCommitQueue::Limits alone;
+  alone.maxBatch = 8;
+  GroupCommitQueue eager(repository, alone);
+  EXPECT_EQ(eager.submit([&] {
+    return repository.saveIssue(Issue(0, "author", "Alone")).getTitle();
+  }), "Alone");
+  EXPECT_EQ(eager.stats().batches, 1u);
+
+  alone.maxBatch = 0;
+  EXPECT_THROW(GroupCommitQueue(repository, alone), std::invalid_argument);
+}
+
+TEST_F(GroupCommitQueueTest, FailedUnitFailsOnlyItsCaller) {
+  constexpr int kClients = 3;
+  SQLiteIssueRepository repository(dbPath(), 2);
+  GroupCommitQueue queue(repository, batchOf(kClients));
+
+  std::vector<std::string> outcomes(kClients);
+  std::vector<std::thread> clients;
+  for (int i = 0; i < kClients; ++i) {
+    clients.emplace_back([&, i] {
+      try {
+        queue.run([&] {
+          repository.saveIssue(
+              Issue(0, "author", "Issue " + std::to_string(i)));
+          if (i == 1) {
+            throw std::runtime_error("rejected");
+          }
+        });
+        outcomes[i] = "saved";
+      } catch (const std::runtime_error& error) {
+        outcomes[i] = error.what();
+      }
+    });
+  }
+  for (auto& client : clients) {
+    client.join();
+  }
+
+  EXPECT_EQ(outcomes,
+            (std::vector<std::string>{"saved", "rejected", "saved"}));
+  EXPECT_EQ(queue.stats().batches, 1u);
+  std::set<std::string> titles;
+  for (const Issue& issue : repository.listIssues()) {
+    titles.insert(issue.getTitle());
+  }
+  EXPECT_EQ(titles, (std::set<std::string>{"Issue 0", "Issue 2"}));
+}
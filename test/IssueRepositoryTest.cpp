@@ -2,9 +2,11 @@
 #include <gtest/gtest.h>
 
 #include <cstdlib>
+#include <string>
 
 #include "Comment.hpp"
 #include "Issue.hpp"
+#include "IssueQuery.hpp"
 #include "IssueRepository.hpp"
 #include "User.hpp"
 
@@ -122,6 +124,32 @@ TEST_F(InMemoryIssueRepositoryTest, ListAllUnassigned) {
   }
 }
 
+TEST_F(InMemoryIssueRepositoryTest, FindIssuePageWalksCursor) {
+  for (int i = 0; i < 5; ++i) {
+    repository->saveIssue(Issue(0, "user1", "Issue " + std::to_string(i)));
+  }
+
+  IssuePageRequest page;
+  page.limit = 2;
+  IssuePage first = repository->findIssuePage(IssueQuery(), page);
+  ASSERT_THAT(first.issues, SizeIs(2));
+  ASSERT_TRUE(first.next.has_value());
+
+  auto cursor = IssueCursor::decode(first.next->encode());
+  ASSERT_TRUE(cursor.has_value());
+  EXPECT_EQ(cursor->id, first.issues.back().getId());
+
+  page.after = cursor;
+  IssuePage second = repository->findIssuePage(IssueQuery(), page);
+  page.after = second.next;
+  IssuePage last = repository->findIssuePage(IssueQuery(), page);
+  EXPECT_GT(second.issues.front().getId(), first.issues.back().getId());
+  EXPECT_THAT(last.issues, SizeIs(1));
+  EXPECT_FALSE(last.next.has_value());
+  EXPECT_FALSE(IssueCursor::decode("zz").has_value());
+  EXPECT_FALSE(IssueCursor::decode("").has_value());
+}
+
 TEST_F(InMemoryIssueRepositoryTest, SaveAndGetComment) {
   Issue issue(0, "user1", "Test Issue");
   Issue savedIssue = repository->saveIssue(issue);
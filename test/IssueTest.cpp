@@ -2,6 +2,8 @@
 #include "Issue.hpp"
 #include "gtest/gtest.h"
 
+#include <vector>
+
 using std::string;
 
 // -------------------------------
@@ -236,3 +238,31 @@ TEST(IssueModel, TimestampRejectsNegativeValues) {
   is.setTimestamp(123);
   EXPECT_EQ(is.getTimestamp(), 123);
 }
+
+TEST(IssueModel, DeferredCommentsLoadOnceOnFirstAccess) {
+  Issue is{1, "u1", "T", 0};
+  int loads = 0;
+  is.deferComments(0, [&loads] {
+    ++loads;
+    return std::vector<Comment>{Comment(0, "u1", "desc", 1),
+                                Comment(1, "u2", "reply", 2)};
+  });
+
+  is.setStatus("Done");
+  is.assignTo("u2");
+  EXPECT_FALSE(is.commentsLoaded());
+  EXPECT_EQ(loads, 0);
+
+  EXPECT_EQ(is.getDescriptionComment(), "desc");
+  EXPECT_TRUE(is.commentsLoaded());
+  EXPECT_EQ(is.getCommentIds(), (std::vector<int>{0, 1}));
+  ASSERT_NE(is.findCommentById(1), nullptr);
+  EXPECT_EQ(loads, 1);
+
+  // A description id without a loaded comment is dropped.
+  Issue dangling{2, "u1", "T", 0};
+  dangling.deferComments(7, [] { return std::vector<Comment>{}; });
+  dangling.addComment(3);
+  EXPECT_FALSE(dangling.hasDescriptionComment());
+  EXPECT_EQ(dangling.getCommentIds(), (std::vector<int>{3}));
+}
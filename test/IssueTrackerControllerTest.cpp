@@ -1,5 +1,6 @@
 #include <cstdlib>
 #include <memory>
+#include <stdexcept>
 
 #include "IssueTrackerController.hpp"
 #include "SQLiteIssueRepository.hpp"
@@ -11,12 +12,19 @@ using ::testing::Throw;
 
 class MockIssueRepository : public IssueRepository {
  public:
+  MockIssueRepository() {
+    ON_CALL(*this, runInTransaction(testing::_))
+        .WillByDefault([](const std::function<void()>& work) { work(); });
+  }
+
   MOCK_METHOD(Issue, saveIssue, (const Issue& issue), (override));
   MOCK_METHOD(Issue, getIssue, (int id), (const, override));
   MOCK_METHOD(bool, deleteIssue, (int id), (override));
   MOCK_METHOD(std::vector<Issue>, listIssues, (), (const, override));
   MOCK_METHOD(std::vector<Issue>, findIssues,
               (std::function<bool(const Issue&)> criteria), (const, override));
+  MOCK_METHOD(std::vector<Issue>, findIssues, (const IssueQuery& query),
+              (const, override));
   MOCK_METHOD(std::vector<Issue>, findIssues, (const std::string& userId),
               (const, override));
   MOCK_METHOD(std::vector<Issue>, listAllUnassigned, (), (const, override));
@@ -51,6 +59,34 @@ class MockIssueRepository : public IssueRepository {
               (override));
   MOCK_METHOD(std::vector<Issue>, getIssuesForMilestone, (int milestoneId),
               (const, override));
+  MOCK_METHOD(IssuePage, findIssuePage,
+              (const IssueQuery& query, const IssuePageRequest& page),
+              (const, override));
+  MOCK_METHOD(std::vector<IssueSummary>, findIssueSummaries,
+              (const IssueQuery& query), (const, override));
+  MOCK_METHOD(IssueSummaryPage, findIssueSummaryPage,
+              (const IssueQuery& query, const IssuePageRequest& page),
+              (const, override));
+  MOCK_METHOD(IssueStats, countIssues, (const IssueQuery& query),
+              (const, override));
+  MOCK_METHOD(SearchPage, searchIssues, (const SearchRequest& request),
+              (const, override));
+  MOCK_METHOD(std::vector<int>, importIssues,
+              (const std::vector<Issue>& issues), (override));
+  MOCK_METHOD(CommentPage, getCommentPage,
+              (int issueId, const CommentPageRequest& page),
+              (const, override));
+  MOCK_METHOD(IssueDigest, getIssueDigest, (int issueId, std::size_t latest),
+              (const, override));
+  MOCK_METHOD(MilestoneStats, getMilestoneStats, (int milestoneId),
+              (const, override));
+  MOCK_METHOD(std::vector<Milestone>, findMilestonesInRange,
+              (const std::string& from, const std::string& to),
+              (const, override));
+  MOCK_METHOD(std::vector<Milestone>, findCompletedMilestones, (),
+              (const, override));
+  MOCK_METHOD(void, runInTransaction, (const std::function<void()>& work),
+              (override));
 };
 
 TEST(IssueTrackerControllerTest, CreateIssueValid) {
@@ -219,12 +255,11 @@ TEST(IssueTrackerControllerTest, ListAllIssues) {
 
 TEST(IssueTrackerControllerTest, FindIssuesByUserIdUsesCaseInsensitiveMatch) {
   MockIssueRepository mockRepo;
-  EXPECT_CALL(mockRepo,
-              findIssues(testing::A<std::function<bool(const Issue&)>>()))
-      .WillOnce(testing::Invoke([](std::function<bool(const Issue&)> filter) {
+  EXPECT_CALL(mockRepo, findIssues(testing::A<const IssueQuery&>()))
+      .WillOnce(testing::Invoke([](const IssueQuery& query) {
         Issue issue(5, "UserX", "t1", 0);
         std::vector<Issue> matches;
-        if (filter(issue)) {
+        if (query.matches(issue)) {
           matches.push_back(issue);
         }
         return matches;
@@ -636,6 +671,28 @@ TEST_F(IssueTrackerControllerIntegrationTest, MilestoneWorkflow) {
   EXPECT_NO_THROW(controller->getIssue(issue.getId()));
 }
 
+TEST_F(IssueTrackerControllerIntegrationTest, MilestoneProgressAndSchedule) {
+  Issue issue = controller->createIssue("Bug", "", "owner");
+  Milestone milestone = controller->createMilestone("Sprint C", "desc",
+                                                    "2024-05-01", "2024-05-31");
+  controller->addIssueToMilestone(milestone.getId(), issue.getId());
+  EXPECT_THAT(controller->getCompletedMilestones(), SizeIs(0));
+
+  controller->updateIssueField(issue.getId(), "status", "Done");
+  MilestoneStats stats = controller->getMilestoneStatistics(milestone.getId());
+  EXPECT_EQ(stats.total, 1u);
+  EXPECT_EQ(stats.percentComplete(), 100.0);
+  EXPECT_THAT(controller->getCompletedMilestones(), SizeIs(1));
+
+  EXPECT_THAT(controller->getActiveMilestones("2024-05-15"), SizeIs(1));
+  EXPECT_THAT(controller->getActiveMilestones("2024-06-01"), SizeIs(0));
+  EXPECT_THAT(controller->findMilestonesByDateRange("2024-04-01", ""),
+              SizeIs(1));
+  EXPECT_THROW(controller->findMilestonesByDateRange("2024-06-01",
+                                                     "2024-04-01"),
+               std::invalid_argument);
+}
+
 TEST_F(IssueTrackerControllerIntegrationTest,
        CascadeDeleteMilestoneRemovesIssues) {
   Issue issue = controller->createIssue("To delete", "", "owner");
@@ -647,3 +704,60 @@ TEST_F(IssueTrackerControllerIntegrationTest,
   EXPECT_THROW(controller->getIssue(issue.getId()), std::invalid_argument);
   EXPECT_THROW(controller->getMilestone(milestone.getId()), std::out_of_range);
 }
+
+TEST_F(IssueTrackerControllerIntegrationTest, ImportRequiresKnownUsers) {
+  Issue record(0, "owner", "Imported");
+  record.addComment(Comment(0, "owner", "desc"));
+  record.setDescriptionCommentId(0);
+  const std::vector<int> ids = controller->importIssues({record, record});
+  ASSERT_THAT(ids, SizeIs(2));
+  EXPECT_EQ(controller->getIssue(ids[1]).getDescriptionComment(), "desc");
+
+  Issue stranger = record;
+  stranger.addComment(Comment(1, "ghost", "boo"));
+  EXPECT_THROW(controller->importIssues({record, stranger}),
+               std::invalid_argument);
+  record.assignTo("ghost");
+  EXPECT_THROW(controller->importIssues({record}), std::invalid_argument);
+  EXPECT_THAT(controller->listAllIssues(), SizeIs(2));
+}
+
+// Fails the saveIssue call numbered failOn, interrupting a multi-step
+// controller operation after its earlier writes.
+class FailingSaveRepository : public SQLiteIssueRepository {
+ public:
+  FailingSaveRepository() : SQLiteIssueRepository(":memory:") {}
+
+  Issue saveIssue(const Issue& issue) override {
+    if (++saves == failOn) {
+      throw std::runtime_error("disk full");
+    }
+    return SQLiteIssueRepository::saveIssue(issue);
+  }
+
+  int saves = 0;
+  int failOn = 0;
+};
+
+TEST(IssueTrackerControllerUnitOfWorkTest, FailedStepRollsBackEarlierOnes) {
+  FailingSaveRepository repo;
+  IssueTrackerController controller(&repo);
+  controller.createUser("owner", "Owner");
+
+  // The description comment was written before the link failed.
+  repo.failOn = 2;
+  EXPECT_THROW(controller.createIssue("Bug", "desc", "owner"),
+               std::runtime_error);
+  EXPECT_THAT(repo.listIssues(), SizeIs(0));
+
+  Issue created = controller.createIssue("Bug", "desc", "owner");
+  EXPECT_EQ(created.getDescriptionComment(), "desc");
+  Comment reply = controller.addCommentToIssue(created.getId(), "hi", "owner");
+
+  repo.failOn = repo.saves + 1;
+  EXPECT_THROW(controller.deleteComment(created.getId(), reply.getId()),
+               std::runtime_error);
+  EXPECT_THAT(repo.getAllComments(created.getId()), SizeIs(2));
+  EXPECT_TRUE(controller.deleteComment(created.getId(), reply.getId()));
+  EXPECT_THAT(repo.getAllComments(created.getId()), SizeIs(1));
+}
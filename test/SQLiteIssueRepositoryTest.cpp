@@ -0,0 +1,1298 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Comment.hpp"
+#include "CommentPage.hpp"
+#include "Issue.hpp"
+#include "IssueQuery.hpp"
+#include "IssueSearch.hpp"
+#include "IssueSummary.hpp"
+#include "SQLiteIssueRepository.hpp"
+
+using ::testing::SizeIs;
+
+class SQLiteIssueRepositoryTest : public ::testing::Test {
+ protected:
+  SQLiteIssueRepositoryTest()
+      : repository(":memory:",
+                   SQLiteIssueRepository::defaultReaderPoolSize(),
+                   StorageProfile(), true) {}
+
+  // Seeds issues with a description, one extra comment and a tag each.
+  // Every other issue is assigned to "dev" and linked to the milestone.
+  void seedIssues(int count, int milestoneId) {
+    for (int i = 0; i < count; ++i) {
+      Issue issue(0, "author", "Issue " + std::to_string(i));
+      if (i % 2 == 0) {
+        issue.assignTo("dev");
+      }
+      Issue saved = repository.saveIssue(issue);
+      repository.saveComment(saved.getId(), Comment(0, "author", "desc"));
+      repository.saveComment(saved.getId(), Comment(-1, "dev", "reply"));
+      saved.setDescriptionCommentId(0);
+      repository.saveIssue(saved);
+      repository.addTagToIssue(saved.getId(),
+                               Tag("tag" + std::to_string(i % 3), "#fff"));
+      if (i % 2 == 0) {
+        repository.addIssueToMilestone(milestoneId, saved.getId());
+      }
+    }
+  }
+
+  std::size_t statementsFor(const std::function<void()>& work) {
+    const std::size_t before = repository.executedStatementCount();
+    work();
+    return repository.executedStatementCount() - before;
+  }
+
+  SQLiteIssueRepository repository;
+};
+
+TEST_F(SQLiteIssueRepositoryTest, ListIssuesHydratesCommentsAndTags) {
+  Milestone milestone = repository.saveMilestone(
+      Milestone(-1, "M1", "", "2024-01-01", "2024-02-01"));
+  seedIssues(3, milestone.getId());
+
+  std::vector<Issue> issues = repository.listIssues();
+  ASSERT_THAT(issues, SizeIs(3));
+  for (const Issue& issue : issues) {
+    EXPECT_THAT(issue.getComments(), SizeIs(2));
+    EXPECT_EQ(issue.getDescriptionComment(), "desc");
+    EXPECT_THAT(issue.getTags(), SizeIs(1));
+  }
+  EXPECT_LT(issues[0].getId(), issues[1].getId());
+  EXPECT_THAT(repository.listAllUnassigned(), SizeIs(1));
+  EXPECT_THAT(repository.findIssues("dev"), SizeIs(2));
+  EXPECT_THAT(repository.getIssuesForMilestone(milestone.getId()),
+              SizeIs(2));
+}
+
+TEST_F(SQLiteIssueRepositoryTest, ListStatementCountIsIndependentOfRowCount) {
+  Milestone milestone = repository.saveMilestone(
+      Milestone(-1, "M1", "", "2024-01-01", "2024-02-01"));
+
+  std::vector<std::size_t> listCounts;
+  std::vector<std::size_t> unassignedCounts;
+  std::vector<std::size_t> userCounts;
+  std::vector<std::size_t> milestoneCounts;
+
+  for (int batch : {10, 90, 900}) {
+    seedIssues(batch, milestone.getId());
+    listCounts.push_back(statementsFor([&] { repository.listIssues(); }));
+    unassignedCounts.push_back(
+        statementsFor([&] { repository.listAllUnassigned(); }));
+    userCounts.push_back(
+        statementsFor([&] { repository.findIssues("dev"); }));
+    milestoneCounts.push_back(statementsFor(
+        [&] { repository.getIssuesForMilestone(milestone.getId()); }));
+  }
+
+  EXPECT_THAT(repository.listIssues(), SizeIs(1000));
+  for (std::size_t i = 1; i < listCounts.size(); ++i) {
+    EXPECT_EQ(listCounts[i], listCounts[0]);
+    EXPECT_EQ(unassignedCounts[i], unassignedCounts[0]);
+    EXPECT_EQ(userCounts[i], userCounts[0]);
+    EXPECT_EQ(milestoneCounts[i], milestoneCounts[0]);
+  }
+  EXPECT_LE(listCounts[0], 3u);
+}
+
+TEST_F(SQLiteIssueRepositoryTest, MilestoneListingIsOneStatementAtAnySize) {
+  for (int i = 0; i < 6; ++i) {
+    repository.saveIssue(Issue(0, "author", "Issue " + std::to_string(i)));
+  }
+  const std::vector<Issue> issues = repository.listIssues();
+  std::vector<std::size_t> listCounts;
+  int created = 0;
+  for (int batch : {5, 45, 450}) {
+    for (; created < batch; ++created) {
+      Milestone m = repository.saveMilestone(Milestone(
+          -1, "M" + std::to_string(created), "", "2024-01-01", "2024-02-01"));
+      // Every third milestone stays empty.
+      for (int k = 0; k < created % 3; ++k) {
+        repository.addIssueToMilestone(
+            m.getId(), issues[(created + k) % issues.size()].getId());
+      }
+    }
+    listCounts.push_back(
+        statementsFor([&] { repository.listAllMilestones(); }));
+  }
+
+  const std::vector<Milestone> all = repository.listAllMilestones();
+  ASSERT_THAT(all, SizeIs(450));
+  for (const Milestone& m : all) {
+    EXPECT_EQ(m.getIssueIds(),
+              repository.getMilestone(m.getId()).getIssueIds());
+    EXPECT_EQ(m.getIssueCount(), static_cast<std::size_t>(
+                                     std::stoi(m.getName().substr(1)) % 3));
+  }
+  EXPECT_THAT(listCounts, ::testing::Each(1u));
+  EXPECT_EQ(statementsFor([&] { repository.getMilestone(all[1].getId()); }),
+            1u);
+}
+
+TEST_F(SQLiteIssueRepositoryTest, RepeatedCallsReusePreparedStatements) {
+  Issue saved = repository.saveIssue(Issue(0, "author", "Cached"));
+  repository.saveComment(saved.getId(), Comment(-1, "author", "hello"));
+  repository.getComment(saved.getId(), 0);
+  repository.getIssue(saved.getId());
+
+  SqliteStatementCache::Stats warm = repository.statementCacheStats();
+  for (int i = 0; i < 5; ++i) {
+    repository.getComment(saved.getId(), 0);
+    repository.getIssue(saved.getId());
+    repository.saveComment(saved.getId(), Comment(-1, "author", "again"));
+  }
+  SqliteStatementCache::Stats after = repository.statementCacheStats();
+
+  EXPECT_EQ(after.misses, warm.misses);
+  EXPECT_GT(after.hits, warm.hits);
+}
+
+template <typename T>
+std::vector<int> idsOf(const std::vector<T>& items) {
+  std::vector<int> ids;
+  for (const T& item : items) {
+    ids.push_back(item.getId());
+  }
+  return ids;
+}
+
+// Records as an import would send them: description as comment 0, then
+// the replies, with tags and a status of their own.
+std::vector<Issue> importRecords(int count) {
+  std::vector<Issue> records;
+  for (int i = 0; i < count; ++i) {
+    Issue issue(0, "author", "Imported " + std::to_string(i), 1000 + i);
+    issue.addComment(Comment(0, "author", "desc " + std::to_string(i), 5));
+    issue.addComment(Comment(1, "dev", "reply", 6));
+    issue.setDescriptionCommentId(0);
+    issue.setStatus(i % 2 == 0 ? "Done" : "In Progress");
+    issue.assignTo(i % 2 == 0 ? "dev" : "");
+    issue.addTag(Tag("import", "#abc"));
+    records.push_back(issue);
+  }
+  return records;
+}
+
+// Reference answers built from the record-level calls, for checking the
+// compiled queries against.
+std::vector<int> saveRecordByRecord(IssueRepository& repo,
+                                    const std::vector<Issue>& records) {
+  std::vector<int> ids;
+  for (const Issue& record : records) {
+    Issue created(0, record.getAuthorId(), record.getTitle(),
+                  record.getTimestamp());
+    created.setStatus(record.getStatus());
+    created.assignTo(record.getAssignedTo());
+    Issue saved = repo.saveIssue(created);
+    const std::vector<Comment>& comments = record.getComments();
+    for (std::size_t i = 0; i < comments.size(); ++i) {
+      const Comment stored = repo.saveComment(
+          saved.getId(), Comment(i == 0 ? 0 : -1, comments[i].getAuthor(),
+                                 comments[i].getText(),
+                                 comments[i].getTimeStamp()));
+      if (record.hasDescriptionComment() &&
+          comments[i].getId() == record.getDescriptionCommentId()) {
+        saved.setDescriptionCommentId(stored.getId());
+      }
+    }
+    for (const Tag& tag : record.getTags()) {
+      saved.addTag(tag);
+    }
+    repo.saveIssue(saved);
+    ids.push_back(saved.getId());
+  }
+  return ids;
+}
+
+IssuePage slicePage(const IssueRepository& repo, const IssueQuery& query,
+                    const IssuePageRequest& page) {
+  auto keyOf = [&](const Issue& issue) {
+    return std::make_pair(page.sort == IssueSort::kId
+                              ? static_cast<Issue::TimePoint>(issue.getId())
+                              : issue.getCreatedAt(),
+                          issue.getId());
+  };
+  std::vector<Issue> all = repo.findIssues(query);
+  std::sort(all.begin(), all.end(), [&](const Issue& a, const Issue& b) {
+    return keyOf(a) < keyOf(b);
+  });
+  IssuePage result;
+  for (const Issue& issue : all) {
+    if (page.after &&
+        keyOf(issue) <= std::make_pair(page.after->sortKey, page.after->id)) {
+      continue;
+    }
+    if (result.issues.size() == page.limit) {
+      const Issue& last = result.issues.back();
+      result.next = IssueCursor{page.sort, keyOf(last).first, last.getId()};
+      break;
+    }
+    result.issues.push_back(issue);
+  }
+  return result;
+}
+
+CommentPage sliceComments(const IssueRepository& repo, int issueId,
+                          const CommentPageRequest& page) {
+  CommentPage result;
+  for (Comment& comment : repo.getAllComments(issueId)) {
+    if (comment.getId() <= page.after) {
+      continue;
+    }
+    if (result.comments.size() == page.limit) {
+      result.next = result.comments.back().getId();
+      break;
+    }
+    result.comments.push_back(std::move(comment));
+  }
+  return result;
+}
+
+IssueStats tallyIssues(const IssueRepository& repo, const IssueQuery& query) {
+  IssueStats stats;
+  for (const Issue& issue : repo.findIssues(query)) {
+    ++stats.total;
+    ++stats.byStatus[issue.getStatus()];
+    if (issue.hasAssignee()) {
+      ++stats.byAssignee[issue.getAssignedTo()];
+    } else {
+      ++stats.unassigned;
+    }
+    for (const Tag& tag : issue.getTags()) {
+      ++stats.byTag[tag.getName()];
+    }
+  }
+  return stats;
+}
+
+MilestoneStats tallyMilestone(const IssueRepository& repo, int milestoneId) {
+  MilestoneStats stats;
+  stats.milestoneId = milestoneId;
+  for (const Issue& issue : repo.getIssuesForMilestone(milestoneId)) {
+    ++stats.total;
+    ++stats.byStatus[issue.getStatus()];
+    if (IssueQuery::statusKey(issue.getStatus()) == "done") {
+      ++stats.closed;
+    }
+  }
+  return stats;
+}
+
+TEST_F(SQLiteIssueRepositoryTest, ImportMatchesRecordByRecordSaves) {
+  SQLiteIssueRepository fallback(":memory:");
+  const std::vector<int> bulkIds = repository.importIssues(importRecords(3));
+  const std::vector<int> savedIds =
+      saveRecordByRecord(fallback, importRecords(3));
+  EXPECT_EQ(bulkIds, savedIds);
+
+  for (SQLiteIssueRepository* repo : {&repository, &fallback}) {
+    const std::vector<Issue> issues = repo->listIssues();
+    ASSERT_THAT(issues, SizeIs(3));
+    const Issue& first = issues.front();
+    EXPECT_EQ(first.getTitle(), "Imported 0");
+    EXPECT_EQ(first.getTimestamp(), 1000);
+    EXPECT_EQ(first.getStatus(), "Done");
+    EXPECT_EQ(first.getAssignedTo(), "dev");
+    EXPECT_EQ(first.getDescriptionComment(), "desc 0");
+    EXPECT_EQ(idsOf(first.getComments()), (std::vector<int>{0, 1}));
+    EXPECT_EQ(first.getTags().front().getColor(), "#abc");
+    // New comments continue after the imported ones.
+    EXPECT_EQ(repo->saveComment(first.getId(), Comment(-1, "dev", "more"))
+                  .getId(),
+              2);
+  }
+  EXPECT_EQ(repository.searchIssues(SearchRequest{"Imported"}).hits.size(),
+            3u);
+
+  Issue existing = repository.listIssues().front();
+  EXPECT_THROW(repository.importIssues({existing}), std::invalid_argument);
+  EXPECT_THAT(repository.listIssues(), SizeIs(3));
+}
+
+TEST_F(SQLiteIssueRepositoryTest, ImportReusesItsStatementsAtAnySize) {
+  repository.importIssues(importRecords(2));
+  const SqliteStatementCache::Stats warm = repository.statementCacheStats();
+  const std::size_t statements =
+      statementsFor([&] { repository.importIssues(importRecords(200)); });
+
+  EXPECT_EQ(repository.statementCacheStats().misses, warm.misses);
+  EXPECT_THAT(repository.listIssues(), SizeIs(202));
+  // BEGIN and COMMIT, then per issue one INSERT each for the issue, its
+  // two comments, its tag definition and its tag; nothing is read back.
+  EXPECT_EQ(statements, 2u + 200u * 5);
+}
+
+TEST_F(SQLiteIssueRepositoryTest, IssueQueryMatchesPredicateFallback) {
+  Milestone milestone = repository.saveMilestone(
+      Milestone(-1, "M1", "", "2024-01-01", "2024-02-01"));
+  seedIssues(12, milestone.getId());
+  std::vector<Issue> all = repository.listIssues();
+  for (std::size_t i = 0; i < all.size(); ++i) {
+    Issue issue = all[i];
+    issue.setStatus(i % 3 == 0 ? "Done" : "In Progress");
+    repository.saveIssue(issue);
+    repository.addTagToIssue(issue.getId(),
+                             Tag("tag" + std::to_string(i % 3), "#fff"));
+    if (i % 4 == 0) {
+      repository.addTagToIssue(issue.getId(), Tag("extra", "#000"));
+    }
+  }
+
+  std::vector<IssueQuery> queries(7);
+  queries[0].status = "done";
+  queries[1].assignee = "dev";
+  queries[2].author = "AUTHOR";
+  queries[2].unassignedOnly = true;
+  queries[3].tagsAny = {"tag1", "extra"};
+  queries[4].tagsAll = {"tag0", "extra", "extra"};
+  queries[5].milestoneId = milestone.getId();
+  queries[5].status = "In-Progress";
+  queries[6].createdFrom = all[3].getCreatedAt();
+  queries[6].createdTo = all[9].getCreatedAt() + 1;
+
+  for (const IssueQuery& query : queries) {
+    std::vector<int> expected;
+    for (const Issue& issue :
+         repository.findIssues([&](const Issue& candidate) {
+           return query.matches(candidate);
+         })) {
+      if (!query.milestoneId || issue.getId() % 2 == 1) {
+        expected.push_back(issue.getId());
+      }
+    }
+    EXPECT_EQ(idsOf(repository.findIssues(query)), expected);
+  }
+  EXPECT_THAT(repository.findIssues(queries[0]), SizeIs(4));
+  EXPECT_THAT(repository.findIssues(queries[4]), SizeIs(1));
+  EXPECT_THAT(repository.findIssues(IssueQuery()), SizeIs(12));
+  EXPECT_LE(statementsFor([&] { repository.findIssues(queries[4]); }), 3u);
+}
+
+TEST_F(SQLiteIssueRepositoryTest, TagFiltersReuseOneStatementAtAnyLength) {
+  const std::vector<std::string> names = {"plain", "say \"hi\"", "back\\slash",
+                                          "tab\there"};
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    const int id = repository.saveIssue(Issue(0, "author", "Tagged")).getId();
+    for (std::size_t t = 0; t <= i; ++t) {
+      repository.addTagToIssue(id, Tag(names[t], "#fff"));
+    }
+  }
+
+  IssueQuery any;
+  IssueQuery all;
+  any.tagsAny = {names[3]};
+  all.tagsAll = {names[0]};
+  EXPECT_THAT(repository.findIssues(any), SizeIs(1));
+  EXPECT_THAT(repository.findIssues(all), SizeIs(4));
+
+  const SqliteStatementCache::Stats warm = repository.statementCacheStats();
+  any.tagsAny = {names[1], names[2], "missing"};
+  all.tagsAll = {names[0], names[1], names[2]};
+  EXPECT_THAT(repository.findIssues(any), SizeIs(3));
+  EXPECT_THAT(repository.findIssues(all), SizeIs(2));
+  EXPECT_EQ(repository.statementCacheStats().misses, warm.misses);
+}
+
+TEST_F(SQLiteIssueRepositoryTest, KeysetPagesMatchSortedSliceAtAnyDepth) {
+  Milestone milestone = repository.saveMilestone(
+      Milestone(-1, "M1", "", "2024-01-01", "2024-02-01"));
+  seedIssues(45, milestone.getId());
+
+  IssueQuery assigned;
+  assigned.assignee = "dev";
+  for (IssueSort sort : {IssueSort::kId, IssueSort::kCreatedAt}) {
+    for (const IssueQuery& query : {IssueQuery(), assigned}) {
+      IssuePageRequest page;
+      page.limit = 7;
+      page.sort = sort;
+      std::vector<int> seen;
+      std::vector<std::size_t> statements;
+      for (;;) {
+        IssuePage expected = slicePage(repository, query, page);
+        IssuePage actual;
+        statements.push_back(statementsFor(
+            [&] { actual = repository.findIssuePage(query, page); }));
+        ASSERT_EQ(idsOf(actual.issues), idsOf(expected.issues));
+        ASSERT_EQ(actual.next.has_value(), expected.next.has_value());
+        for (const Issue& issue : actual.issues) {
+          EXPECT_THAT(issue.getComments(), SizeIs(2));
+          EXPECT_THAT(issue.getTags(), SizeIs(1));
+          seen.push_back(issue.getId());
+        }
+        if (!actual.next) {
+          break;
+        }
+        ASSERT_TRUE(IssueCursor::decode(actual.next->encode()).has_value());
+        page.after = actual.next;
+      }
+      EXPECT_EQ(seen, idsOf(repository.findIssues(query)));
+      for (std::size_t count : statements) {
+        EXPECT_EQ(count, statements[0]);
+      }
+      EXPECT_LE(statements[0], 3u);
+    }
+  }
+
+  IssuePageRequest mismatched;
+  mismatched.sort = IssueSort::kCreatedAt;
+  mismatched.after = IssueCursor{IssueSort::kId, 1, 1};
+  EXPECT_THROW(repository.findIssuePage(IssueQuery(), mismatched),
+               std::invalid_argument);
+}
+
+TEST_F(SQLiteIssueRepositoryTest, MetadataEditsNeverReadComments) {
+  Issue saved = repository.saveIssue(Issue(0, "author", "Busy"));
+  repository.saveComment(saved.getId(), Comment(0, "author", "desc"));
+  for (int i = 0; i < 200; ++i) {
+    repository.saveComment(saved.getId(), Comment(-1, "dev", "reply"));
+  }
+  saved.setDescriptionCommentId(0);
+  repository.saveIssue(saved);
+
+  Issue issue;
+  EXPECT_EQ(statementsFor([&] { issue = repository.getIssue(saved.getId()); }),
+            2u);
+  EXPECT_FALSE(issue.commentsLoaded());
+  issue.setStatus("Done");
+  repository.saveIssue(issue);
+  EXPECT_FALSE(issue.commentsLoaded());
+
+  EXPECT_EQ(statementsFor([&] {
+              EXPECT_EQ(issue.getDescriptionComment(), "desc");
+            }),
+            1u);
+  EXPECT_THAT(issue.getComments(), SizeIs(201));
+
+  Issue reread = repository.getIssue(saved.getId());
+  EXPECT_EQ(reread.getStatus(), "Done");
+  EXPECT_EQ(reread.getDescriptionCommentId(), 0);
+  EXPECT_THAT(reread.getCommentIds(), SizeIs(201));
+}
+
+TEST_F(SQLiteIssueRepositoryTest, SavesReturnWrittenStateWithoutReading) {
+  Issue fresh = repository.saveIssue(Issue(0, "author", "Fresh"));
+  EXPECT_EQ(fresh.getTitle(), "Fresh");
+  EXPECT_TRUE(fresh.hasPersistentId());
+  EXPECT_GT(fresh.getTimestamp(), 0);
+
+  repository.saveComment(fresh.getId(), Comment(0, "author", "desc"));
+  repository.addTagToIssue(fresh.getId(), Tag("ui", "#123456"));
+  Issue issue = repository.getIssue(fresh.getId());
+  issue.setDescriptionCommentId(0);
+  issue.addTag(Tag("ui", ""));
+  issue.addTag(Tag("backend", "#abcdef"));
+
+  Issue saved = repository.saveIssue(issue);
+  Issue reread = repository.getIssue(fresh.getId());
+  EXPECT_EQ(saved.getTitle(), reread.getTitle());
+  EXPECT_EQ(saved.getTimestamp(), reread.getTimestamp());
+  EXPECT_EQ(saved.getDescriptionComment(), "desc");
+  EXPECT_EQ(idsOf(saved.getComments()), idsOf(reread.getComments()));
+  const std::vector<Tag> savedTags = saved.getTags();
+  const std::vector<Tag> rereadTags = reread.getTags();
+  ASSERT_THAT(savedTags, SizeIs(rereadTags.size()));
+  for (std::size_t i = 0; i < savedTags.size(); ++i) {
+    EXPECT_EQ(savedTags[i].getName(), rereadTags[i].getName());
+    EXPECT_EQ(savedTags[i].getColor(), rereadTags[i].getColor());
+  }
+  EXPECT_EQ(savedTags.back().getColor(), "#123456");
+
+  // One UPDATE, which also returns the stored tags, in its transaction.
+  Issue untagged = repository.saveIssue(Issue(0, "author", "Plain"));
+  untagged.setStatus("Done");
+  EXPECT_EQ(statementsFor([&] { untagged = repository.saveIssue(untagged); }),
+            3u);
+  EXPECT_EQ(untagged.getStatus(), "Done");
+  Issue missing(4242, "author", "Gone");
+  EXPECT_THROW(repository.saveIssue(missing), std::invalid_argument);
+
+  Milestone milestone = repository.saveMilestone(
+      Milestone(-1, "M1", "", "2024-01-01", "2024-02-01"));
+  repository.addIssueToMilestone(milestone.getId(), untagged.getId());
+  repository.addIssueToMilestone(milestone.getId(), fresh.getId());
+  Milestone renamed(milestone.getId(), "M1 final", "", "2024-01-01",
+                    "2024-03-01");
+  Milestone returned;
+  EXPECT_EQ(statementsFor([&] { returned = repository.saveMilestone(renamed); }),
+            1u);
+  Milestone stored = repository.getMilestone(milestone.getId());
+  EXPECT_EQ(returned.getName(), "M1 final");
+  EXPECT_EQ(returned.getEndDate(), stored.getEndDate());
+  EXPECT_EQ(returned.getIssueIds(), stored.getIssueIds());
+  EXPECT_THROW(repository.saveMilestone(Milestone(999, "X", "", "2024-01-01",
+                                                  "2024-01-02")),
+               std::out_of_range);
+}
+
+TEST_F(SQLiteIssueRepositoryTest, SaveWritesOnlyChangedTags) {
+  Issue issue = repository.saveIssue(Issue(0, "author", "Tagged"));
+  for (int i = 0; i < 20; ++i) {
+    issue.addTag(Tag("tag" + std::to_string(i), i % 2 ? "#fff" : ""));
+  }
+  repository.saveIssue(issue);
+  repository.addTagToIssue(issue.getId(), Tag("tag0", ""));
+  const std::size_t unchanged = statementsFor([&] {
+    issue.setStatus("In Progress");
+    issue = repository.saveIssue(issue);
+  });
+  EXPECT_EQ(unchanged, 3u);
+
+  auto expectReread = [&] {
+    const std::vector<Tag> saved = issue.getTags();
+    const std::vector<Tag> reread =
+        repository.getIssue(issue.getId()).getTags();
+    ASSERT_EQ(saved.size(), reread.size());
+    for (std::size_t i = 0; i < saved.size(); ++i) {
+      EXPECT_EQ(saved[i].getName(), reread[i].getName());
+      EXPECT_EQ(saved[i].getColor(), reread[i].getColor());
+    }
+  };
+  expectReread();
+
+  // A recolor upserts the definition and updates one row; a removal is
+  // one DELETE; an addition upserts and inserts.
+  issue.addTag(Tag("tag3", "#000"));
+  EXPECT_EQ(statementsFor([&] { issue = repository.saveIssue(issue); }),
+            unchanged + 2);
+  expectReread();
+  issue.removeTag("tag4");
+  EXPECT_EQ(statementsFor([&] { issue = repository.saveIssue(issue); }),
+            unchanged + 1);
+  issue.addTag(Tag("fresh", ""));
+  EXPECT_EQ(statementsFor([&] { issue = repository.saveIssue(issue); }),
+            unchanged + 2);
+  expectReread();
+  EXPECT_THAT(issue.getTags(), SizeIs(20));
+}
+
+TEST_F(SQLiteIssueRepositoryTest, TagsWithControlCharactersRoundTrip) {
+  const std::vector<std::string> names = {"a\x1f" "b", "quote\"back\\slash",
+                                          "line\nbreak", "caf\xc3\xa9"};
+  Issue issue = repository.saveIssue(Issue(0, "author", "Odd tags"));
+  for (const std::string& name : names) {
+    issue.addTag(Tag(name, "#\x1f"));
+  }
+  issue = repository.saveIssue(issue);
+
+  // The second save reads the stored tags back to diff them, and would
+  // rewrite or drop any it misread.
+  const std::size_t unchanged = statementsFor([&] {
+    issue.setStatus("In Progress");
+    issue = repository.saveIssue(issue);
+  });
+  EXPECT_EQ(unchanged, 3u);
+
+  std::vector<std::string> sorted = names;
+  std::sort(sorted.begin(), sorted.end());
+  for (const Issue& read : {issue, repository.getIssue(issue.getId())}) {
+    std::vector<std::string> reread;
+    for (const Tag& tag : read.getTags()) {
+      EXPECT_EQ(tag.getColor(), "#\x1f");
+      reread.push_back(tag.getName());
+    }
+    std::sort(reread.begin(), reread.end());
+    EXPECT_EQ(reread, sorted);
+  }
+  const std::vector<IssueSummary> summaries =
+      repository.findIssueSummaries(IssueQuery());
+  ASSERT_THAT(summaries, SizeIs(1));
+  EXPECT_EQ(summaries.front().tags, sorted);
+}
+
+TEST_F(SQLiteIssueRepositoryTest, CommentPagesAndDigestsSeekByKey) {
+  Issue thread = repository.saveIssue(Issue(0, "author", "Incident"));
+  Issue bare = repository.saveIssue(Issue(0, "author", "No description"));
+  repository.saveComment(thread.getId(), Comment(0, "author", "desc"));
+  thread.setDescriptionCommentId(0);
+  repository.saveIssue(thread);
+
+  std::vector<std::size_t> pageCounts;
+  std::vector<std::size_t> digestCounts;
+  int posted = 0;
+  for (int length : {20, 200, 1000}) {
+    for (; posted < length; ++posted) {
+      repository.saveComment(
+          thread.getId(),
+          Comment(-1, "dev", "update " + std::to_string(posted)));
+    }
+    pageCounts.push_back(statementsFor([&] {
+      repository.getCommentPage(thread.getId(),
+                                CommentPageRequest{10, posted - 15});
+    }));
+    digestCounts.push_back(statementsFor(
+        [&] { repository.getIssueDigest(thread.getId(), 5); }));
+  }
+  EXPECT_THAT(pageCounts, ::testing::Each(pageCounts[0]));
+  EXPECT_THAT(digestCounts, ::testing::Each(digestCounts[0]));
+  EXPECT_LE(digestCounts[0], 2u);
+
+  CommentPageRequest request{150, -1};
+  std::vector<int> walked;
+  for (;;) {
+    CommentPage page = repository.getCommentPage(thread.getId(), request);
+    CommentPage expected = sliceComments(repository, thread.getId(), request);
+    ASSERT_EQ(page.next, expected.next);
+    ASSERT_EQ(page.comments.size(), expected.comments.size());
+    for (const Comment& comment : page.comments) {
+      walked.push_back(comment.getId());
+    }
+    if (!page.next) {
+      break;
+    }
+    request.after = *page.next;
+  }
+  EXPECT_THAT(walked, SizeIs(1001));
+  EXPECT_TRUE(std::is_sorted(walked.begin(), walked.end()));
+  EXPECT_THROW(repository.getCommentPage(999, CommentPageRequest{}),
+               std::invalid_argument);
+
+  for (const Issue& issue : {thread, bare}) {
+    for (std::size_t latest : {0u, 3u, 2000u}) {
+      IssueDigest digest = repository.getIssueDigest(issue.getId(), latest);
+      IssueDigest expected =
+          IssueDigest::of(repository.getIssue(issue.getId()), latest);
+      EXPECT_EQ(digest.summary.commentCount, expected.summary.commentCount);
+      EXPECT_EQ(digest.description.has_value(),
+                expected.description.has_value());
+      EXPECT_EQ(idsOf(digest.latestComments), idsOf(expected.latestComments));
+    }
+  }
+  IssueDigest digest = repository.getIssueDigest(thread.getId(), 3);
+  EXPECT_EQ(digest.description->getText(), "desc");
+  EXPECT_EQ(digest.latestComments.back().getText(), "update 999");
+  EXPECT_THROW(repository.getIssueDigest(999, 1), std::invalid_argument);
+}
+
+TEST_F(SQLiteIssueRepositoryTest, StreamsYieldCollectedIssuesRowByRow) {
+  Milestone milestone = repository.saveMilestone(
+      Milestone(-1, "M1", "", "2024-01-01", "2024-02-01"));
+  std::vector<std::size_t> streamCounts;
+  for (int batch : {10, 200}) {
+    seedIssues(batch, milestone.getId());
+    // Bare issues leave gaps in the comment and tag runs.
+    repository.saveIssue(Issue(0, "author", "Bare"));
+    streamCounts.push_back(statementsFor([&] {
+      SQLiteIssueRepository::IssueStream stream = repository.streamIssues();
+      Issue issue;
+      while (stream.next(&issue)) {
+      }
+    }));
+  }
+  EXPECT_THAT(streamCounts, ::testing::Each(streamCounts[0]));
+  EXPECT_LE(streamCounts[0], 3u);
+
+  IssueQuery tagged;
+  tagged.tagsAny = {"tag1"};
+  for (const IssueQuery& query : {IssueQuery(), tagged}) {
+    std::vector<Issue> expected = repository.findIssues(query);
+    std::vector<Issue> streamed;
+    SQLiteIssueRepository::IssueStream stream = repository.streamIssues(query);
+    for (Issue issue; stream.next(&issue);) {
+      streamed.push_back(issue);
+    }
+    ASSERT_EQ(idsOf(streamed), idsOf(expected));
+    for (std::size_t i = 0; i < streamed.size(); ++i) {
+      EXPECT_EQ(idsOf(streamed[i].getComments()),
+                idsOf(expected[i].getComments()));
+      EXPECT_EQ(streamed[i].getDescriptionCommentId(),
+                expected[i].getDescriptionCommentId());
+      EXPECT_EQ(streamed[i].getTags().size(), expected[i].getTags().size());
+    }
+  }
+
+  const Issue first = repository.listIssues().front();
+  std::vector<Comment> comments;
+  SQLiteIssueRepository::CommentStream stream =
+      repository.streamComments(first.getId());
+  for (Comment comment; stream.next(&comment);) {
+    comments.push_back(comment);
+  }
+  EXPECT_EQ(idsOf(comments), idsOf(repository.getAllComments(first.getId())));
+  EXPECT_THROW(repository.streamComments(99999), std::invalid_argument);
+}
+
+TEST_F(SQLiteIssueRepositoryTest, SummariesMatchFullIssuesInOneStatement) {
+  Milestone milestone = repository.saveMilestone(
+      Milestone(-1, "M1", "", "2024-01-01", "2024-02-01"));
+  seedIssues(20, milestone.getId());
+  repository.addTagToIssue(1, Tag("alpha", "#000"));
+
+  IssueQuery linked;
+  linked.milestoneId = milestone.getId();
+  for (const IssueQuery& query : {IssueQuery(), linked}) {
+    std::vector<Issue> issues = repository.findIssues(query);
+    std::vector<IssueSummary> summaries;
+    EXPECT_EQ(statementsFor(
+                  [&] { summaries = repository.findIssueSummaries(query); }),
+              1u);
+    ASSERT_EQ(summaries.size(), issues.size());
+    for (std::size_t i = 0; i < issues.size(); ++i) {
+      const IssueSummary expected = IssueSummary::of(issues[i]);
+      EXPECT_EQ(summaries[i].id, expected.id);
+      EXPECT_EQ(summaries[i].title, expected.title);
+      EXPECT_EQ(summaries[i].status, expected.status);
+      EXPECT_EQ(summaries[i].assignedTo, expected.assignedTo);
+      EXPECT_EQ(summaries[i].authorId, expected.authorId);
+      EXPECT_EQ(summaries[i].createdAt, expected.createdAt);
+      EXPECT_EQ(summaries[i].tags, expected.tags);
+      EXPECT_EQ(summaries[i].commentCount, 2u);
+    }
+  }
+  EXPECT_EQ(repository.findIssueSummaries(IssueQuery())[0].tags,
+            (std::vector<std::string>{"alpha", "tag0"}));
+
+  IssuePageRequest page;
+  page.limit = 6;
+  page.sort = IssueSort::kCreatedAt;
+  std::vector<int> seen;
+  for (;;) {
+    IssueSummaryPage summaries = repository.findIssueSummaryPage(
+        IssueQuery(), page);
+    IssuePage issues = repository.findIssuePage(IssueQuery(), page);
+    ASSERT_EQ(summaries.summaries.size(), issues.issues.size());
+    for (std::size_t i = 0; i < summaries.summaries.size(); ++i) {
+      EXPECT_EQ(summaries.summaries[i].id, issues.issues[i].getId());
+      seen.push_back(summaries.summaries[i].id);
+    }
+    ASSERT_EQ(summaries.next.has_value(), issues.next.has_value());
+    if (!summaries.next) {
+      break;
+    }
+    EXPECT_EQ(summaries.next->encode(), issues.next->encode());
+    page.after = summaries.next;
+  }
+  EXPECT_EQ(seen, idsOf(repository.listIssues()));
+}
+
+TEST_F(SQLiteIssueRepositoryTest, StatsAggregateWithoutLoadingIssues) {
+  Milestone milestone = repository.saveMilestone(
+      Milestone(-1, "M1", "", "2024-01-01", "2024-02-01"));
+  seedIssues(9, milestone.getId());
+  Issue done = repository.listIssues().front();
+  done.setStatus("Done");
+  repository.saveIssue(done);
+
+  std::vector<IssueQuery> queries(4);
+  queries[1].status = "done";
+  queries[2].milestoneId = milestone.getId();
+  queries[3].tagsAny = {"tag1"};
+  queries[3].unassignedOnly = true;
+  for (const IssueQuery& query : queries) {
+    EXPECT_EQ(repository.countIssues(query),
+              tallyIssues(repository, query));
+  }
+
+  IssueStats stats = repository.countIssues(IssueQuery());
+  EXPECT_EQ(stats.total, 9u);
+  EXPECT_EQ(stats.unassigned, 4u);
+  EXPECT_EQ(stats.byAssignee.at("dev"), 5u);
+  EXPECT_EQ(stats.byStatus.at("Done"), 1u);
+  EXPECT_EQ(stats.byTag.at("tag0"), 3u);
+  EXPECT_EQ(statementsFor([&] { repository.countIssues(queries[2]); }), 3u);
+}
+
+TEST_F(SQLiteIssueRepositoryTest, MilestoneQueriesAggregateInPlace) {
+  Milestone q1 = repository.saveMilestone(
+      Milestone(-1, "Q1", "", "2024-01-01", "2024-03-31"));
+  Milestone q2 = repository.saveMilestone(
+      Milestone(-1, "Q2", "", "2024-04-01", "2024-06-30"));
+  Milestone empty = repository.saveMilestone(
+      Milestone(-1, "Later", "", "2024-07-01", "2024-09-30"));
+  seedIssues(4, q1.getId());
+  seedIssues(2, q2.getId());
+  for (Issue issue : repository.getIssuesForMilestone(q1.getId())) {
+    issue.setStatus("Done");
+    repository.saveIssue(issue);
+  }
+  Issue open = repository.getIssuesForMilestone(q2.getId()).front();
+  open.setStatus("In Progress");
+  repository.saveIssue(open);
+
+  for (int id : {q1.getId(), q2.getId(), empty.getId()}) {
+    EXPECT_EQ(repository.getMilestoneStats(id),
+              tallyMilestone(repository, id));
+  }
+  const MilestoneStats stats = repository.getMilestoneStats(q2.getId());
+  EXPECT_EQ(stats.total, 1u);
+  EXPECT_EQ(stats.closed, 0u);
+  EXPECT_EQ(repository.getMilestoneStats(q1.getId()).percentComplete(),
+            100.0);
+  EXPECT_EQ(repository.getMilestoneStats(empty.getId()).total, 0u);
+  EXPECT_THROW(repository.getMilestoneStats(999), std::out_of_range);
+  EXPECT_EQ(statementsFor([&] { repository.getMilestoneStats(q1.getId()); }),
+            1u);
+
+  auto names = [](const std::vector<Milestone>& list) {
+    std::vector<std::string> out;
+    for (const Milestone& m : list) {
+      out.push_back(m.getName());
+    }
+    return out;
+  };
+  EXPECT_THAT(names(repository.findMilestonesInRange("2024-05-01", "")),
+              ::testing::ElementsAre("Q2", "Later"));
+  EXPECT_THAT(names(repository.findMilestonesInRange("", "2024-01-01")),
+              ::testing::ElementsAre("Q1"));
+  EXPECT_THAT(names(repository.findMilestonesInRange("2024-05-01",
+                                                     "2024-05-01")),
+              ::testing::ElementsAre("Q2"));
+  EXPECT_THAT(repository.findMilestonesInRange("2025-01-01", ""),
+              ::testing::IsEmpty());
+  EXPECT_THAT(names(repository.findMilestonesInRange("2024-03-15",
+                                                     "2024-04-15")),
+              ::testing::ElementsAre("Q1", "Q2"));
+  EXPECT_THAT(names(repository.findCompletedMilestones()),
+              ::testing::ElementsAre("Q1"));
+}
+
+TEST_F(SQLiteIssueRepositoryTest, SearchRanksTitlesAndCommentsInSync) {
+  Issue crash = repository.saveIssue(Issue(0, "author", "Crash on startup"));
+  Issue other = repository.saveIssue(Issue(0, "author", "Slow listing"));
+  repository.saveComment(other.getId(),
+                         Comment(0, "dev", "Startup crash seen again"));
+  repository.saveComment(other.getId(), Comment(-1, "dev", "unrelated"));
+
+  SearchRequest request;
+  request.text = "crash startup";
+  SearchPage page = repository.searchIssues(request);
+  ASSERT_THAT(page.hits, SizeIs(2));
+  EXPECT_FALSE(page.nextOffset.has_value());
+  EXPECT_LE(page.hits[0].score, page.hits[1].score);
+  EXPECT_EQ(page.hits[0].issueId, crash.getId());
+  EXPECT_EQ(page.hits[0].commentId, -1);
+  EXPECT_EQ(page.hits[0].snippet, "[Crash] on [startup]");
+  EXPECT_EQ(page.hits[1].issueId, other.getId());
+  EXPECT_EQ(page.hits[1].commentId, 0);
+  EXPECT_EQ(page.hits[1].title, "Slow listing");
+
+  request.limit = 1;
+  page = repository.searchIssues(request);
+  ASSERT_THAT(page.hits, SizeIs(1));
+  ASSERT_TRUE(page.nextOffset.has_value());
+  request.offset = *page.nextOffset;
+  EXPECT_EQ(repository.searchIssues(request).hits.at(0).issueId,
+            other.getId());
+  request = SearchRequest();
+
+  // Writes, including the comment cascade of deleteIssue, keep the index
+  // in step; quoting keeps FTS5 syntax in user input literal.
+  crash.setTitle("Hang on shutdown");
+  repository.saveIssue(crash);
+  repository.saveComment(other.getId(), Comment(1, "dev", "shutdown-hang"));
+  request.text = "shut*";
+  EXPECT_THAT(repository.searchIssues(request).hits, SizeIs(2));
+  repository.deleteIssue(other.getId());
+  request.text = "startup";
+  EXPECT_THAT(repository.searchIssues(request).hits, SizeIs(0));
+  request.text = "hang\" OR \"x";
+  EXPECT_NO_THROW(repository.searchIssues(request));
+  request.text = "  ";
+  EXPECT_THROW(repository.searchIssues(request), std::invalid_argument);
+}
+
+TEST_F(SQLiteIssueRepositoryTest, InMemoryDatabaseReadsThroughWriter) {
+  repository.saveIssue(Issue(0, "author", "Only"));
+  EXPECT_THAT(repository.listIssues(), SizeIs(1));
+  EXPECT_EQ(repository.readerConnectionCount(), 0u);
+}
+
+class SQLiteIssueRepositoryFileTest : public ::testing::Test {
+ protected:
+  SQLiteIssueRepositoryFileTest()
+      : root(std::filesystem::temp_directory_path() /
+             ("sqlite-repo-" +
+              std::to_string(std::chrono::steady_clock::now()
+                                 .time_since_epoch()
+                                 .count()))) {
+    std::filesystem::create_directories(root);
+  }
+
+  ~SQLiteIssueRepositoryFileTest() override {
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+  }
+
+  std::string dbPath() const { return (root / "issues.db").string(); }
+
+  std::filesystem::path root;
+};
+
+TEST_F(SQLiteIssueRepositoryFileTest, FileDatabaseUsesWalAndReaderPool) {
+  SQLiteIssueRepository repository(dbPath(), 2);
+  EXPECT_EQ(repository.journalMode(), "wal");
+
+  Issue saved = repository.saveIssue(Issue(0, "author", "Visible"));
+  EXPECT_EQ(repository.getIssue(saved.getId()).getTitle(), "Visible");
+  EXPECT_EQ(repository.readerConnectionCount(), 1u);
+}
+
+TEST_F(SQLiteIssueRepositoryFileTest, StorageProfileIsAppliedOnOpen) {
+  EXPECT_EQ(SQLiteIssueRepository(dbPath(), 2).storageSettings(),
+            StorageProfile::preset("durable"));
+
+  StorageProfile profile = StorageProfile::preset("throughput");
+  profile.set("cache_size", "-1024");
+  profile.set("synchronous", "normal");
+  SQLiteIssueRepository repository(dbPath(), 2, profile);
+  EXPECT_EQ(repository.storageSettings(), profile);
+  EXPECT_EQ(repository.storageSettings().synchronous, "NORMAL");
+
+  Issue saved = repository.saveIssue(Issue(0, "author", "Tuned"));
+  EXPECT_EQ(repository.getIssue(saved.getId()).getTitle(), "Tuned");
+  EXPECT_THROW(profile.set("temp_store", "MEMORY; DROP TABLE issues"),
+               std::invalid_argument);
+  EXPECT_THROW(profile.set("page_size", "4096"), std::invalid_argument);
+  EXPECT_THROW(StorageProfile::preset("fastest"), std::invalid_argument);
+}
+
+TEST_F(SQLiteIssueRepositoryFileTest, ConcurrentReadsRunAlongsideWrites) {
+  constexpr int kWrites = 100;
+  constexpr std::size_t kReaders = 4;
+  SQLiteIssueRepository repository(dbPath(), kReaders);
+
+  std::atomic<bool> writerDone{false};
+  std::atomic<int> failures{0};
+  std::vector<std::thread> readers;
+  for (std::size_t r = 0; r < kReaders + 2; ++r) {
+    readers.emplace_back([&] {
+      std::size_t lastSeen = 0;
+      while (!writerDone.load()) {
+        try {
+          std::size_t seen = repository.listIssues().size();
+          repository.listAllTags();
+          if (seen < lastSeen) {
+            ++failures;
+          }
+          lastSeen = seen;
+        } catch (const std::exception&) {
+          ++failures;
+        }
+      }
+    });
+  }
+
+  for (int i = 0; i < kWrites; ++i) {
+    Issue saved =
+        repository.saveIssue(Issue(0, "author", "Issue " + std::to_string(i)));
+    repository.addTagToIssue(saved.getId(), Tag("t", "#fff"));
+  }
+  writerDone = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  EXPECT_EQ(failures.load(), 0);
+  EXPECT_THAT(repository.listIssues(), SizeIs(kWrites));
+  EXPECT_LE(repository.readerConnectionCount(), kReaders);
+}
+
+TEST_F(SQLiteIssueRepositoryFileTest, StreamReadsOneSnapshot) {
+  SQLiteIssueRepository repository(dbPath(), 2);
+  for (int i = 0; i < 5; ++i) {
+    repository.saveIssue(Issue(0, "author", "Issue " + std::to_string(i)));
+  }
+
+  std::size_t streamed = 0;
+  {
+    SQLiteIssueRepository::IssueStream stream = repository.streamIssues();
+    for (Issue issue; stream.next(&issue);) {
+      if (++streamed == 1) {
+        // Writes go through the writer while the stream holds a reader.
+        std::thread([&] {
+          repository.saveIssue(Issue(0, "author", "Late"));
+        }).join();
+      }
+    }
+  }
+  EXPECT_EQ(streamed, 5u);
+  EXPECT_THAT(repository.listIssues(), SizeIs(6));
+}
+
+TEST_F(SQLiteIssueRepositoryFileTest, ExportSnapshotPassesSeeOneSnapshot) {
+  SQLiteIssueRepository repository(dbPath(), 2);
+  repository.saveUser(User("author", "Developer"));
+  const int milestoneId =
+      repository
+          .saveMilestone(Milestone(-1, "M1", "", "2024-01-01", "2024-02-01"))
+          .getId();
+  for (int i = 0; i < 3; ++i) {
+    repository.addIssueToMilestone(
+        milestoneId,
+        repository.saveIssue(Issue(0, "author", "Issue " + std::to_string(i)))
+            .getId());
+  }
+
+  std::vector<std::size_t> passes;
+  {
+    SQLiteIssueRepository::ExportSnapshot snapshot =
+        repository.openExportSnapshot();
+    std::thread([&] {
+      repository.saveUser(User("late", "Developer"));
+      repository.addIssueToMilestone(
+          milestoneId,
+          repository.saveIssue(Issue(0, "late", "Late")).getId());
+    }).join();
+
+    EXPECT_THAT(snapshot.users(), SizeIs(1));
+    ASSERT_THAT(snapshot.milestones(), SizeIs(1));
+    EXPECT_THAT(snapshot.milestones().front().getIssueIds(), SizeIs(3));
+    for (int pass = 0; pass < 2; ++pass) {
+      SQLiteIssueRepository::IssueStream stream = snapshot.issues();
+      std::size_t streamed = 0;
+      for (Issue issue; stream.next(&issue);) {
+        ++streamed;
+      }
+      passes.push_back(streamed);
+    }
+  }
+  EXPECT_EQ(passes, (std::vector<std::size_t>{3, 3}));
+  EXPECT_THAT(repository.listIssues(), SizeIs(4));
+}
+
+TEST_F(SQLiteIssueRepositoryFileTest, SnapshotsStayOutOfTheReaderPool) {
+  StorageProfile profile;
+  profile.busyTimeoutMs = 50;
+  SQLiteIssueRepository repository(dbPath(), 1, profile);
+  repository.saveIssue(Issue(0, "author", "Seeded"));
+
+  auto readElsewhere = [&] {
+    std::size_t seen = 0;
+    std::thread([&] { seen = repository.listIssues().size(); }).join();
+    return seen;
+  };
+  {
+    SQLiteIssueRepository::ExportSnapshot snapshot =
+        repository.openExportSnapshot();
+    SQLiteIssueRepository::IssueStream stream = snapshot.issues();
+    EXPECT_EQ(readElsewhere(), 1u);
+  }
+  repository.backupTo(dbPath() + ".bak", 1, [&](int, int) {
+    EXPECT_EQ(readElsewhere(), 1u);
+    return true;
+  });
+  EXPECT_EQ(repository.readerConnectionCount(), 1u);
+
+  // A pooled reader held past the busy timeout fails the next read.
+  SQLiteIssueRepository::IssueStream held = repository.streamIssues();
+  std::thread([&] {
+    EXPECT_THROW(repository.listIssues(), std::runtime_error);
+  }).join();
+}
+
+TEST_F(SQLiteIssueRepositoryFileTest, WarmUpPreparesFirstRequestStatements) {
+  {
+    SQLiteIssueRepository seeded(dbPath(), 2);
+    seeded.saveIssue(Issue(0, "author", "Seeded"));
+  }
+  SQLiteIssueRepository repository(dbPath(), 2);
+  repository.warmUp();
+
+  const SqliteStatementCache::Stats warm = repository.statementCacheStats();
+  repository.findIssueSummaryPage(IssueQuery(), IssuePageRequest());
+  repository.countIssues(IssueQuery());
+  repository.listAllUsers();
+  EXPECT_EQ(repository.statementCacheStats().misses, warm.misses);
+  EXPECT_EQ(repository.readerConnectionCount(), 1u);
+}
+
+TEST_F(SQLiteIssueRepositoryFileTest, BackupCopiesOneSnapshotWhileWritesGoOn) {
+  SQLiteIssueRepository repository(dbPath(), 2);
+  for (int i = 0; i < 50; ++i) {
+    repository.saveIssue(Issue(0, "author", "Issue " + std::to_string(i)));
+  }
+
+  const std::string backupPath = dbPath() + ".bak";
+  int steps = 0;
+  int lastTotal = 0;
+  EXPECT_TRUE(repository.backupTo(backupPath, 1, [&](int copied, int total) {
+    // A commit between steps would restart a backup without a snapshot.
+    std::thread([&] {
+      repository.saveIssue(Issue(0, "author", "Late"));
+    }).join();
+    EXPECT_EQ(copied, ++steps);
+    lastTotal = total;
+    return true;
+  }));
+  EXPECT_EQ(steps, lastTotal);
+  EXPECT_THAT(repository.listIssues(), SizeIs(50 + steps));
+
+  SQLiteIssueRepository backup(backupPath, 2);
+  EXPECT_THAT(backup.listIssues(), SizeIs(50));
+  EXPECT_EQ(backup.schemaVersion(),
+            SQLiteIssueRepository::latestSchemaVersion());
+
+  EXPECT_FALSE(repository.backupTo(backupPath + "2", 1,
+                                   [](int, int) { return false; }));
+}
+
+TEST_F(SQLiteIssueRepositoryFileTest, BackupGivesUpOnLockedTarget) {
+  StorageProfile profile;
+  profile.busyTimeoutMs = 50;
+  SQLiteIssueRepository repository(dbPath(), 2, profile);
+  repository.saveIssue(Issue(0, "author", "Seeded"));
+
+  const std::string backupPath = dbPath() + ".bak";
+  sqlite3* holder = nullptr;
+  ASSERT_EQ(sqlite3_open(backupPath.c_str(), &holder), SQLITE_OK);
+  // A write lock leaves the target open to readers but not to the copy.
+  ASSERT_EQ(sqlite3_exec(holder, "BEGIN IMMEDIATE;", nullptr, nullptr,
+                         nullptr),
+            SQLITE_OK);
+
+  int steps = 0;
+  EXPECT_THROW(repository.backupTo(backupPath, 1,
+                                   [&](int, int) {
+                                     ++steps;
+                                     return true;
+                                   }),
+               std::runtime_error);
+  EXPECT_GT(steps, 0);
+  EXPECT_FALSE(repository.backupTo(backupPath, 1,
+                                   [](int, int) { return false; }));
+
+  sqlite3_exec(holder, "ROLLBACK;", nullptr, nullptr, nullptr);
+  sqlite3_close(holder);
+  EXPECT_TRUE(repository.backupTo(backupPath, 1));
+}
+
+TEST_F(SQLiteIssueRepositoryFileTest, ConcurrentCommentsGetDistinctIds) {
+  constexpr int kPerWriter = 50;
+  SQLiteIssueRepository first(dbPath(), 2);
+  SQLiteIssueRepository second(dbPath(), 2);
+  const int issueId =
+      first.saveIssue(Issue(0, "author", "Contended")).getId();
+
+  // Two connections, so the writer mutex of one repository does not
+  // serialize them; only the database can.
+  std::atomic<int> failures{0};
+  std::vector<std::thread> writers;
+  for (SQLiteIssueRepository* repo : {&first, &second}) {
+    writers.emplace_back([&, repo] {
+      for (int i = 0; i < kPerWriter; ++i) {
+        try {
+          repo->saveComment(issueId, Comment(-1, "dev", "post"));
+        } catch (const std::exception&) {
+          ++failures;
+        }
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  EXPECT_EQ(failures.load(), 0);
+  EXPECT_THAT(first.getAllComments(issueId), SizeIs(2 * kPerWriter));
+
+  // Ids are never handed out twice, even after the newest is deleted.
+  const int newest = first.getAllComments(issueId).back().getId();
+  first.deleteComment(issueId, newest);
+  EXPECT_EQ(first.saveComment(issueId, Comment(-1, "dev", "again")).getId(),
+            newest + 1);
+  EXPECT_THROW(first.saveComment(999, Comment(-1, "dev", "orphan")),
+               std::invalid_argument);
+}
+
+namespace {
+// Runs sql on a separate connection and returns the first column of each
+// row, joined by newlines.
+std::string rawQuery(const std::string& path, const std::string& sql) {
+  sqlite3* db = nullptr;
+  sqlite3_open(path.c_str(), &db);
+  sqlite3_stmt* stmt = nullptr;
+  std::string rows;
+  if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+      const int last = sqlite3_column_count(stmt) - 1;
+      const unsigned char* text = sqlite3_column_text(stmt, last);
+      rows += text ? reinterpret_cast<const char*>(text) : "";
+      rows += "\n";
+    }
+  }
+  sqlite3_finalize(stmt);
+  sqlite3_close(db);
+  return rows;
+}
+}  // namespace
+
+TEST_F(SQLiteIssueRepositoryFileTest, UnversionedDatabaseMigratesOnce) {
+  // Schema of a database created before status and tag colors existed.
+  sqlite3* legacy = nullptr;
+  ASSERT_EQ(sqlite3_open(dbPath().c_str(), &legacy), SQLITE_OK);
+  ASSERT_EQ(sqlite3_exec(legacy,
+                         "CREATE TABLE issues (id INTEGER PRIMARY KEY "
+                         "AUTOINCREMENT, author_id TEXT NOT NULL, title TEXT "
+                         "NOT NULL, description_comment_id INTEGER NOT NULL "
+                         "DEFAULT -1, assigned_to TEXT, created_at INTEGER "
+                         "DEFAULT 0);"
+                         "CREATE TABLE issue_tags (issue_id INTEGER NOT NULL, "
+                         "tag TEXT NOT NULL, PRIMARY KEY(issue_id, tag));"
+                         "INSERT INTO issues (author_id, title) "
+                         "VALUES ('author', 'Old');"
+                         "INSERT INTO issue_tags VALUES (1, 'legacy');",
+                         nullptr, nullptr, nullptr),
+            SQLITE_OK);
+  sqlite3_close(legacy);
+
+  std::size_t migrating = 0;
+  {
+    SQLiteIssueRepository repository(dbPath(), 2, StorageProfile(), true);
+    migrating = repository.executedStatementCount();
+    EXPECT_EQ(repository.schemaVersion(),
+              SQLiteIssueRepository::latestSchemaVersion());
+    Issue old = repository.getIssue(1);
+    EXPECT_EQ(old.getStatus(), "To Be Done");
+    EXPECT_TRUE(old.hasTag("legacy"));
+    EXPECT_THAT(repository.listAllTags(), SizeIs(1));
+  }
+
+  SQLiteIssueRepository reopened(dbPath(), 2, StorageProfile(), true);
+  EXPECT_LT(reopened.executedStatementCount(), migrating);
+  EXPECT_LE(reopened.executedStatementCount(), 4u);
+  EXPECT_EQ(SQLiteIssueRepository(dbPath(), 2).executedStatementCount(), 0u);
+}
+
+TEST_F(SQLiteIssueRepositoryFileTest, FiltersSeekThroughSecondaryIndexes) {
+  { SQLiteIssueRepository repository(dbPath(), 2); }
+
+  auto plan = [this](const std::string& where) {
+    return rawQuery(dbPath(),
+                    "EXPLAIN QUERY PLAN SELECT id FROM issues WHERE " + where);
+  };
+  EXPECT_THAT(plan("REPLACE(REPLACE(REPLACE(LOWER(status), ' ', ''), '-', "
+                   "''), '_', '') = 'done'"),
+              ::testing::HasSubstr("idx_issues_status_key"));
+  EXPECT_THAT(plan("assigned_to = 'dev'"),
+              ::testing::HasSubstr("idx_issues_assigned"));
+  EXPECT_THAT(plan("author_id = 'a' COLLATE NOCASE"),
+              ::testing::HasSubstr("idx_issues_author_nocase"));
+  EXPECT_THAT(plan("id IN (SELECT issue_id FROM issue_tags "
+                   "WHERE tag IN ('x'))"),
+              ::testing::HasSubstr("idx_issue_tags_tag"));
+  EXPECT_THAT(rawQuery(dbPath(),
+                       "EXPLAIN QUERY PLAN SELECT milestone_id FROM "
+                       "milestone_issues WHERE issue_id = 1"),
+              ::testing::HasSubstr("idx_milestone_issues_issue"));
+  EXPECT_THAT(rawQuery(dbPath(),
+                       "EXPLAIN QUERY PLAN SELECT id FROM milestones "
+                       "WHERE start_date <= '2024-06-01' "
+                       "ORDER BY start_date, id"),
+              ::testing::HasSubstr("idx_milestones_start"));
+  EXPECT_THAT(rawQuery(dbPath(),
+                       "EXPLAIN QUERY PLAN SELECT id FROM milestones "
+                       "WHERE end_date >= '2024-06-01'"),
+              ::testing::HasSubstr("idx_milestones_end"));
+}
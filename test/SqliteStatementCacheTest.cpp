@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <sqlite3.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "SqliteStatementCache.hpp"
+
+class SqliteStatementCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(sqlite3_open(":memory:", &db), SQLITE_OK);
+    ASSERT_EQ(sqlite3_exec(db, "CREATE TABLE t (v INTEGER);",
+                           nullptr, nullptr, nullptr),
+              SQLITE_OK);
+  }
+
+  void TearDown() override { sqlite3_close_v2(db); }
+
+  sqlite3* db{nullptr};
+};
+
+TEST_F(SqliteStatementCacheTest, ReusesStatementAndCountsHits) {
+  SqliteStatementCache cache(db);
+  sqlite3_stmt* first = nullptr;
+  {
+    auto lease = cache.acquire("SELECT ?;");
+    first = lease.get();
+  }
+  {
+    auto lease = cache.acquire("SELECT ?;");
+    EXPECT_EQ(lease.get(), first);
+  }
+
+  SqliteStatementCache::Stats stats = cache.stats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.size, 1u);
+}
+
+TEST_F(SqliteStatementCacheTest, ReleaseClearsBindings) {
+  SqliteStatementCache cache(db);
+  {
+    auto lease = cache.acquire("SELECT ?;");
+    sqlite3_bind_int(lease.get(), 1, 42);
+    ASSERT_EQ(sqlite3_step(lease.get()), SQLITE_ROW);
+    EXPECT_EQ(sqlite3_column_int(lease.get(), 0), 42);
+  }
+  auto lease = cache.acquire("SELECT ?;");
+  ASSERT_EQ(sqlite3_step(lease.get()), SQLITE_ROW);
+  EXPECT_EQ(sqlite3_column_type(lease.get(), 0), SQLITE_NULL);
+}
+
+TEST_F(SqliteStatementCacheTest, NestedUseOfSameSqlGetsSeparateStatement) {
+  SqliteStatementCache cache(db);
+  auto outer = cache.acquire("SELECT v FROM t;");
+  auto inner = cache.acquire("SELECT v FROM t;");
+  EXPECT_NE(outer.get(), inner.get());
+  EXPECT_EQ(cache.stats().size, 1u);
+  EXPECT_EQ(cache.stats().misses, 2u);
+}
+
+TEST_F(SqliteStatementCacheTest, CapacityLimitsCachedStatements) {
+  SqliteStatementCache cache(db, 1);
+  { auto lease = cache.acquire("SELECT 1;"); }
+  { auto lease = cache.acquire("SELECT 2;"); }
+  { auto lease = cache.acquire("SELECT 2;"); }
+  EXPECT_EQ(cache.stats().size, 1u);
+  EXPECT_EQ(cache.stats().misses, 2u);
+  EXPECT_EQ(cache.stats().hits, 1u);
+
+  // With every cached statement leased, a new text gets a one-off.
+  auto held = cache.acquire("SELECT 2;");
+  { auto lease = cache.acquire("SELECT 3;"); }
+  { auto lease = cache.acquire("SELECT 3;"); }
+  EXPECT_EQ(cache.stats().size, 1u);
+  EXPECT_EQ(cache.stats().misses, 4u);
+}
+
+TEST_F(SqliteStatementCacheTest, HotStatementSurvivesPastCapacity) {
+  SqliteStatementCache cache(db, 4);
+  sqlite3_stmt* hot = nullptr;
+  { hot = cache.acquire("SELECT v FROM t;").get(); }
+  for (int i = 0; i < 20; ++i) {
+    { auto lease = cache.acquire("SELECT " + std::to_string(i) + ";"); }
+    auto lease = cache.acquire("SELECT v FROM t;");
+    EXPECT_EQ(lease.get(), hot);
+  }
+  EXPECT_EQ(cache.stats().size, 4u);
+  EXPECT_EQ(cache.stats().hits, 20u);
+}
+
+TEST_F(SqliteStatementCacheTest, InvalidSqlThrows) {
+  SqliteStatementCache cache(db);
+  EXPECT_THROW(cache.acquire("SELEC nonsense;"), std::runtime_error);
+  EXPECT_EQ(cache.stats().size, 0u);
+}
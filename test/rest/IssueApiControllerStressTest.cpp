@@ -0,0 +1,381 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controller/IssueApiController.hpp"
+#include "oatpp/network/Server.hpp"
+#include "oatpp/network/virtual_/Interface.hpp"
+#include "oatpp/network/virtual_/client/ConnectionProvider.hpp"
+#include "oatpp/network/virtual_/server/ConnectionProvider.hpp"
+#include "oatpp/parser/json/mapping/ObjectMapper.hpp"
+#include "oatpp/web/client/HttpRequestExecutor.hpp"
+#include "oatpp/web/protocol/http/outgoing/BufferBody.hpp"
+#include "oatpp/web/server/HttpConnectionHandler.hpp"
+#include "oatpp/web/server/HttpRouter.hpp"
+
+namespace {
+
+class ScopedDbPath {
+ public:
+  explicit ScopedDbPath(const std::filesystem::path& path) {
+    const char* current = std::getenv("ISSUE_DB_PATH");
+    hadValue_ = current != nullptr;
+    if (hadValue_) {
+      original_ = current;
+    }
+    setenv("ISSUE_DB_PATH", path.string().c_str(), 1);
+  }
+
+  ~ScopedDbPath() {
+    if (hadValue_) {
+      setenv("ISSUE_DB_PATH", original_.c_str(), 1);
+    } else {
+      unsetenv("ISSUE_DB_PATH");
+    }
+  }
+
+ private:
+  bool hadValue_{false};
+  std::string original_;
+};
+
+class IssueApiControllerStressTest : public ::testing::Test {
+ protected:
+  IssueApiControllerStressTest()
+      : root_(std::filesystem::temp_directory_path() /
+              ("api-stress-" +
+               std::to_string(std::chrono::steady_clock::now()
+                                  .time_since_epoch()
+                                  .count()))) {}
+
+  ~IssueApiControllerStressTest() override {
+    std::error_code ec;
+    std::filesystem::remove_all(root_, ec);
+  }
+
+  std::filesystem::path root_;
+};
+
+// Serves the controller over oatpp's in-memory virtual network so
+// requests go through the real router and connection handler.
+class InProcessServer {
+ public:
+  explicit InProcessServer(
+      const std::shared_ptr<IssueApiController>& controller)
+      : interface_(oatpp::network::virtual_::Interface::obtainShared(
+            "issue-api-stress")),
+        serverProvider_(
+            oatpp::network::virtual_::server::ConnectionProvider::
+                createShared(interface_)),
+        router_(oatpp::web::server::HttpRouter::createShared()) {
+    router_->addController(controller);
+    handler_ =
+        oatpp::web::server::HttpConnectionHandler::createShared(router_);
+    server_ = std::make_shared<oatpp::network::Server>(serverProvider_,
+                                                       handler_);
+    thread_ = std::thread([this] { server_->run(); });
+    executor_ = oatpp::web::client::HttpRequestExecutor::createShared(
+        oatpp::network::virtual_::client::ConnectionProvider::createShared(
+            interface_));
+  }
+
+  ~InProcessServer() {
+    server_->stop();
+    serverProvider_->stop();
+    handler_->stop();
+    thread_.join();
+  }
+
+  int request(const std::string& method, const std::string& path,
+              const std::string& json = "",
+              std::string* responseBody = nullptr) {
+    std::shared_ptr<oatpp::web::protocol::http::outgoing::Body> body;
+    if (!json.empty()) {
+      body = oatpp::web::protocol::http::outgoing::BufferBody::createShared(
+          json.c_str(), "application/json");
+    }
+    auto response = executor_->execute(method.c_str(), path.c_str(), {},
+                                       body, nullptr);
+    const oatpp::String text = response->readBodyToString();
+    if (responseBody != nullptr && text) {
+      *responseBody = *text;
+    }
+    return response->getStatusCode();
+  }
+
+ private:
+  std::shared_ptr<oatpp::network::virtual_::Interface> interface_;
+  std::shared_ptr<oatpp::network::ServerConnectionProvider> serverProvider_;
+  std::shared_ptr<oatpp::web::server::HttpRouter> router_;
+  std::shared_ptr<oatpp::web::server::HttpConnectionHandler> handler_;
+  std::shared_ptr<oatpp::network::Server> server_;
+  std::shared_ptr<oatpp::web::client::HttpRequestExecutor> executor_;
+  std::thread thread_;
+};
+
+}  // namespace
+
+TEST_F(IssueApiControllerStressTest, ConcurrentRequestsAcrossSwitches) {
+  std::filesystem::create_directories(root_);
+  ScopedDbPath dbPath(root_ / "main.db");
+  auto controller = std::make_shared<IssueApiController>(
+      oatpp::parser::json::mapping::ObjectMapper::createShared());
+  InProcessServer server(controller);
+
+  ASSERT_EQ(server.request("POST", "/databases", R"({"name":"alt"})"), 201);
+
+  constexpr int kWorkers = 6;
+  constexpr int kIterations = 40;
+  std::atomic<int> serverErrors{0};
+  std::atomic<bool> done{false};
+  // Any status below 500 is a valid answer: ids do not survive a switch,
+  // so not-found responses are expected. 5xx means a handler failed.
+  auto check = [&](int status) {
+    if (status >= 500) {
+      ++serverErrors;
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int w = 0; w < kWorkers; ++w) {
+    workers.emplace_back([&, w] {
+      const std::string user = "user" + std::to_string(w);
+      for (int i = 0; i < kIterations; ++i) {
+        const std::string id = std::to_string(1 + (i % 10));
+        check(server.request(
+            "POST", "/users",
+            R"({"name":")" + user + R"(","role":"Developer"})"));
+        check(server.request(
+            "POST", "/issues",
+            R"({"title":"Stress","description":"body","author_id":")" +
+                user + R"("})"));
+        check(server.request(
+            "POST", "/issues/" + id + "/comments",
+            R"({"text":"hello","author_id":")" + user + R"("})"));
+        check(server.request("POST", "/issues/" + id + "/tags",
+                             R"({"tag":"t)" + std::to_string(w) +
+                                 R"(","color":"#fff"})"));
+        check(server.request("GET", "/issues"));
+        check(server.request("GET", "/issues?author=" + user));
+        check(server.request("GET", "/issues/" + id));
+        check(server.request("GET", "/issues/" + id + "/comments"));
+        check(server.request("GET",
+                             "/issues/" + id + "/comments?after=0&limit=2"));
+        check(server.request("GET", "/issues/" + id + "?view=digest"));
+        check(server.request("GET", "/tags"));
+        check(server.request("GET", "/milestones"));
+      }
+    });
+  }
+
+  std::thread switcher([&] {
+    while (!done.load()) {
+      check(server.request("POST", "/databases/alt/switch"));
+      check(server.request("PATCH", "/databases/alt", R"({"name":"alt2"})"));
+      check(server.request("PATCH", "/databases/alt2", R"({"name":"alt"})"));
+      check(server.request("POST", "/databases/main/switch"));
+      check(server.request("GET", "/databases"));
+    }
+  });
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  done = true;
+  switcher.join();
+
+  EXPECT_EQ(serverErrors.load(), 0);
+  EXPECT_EQ(server.request("GET", "/issues"), 200);
+  EXPECT_EQ(server.request("GET", "/issues/1?view=bogus"), 400);
+  EXPECT_EQ(server.request("GET", "/issues/1/comments?limit=0"), 400);
+  EXPECT_EQ(server.request("GET", "/milestones/active"), 200);
+  EXPECT_EQ(server.request("GET", "/milestones/completed"), 200);
+  EXPECT_EQ(server.request("GET", "/milestones?from=2024-02&to=2024-01"),
+            400);
+  EXPECT_EQ(server.request("GET", "/diagnostics/storage"), 200);
+}
+
+TEST_F(IssueApiControllerStressTest, ImportStreamsNdjsonInBatches) {
+  std::filesystem::create_directories(root_);
+  ScopedDbPath dbPath(root_ / "main.db");
+  auto controller = std::make_shared<IssueApiController>(
+      oatpp::parser::json::mapping::ObjectMapper::createShared());
+  InProcessServer server(controller);
+  ASSERT_EQ(server.request("POST", "/users",
+                           R"({"name":"migrator","role":"Developer"})"),
+            201);
+
+  std::string ndjson;
+  for (int i = 0; i < 2500; ++i) {
+    ndjson += R"({"title":"Old )" + std::to_string(i) +
+              R"(","author_id":"migrator","description":"d","status":"done",)"
+              R"("comments":[{"author_id":"migrator","text":"c"}],)"
+              R"("tags":[{"tag":"legacy","color":"#123"}]})" "\n";
+  }
+  std::string result;
+  EXPECT_EQ(server.request("POST", "/import", ndjson, &result), 201);
+  EXPECT_NE(result.find(R"("imported":2500)"), std::string::npos) << result;
+  EXPECT_NE(result.find(R"("batches":3)"), std::string::npos) << result;
+
+  std::string issue;
+  EXPECT_EQ(server.request("GET", "/issues/2500", "", &issue), 200);
+  EXPECT_NE(issue.find(R"("comment_ids":[0,1])"), std::string::npos) << issue;
+  EXPECT_NE(issue.find(R"("status":"Done")"), std::string::npos) << issue;
+
+  const std::string bad =
+      R"({"title":"Fine","author_id":"migrator"})" "\n"
+      "\n"
+      R"({"title":"Broken",)" "\n";
+  EXPECT_EQ(server.request("POST", "/import", bad, &result), 400);
+  EXPECT_NE(result.find("line 3"), std::string::npos) << result;
+  EXPECT_EQ(server.request("POST", "/import",
+                           R"({"title":"Stranger","author_id":"ghost"})",
+                           &result),
+            400);
+  EXPECT_NE(result.find("ghost"), std::string::npos) << result;
+  EXPECT_EQ(server.request("GET", "/issues/2501"), 404);
+}
+
+TEST_F(IssueApiControllerStressTest, ImportReportsBatchTheDatabaseRejects) {
+  std::filesystem::create_directories(root_);
+  ScopedDbPath dbPath(root_ / "main.db");
+  setenv("ISSUE_DB_BUSY_TIMEOUT", "50", 1);
+  auto controller = std::make_shared<IssueApiController>(
+      oatpp::parser::json::mapping::ObjectMapper::createShared());
+  unsetenv("ISSUE_DB_BUSY_TIMEOUT");
+  InProcessServer server(controller);
+  ASSERT_EQ(server.request("POST", "/users",
+                           R"({"name":"migrator","role":"Developer"})"),
+            201);
+
+  // Another process holding the write lock past the busy timeout.
+  sqlite3* holder = nullptr;
+  ASSERT_EQ(sqlite3_open((root_ / "main.db").string().c_str(), &holder),
+            SQLITE_OK);
+  ASSERT_EQ(sqlite3_exec(holder, "BEGIN IMMEDIATE;", nullptr, nullptr,
+                         nullptr),
+            SQLITE_OK);
+  std::string result;
+  EXPECT_EQ(server.request("POST", "/import",
+                           R"({"title":"Blocked","author_id":"migrator"})",
+                           &result),
+            500);
+  EXPECT_NE(result.find("IMPORT_FAILED"), std::string::npos) << result;
+  EXPECT_NE(result.find("0 issues imported before it"), std::string::npos)
+      << result;
+  sqlite3_exec(holder, "ROLLBACK;", nullptr, nullptr, nullptr);
+  sqlite3_close(holder);
+
+  EXPECT_EQ(server.request("POST", "/import",
+                           R"({"title":"Unblocked","author_id":"migrator"})"),
+            201);
+}
+
+TEST_F(IssueApiControllerStressTest, ExportStreamsEveryTable) {
+  std::filesystem::create_directories(root_);
+  ScopedDbPath dbPath(root_ / "main.db");
+  auto controller = std::make_shared<IssueApiController>(
+      oatpp::parser::json::mapping::ObjectMapper::createShared());
+  InProcessServer server(controller);
+  ASSERT_EQ(server.request("POST", "/users",
+                           R"({"name":"exporter","role":"Developer"})"),
+            201);
+  std::string ndjson;
+  for (int i = 0; i < 300; ++i) {
+    ndjson += R"({"title":"Row )" + std::to_string(i) +
+              R"(, \"quoted\"","author_id":"exporter","description":"d",)"
+              R"("comments":[{"author_id":"exporter","text":"c"}],)"
+              R"("tags":[{"tag":"t","color":"#123"}]})" "\n";
+  }
+  ASSERT_EQ(server.request("POST", "/import", ndjson), 201);
+
+  std::string exported;
+  ASSERT_EQ(server.request("GET", "/export", "", &exported), 200);
+  EXPECT_EQ(std::count(exported.begin(), exported.end(), '\n'), 301);
+  EXPECT_EQ(exported.rfind(R"({"type":"user","name":"exporter")", 0), 0u)
+      << exported.substr(0, 200);
+  EXPECT_NE(exported.find(R"({"type":"issue","id":300,)"), std::string::npos);
+
+  // Exported issue lines import as they are.
+  const std::string issueLines =
+      exported.substr(exported.find(R"({"type":"issue")"));
+  std::string result;
+  EXPECT_EQ(server.request("POST", "/import", issueLines, &result), 201);
+  EXPECT_NE(result.find(R"("imported":300)"), std::string::npos) << result;
+
+  std::string csv;
+  ASSERT_EQ(server.request("GET", "/export?format=csv", "", &csv), 200);
+  EXPECT_EQ(
+      csv.rfind("users\nname,role\nexporter,Developer\n\nmilestones\n", 0),
+      0u)
+      << csv.substr(0, 200);
+  EXPECT_NE(csv.find("\n1,\"Row 0, \"\"quoted\"\"\",exporter,,To Be Done,"),
+            std::string::npos);
+  EXPECT_NE(csv.find("\ncomments\nissue_id,id,author_id,text,timestamp\n"
+                     "1,0,exporter,d,"),
+            std::string::npos);
+  EXPECT_NE(csv.find("\n1,1,exporter,c,"), std::string::npos);
+  EXPECT_NE(csv.find("\n\nissue_tags\nissue_id,tag,color\n1,t,#123\n"),
+            std::string::npos);
+  EXPECT_EQ(server.request("GET", "/export?format=xml"), 400);
+}
+
+TEST_F(IssueApiControllerStressTest, BackupReportsProgressAndListsSnapshot) {
+  std::filesystem::create_directories(root_);
+  ScopedDbPath dbPath(root_ / "main.db");
+  auto controller = std::make_shared<IssueApiController>(
+      oatpp::parser::json::mapping::ObjectMapper::createShared());
+  InProcessServer server(controller);
+  ASSERT_EQ(server.request("POST", "/users",
+                           R"({"name":"keeper","role":"Developer"})"),
+            201);
+
+  EXPECT_EQ(server.request("GET", "/databases/main/backup"), 404);
+  EXPECT_EQ(server.request("POST", "/databases/nope/backup",
+                           R"({"name":"copy"})"),
+            404);
+  std::string status;
+  ASSERT_EQ(server.request("POST", "/databases/main/backup",
+                           R"({"name":"copy"})", &status),
+            202);
+  EXPECT_NE(status.find(R"("snapshot":"copy.db")"), std::string::npos)
+      << status;
+
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(30);
+  do {
+    ASSERT_EQ(server.request("GET", "/databases/main.db/backup", "", &status),
+              200);
+  } while (status.find(R"("state":"running")") != std::string::npos &&
+           std::chrono::steady_clock::now() < deadline);
+  EXPECT_NE(status.find(R"("state":"done")"), std::string::npos) << status;
+
+  std::string databases;
+  EXPECT_EQ(server.request("GET", "/databases", "", &databases), 200);
+  EXPECT_NE(databases.find(R"("name":"copy.db")"), std::string::npos)
+      << databases;
+  EXPECT_EQ(server.request("POST", "/databases/main/backup",
+                           R"({"name":"copy"})"),
+            409);
+  const int switched = server.request("POST", "/databases/copy/switch");
+  EXPECT_TRUE(switched == 200 || switched == 202) << switched;
+  do {
+    ASSERT_EQ(server.request("GET", "/databases", "", &databases), 200);
+  } while (databases.find(R"("name":"copy.db","active":true)") ==
+               std::string::npos &&
+           std::chrono::steady_clock::now() < deadline);
+  EXPECT_NE(databases.find(R"("name":"copy.db","active":true)"),
+            std::string::npos)
+      << databases;
+  std::string users;
+  EXPECT_EQ(server.request("GET", "/users", "", &users), 200);
+  EXPECT_NE(users.find("keeper"), std::string::npos) << users;
+}
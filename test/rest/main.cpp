@@ -0,0 +1,11 @@
+#include "gtest/gtest.h"
+
+#include "oatpp/core/base/Environment.hpp"
+
+int main(int argc, char **argv) {
+  oatpp::base::Environment::init();
+  ::testing::InitGoogleTest(&argc, argv);
+  int result = RUN_ALL_TESTS();
+  oatpp::base::Environment::destroy();
+  return result;
+}